@@ -325,6 +325,7 @@ gst_inference_overlay_process_meta (GstInferenceBaseOverlay * inference_overlay,
     LineStyleBoundingBox style, gdouble alpha_overlay)
 {
   GstInferenceMeta *detect_meta;
+  GstInferencePrediction *root;
 
   g_return_val_if_fail (inference_overlay != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (frame != NULL, GST_FLOW_ERROR);
@@ -332,8 +333,10 @@ gst_inference_overlay_process_meta (GstInferenceBaseOverlay * inference_overlay,
 
   detect_meta = (GstInferenceMeta *) meta;
 
-  gst_get_meta (detect_meta->prediction, cv_mat, font_scale, thickness,
+  root = gst_inference_meta_ref_prediction (detect_meta);
+  gst_get_meta (root, cv_mat, font_scale, thickness,
       labels_list, num_labels, style, alpha_overlay);
+  gst_inference_prediction_unref (root);
 
   return GST_FLOW_OK;
 }
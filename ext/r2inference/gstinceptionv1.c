@@ -73,7 +73,8 @@ enum
   "video/x-raw, "							\
   "width=224, "							\
   "height=224, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -124,6 +125,8 @@ gst_inceptionv1_class_init (GstInceptionv1Class * klass)
       "   Michael Gruner <michael.gruner@ridgerun.com> \n\t\t\t"
       "   Mauricio Montero <mauricio.montero@ridgerun.com>");
 
+  gst_video_inference_install_top_k_properties (vi_class);
+
   vi_class->start = GST_DEBUG_FUNCPTR (gst_inceptionv1_start);
   vi_class->stop = GST_DEBUG_FUNCPTR (gst_inceptionv1_stop);
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_inceptionv1_preprocess);
@@ -81,7 +81,8 @@ enum
   "video/x-raw, "							\
   "width=224, "							\
   "height=224, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -137,6 +138,8 @@ gst_inceptionv2_class_init (GstInceptionv2Class * klass)
   gobject_class->dispose = gst_inceptionv2_dispose;
   gobject_class->finalize = gst_inceptionv2_finalize;
 
+  gst_video_inference_install_top_k_properties (vi_class);
+
   vi_class->start = GST_DEBUG_FUNCPTR (gst_inceptionv2_start);
   vi_class->stop = GST_DEBUG_FUNCPTR (gst_inceptionv2_stop);
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_inceptionv2_preprocess);
@@ -158,7 +161,9 @@ gst_inceptionv2_set_property (GObject * object, guint property_id,
 
   switch (property_id) {
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      /* top-k and full-probabilities belong to the parent */
+      G_OBJECT_CLASS (gst_inceptionv2_parent_class)->set_property (object,
+          property_id, value, pspec);
       break;
   }
 }
@@ -173,7 +178,8 @@ gst_inceptionv2_get_property (GObject * object, guint property_id,
 
   switch (property_id) {
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      G_OBJECT_CLASS (gst_inceptionv2_parent_class)->get_property (object,
+          property_id, value, pspec);
       break;
   }
 }
@@ -71,7 +71,8 @@ enum
   "video/x-raw, "							\
   "width=224, "							\
   "height=224, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -122,6 +123,8 @@ gst_mobilenetv2_class_init (GstMobilenetv2Class * klass)
       "   Michael Gruner <michael.gruner@ridgerun.com>  \n\t\t\t"
       "   Mauricio Montero <mauricio.montero@ridgerun.com>");
 
+  gst_video_inference_install_top_k_properties (vi_class);
+
   vi_class->start = GST_DEBUG_FUNCPTR (gst_mobilenetv2_start);
   vi_class->stop = GST_DEBUG_FUNCPTR (gst_mobilenetv2_stop);
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_mobilenetv2_preprocess);
@@ -56,6 +56,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_mobilenetv2ssd_debug_category);
 #define TOTAL_CLASSES 90
 #define LOCATION_PARAMS 4
 
+/* The model output tensors */
+#define TENSOR_LOCATIONS 0
+#define TENSOR_LABELS 1
+#define TENSOR_PROBABILITIES 2
+#define TENSOR_NUM_BOXES 3
+#define NUM_TENSORS 4
+
 /* prototypes */
 static void gst_mobilenetv2ssd_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
@@ -65,13 +72,13 @@ static gboolean gst_mobilenetv2ssd_preprocess (GstVideoInference * vi,
     GstVideoFrame * inframe, GstVideoFrame * outframe);
 static gboolean
 gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
-    const gpointer prediction, gsize predsize, GstMeta * meta_model,
-    GstVideoInfo * info_model, gboolean * valid_prediction,
-    gchar ** labels_list, gint num_labels);
+    const GstInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction, gchar ** labels_list, gint num_labels);
 static gint
 gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
-    mobilenetv2ssd, const gfloat * prediction, gint num_boxes, gint img_width,
-    gint img_height, BBox * boxes, gdouble ** probabilities);
+    mobilenetv2ssd, const GstInferenceTensor * tensors, gint num_boxes,
+    gint img_width, gint img_height, BBox * boxes, gdouble ** probabilities);
 
 enum
 {
@@ -85,7 +92,8 @@ enum
   "video/x-raw, "							\
   "width=300, "								\
   "height=300, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -151,7 +159,8 @@ gst_mobilenetv2ssd_class_init (GstMobilenetv2ssdClass * klass)
           G_PARAM_READWRITE));
 
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_preprocess);
-  vi_class->postprocess = GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_postprocess);
+  vi_class->postprocess_tensors =
+      GST_DEBUG_FUNCPTR (gst_mobilenetv2ssd_postprocess);
 }
 
 static void
@@ -176,18 +185,22 @@ gst_mobilenetv2ssd_preprocess (GstVideoInference * vi,
 
 static gint
 gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
-    mobilenetv2ssd, const gfloat * prediction, gint num_boxes, gint img_width,
-    gint img_height, BBox * boxes, gdouble ** probabilities)
+    mobilenetv2ssd, const GstInferenceTensor * tensors, gint num_boxes,
+    gint img_width, gint img_height, BBox * boxes, gdouble ** probabilities)
 {
   gint cur_box = 0;
   gdouble left = 0, top = 0, right = 0, bottom = 0;
-  gint i_box = 0, i_prob = 0, i_location = 0, i_label = 0;
+  gint i_box = 0;
   gdouble prob = 0;
   gdouble prob_thresh = 0;
   gdouble iou_thresh = 0;
+  const gfloat *locations = NULL;
+  const gfloat *labels = NULL;
+  const gfloat *probs = NULL;
+  GstInferenceNmsParams params;
 
   g_return_val_if_fail (mobilenetv2ssd, cur_box);
-  g_return_val_if_fail (prediction, cur_box);
+  g_return_val_if_fail (tensors, cur_box);
   g_return_val_if_fail (boxes, cur_box);
   g_return_val_if_fail (probabilities, cur_box);
 
@@ -196,28 +209,28 @@ gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
   iou_thresh = mobilenetv2ssd->iou_thresh;
   GST_OBJECT_UNLOCK (mobilenetv2ssd);
 
+  locations = (const gfloat *) tensors[TENSOR_LOCATIONS].data;
+  labels = (const gfloat *) tensors[TENSOR_LABELS].data;
+  probs = (const gfloat *) tensors[TENSOR_PROBABILITIES].data;
+
   for (i_box = 0; i_box < num_boxes; i_box++) {
-    /* Here prediction has the 4 concatenated tensors in the order
-       [locations, labels, probabilities, num_boxes], so we compute the indices 
-       to access each one of them */
-    i_location = i_box * LOCATION_PARAMS;
-    i_label = i_box + (num_boxes * LOCATION_PARAMS);
-    i_prob = i_label + num_boxes;
-    prob = prediction[i_prob];
+    const gfloat *location = locations + i_box * LOCATION_PARAMS;
+
+    prob = probs[i_box];
 
     if (prob > prob_thresh) {
       BBox result = { 0 };
 
-      top = prediction[i_location] * img_height;
-      left = prediction[i_location + 1] * img_width;
-      bottom = prediction[i_location + 2] * img_height;
-      right = prediction[i_location + 3] * img_width;
+      top = location[0] * img_height;
+      left = location[1] * img_width;
+      bottom = location[2] * img_height;
+      right = location[3] * img_width;
 
       result.x = left;
       result.y = top;
       result.width = right - left;
       result.height = bottom - top;
-      result.label = (gint) prediction[i_label];
+      result.label = (gint) labels[i_box];
       result.prob = prob;
       probabilities[cur_box][result.label] = result.prob;
       boxes[cur_box] = result;
@@ -225,16 +238,17 @@ gst_mobilenetv2ssd_get_boxes_from_prediction (GstMobilenetv2ssd *
     }
   }
 
-  gst_remove_duplicated_boxes (iou_thresh, boxes, &cur_box);
+  gst_inference_nms_params_init (&params, iou_thresh);
+  gst_remove_duplicated_boxes_full (&params, boxes, probabilities, &cur_box);
 
   return cur_box;
 }
 
 static gboolean
 gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
-    const gpointer prediction, gsize predsize, GstMeta * meta_model,
-    GstVideoInfo * info_model, gboolean * valid_prediction,
-    gchar ** labels_list, gint num_labels)
+    const GstInferenceTensor * tensors, guint num_tensors,
+    GstMeta * meta_model, GstVideoInfo * info_model,
+    gboolean * valid_prediction, gchar ** labels_list, gint num_labels)
 {
   GstMobilenetv2ssd *mobilenetv2ssd = NULL;
   GstInferenceMeta *imeta = NULL;
@@ -244,17 +258,16 @@ gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
   gint valid_boxes = 0;
   gint i = 0;
   gboolean ret = TRUE;
-  const gfloat *pred = NULL;
+  gint max_boxes = 0;
 
   g_return_val_if_fail (vi, FALSE);
-  g_return_val_if_fail (prediction, FALSE);
+  g_return_val_if_fail (tensors, FALSE);
   g_return_val_if_fail (meta_model, FALSE);
   g_return_val_if_fail (info_model, FALSE);
   g_return_val_if_fail (valid_prediction, FALSE);
 
   GST_LOG_OBJECT (vi, "Postprocess");
 
-  pred = (const gfloat *) prediction;
   mobilenetv2ssd = GST_MOBILENETV2SSD (vi);
   /* The ssd mobilenetv2 model has 4 output tensors:
      0: [N * 4] tensor with the location of the N bounding boxes (top-left and
@@ -262,10 +275,22 @@ gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
      is of shape [N * 4]
      1: [N] tensor with the number of labels for the N bounding boxes
      2: [N] tensor with the probabilities of those N labels
-     3: [1] tensor with the number of detected boxes 
-     They are all concatenated here in a 1D array in row-major order.
+     3: [1] tensor with the number of detected boxes
    */
-  total_boxes = (gint) pred[predsize / sizeof (gfloat) - 1];
+  if (NUM_TENSORS != num_tensors) {
+    GST_ERROR_OBJECT (mobilenetv2ssd, "Expected %d output tensors, got %u",
+        NUM_TENSORS, num_tensors);
+    return FALSE;
+  }
+
+  total_boxes = (gint) ((const gfloat *) tensors[TENSOR_NUM_BOXES].data)[0];
+
+  /* Never read past the detections the model has room for */
+  max_boxes = MIN (tensors[TENSOR_LABELS].num_elements,
+      tensors[TENSOR_PROBABILITIES].num_elements);
+  max_boxes = MIN (max_boxes,
+      tensors[TENSOR_LOCATIONS].num_elements / LOCATION_PARAMS);
+  total_boxes = CLAMP (total_boxes, 0, max_boxes);
 
   GST_LOG_OBJECT (mobilenetv2ssd, "Number of total predictions: %d",
       total_boxes);
@@ -287,7 +312,7 @@ gst_mobilenetv2ssd_postprocess (GstVideoInference * vi,
   }
 
   valid_boxes =
-      gst_mobilenetv2ssd_get_boxes_from_prediction (mobilenetv2ssd, pred,
+      gst_mobilenetv2ssd_get_boxes_from_prediction (mobilenetv2ssd, tensors,
       total_boxes, info_model->width, info_model->height, boxes, probabilities);
 
   GST_LOG_OBJECT (mobilenetv2ssd, "Number of valid predictions: %d",
@@ -75,7 +75,8 @@ enum
   "video/x-raw, "							\
   "width=224, "							\
   "height=224, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -126,6 +127,8 @@ gst_resnet50v1_class_init (GstResnet50v1Class * klass)
       "   Michael Gruner <michael.gruner@ridgerun.com> \n\t\t\t"
       "   Greivin Fallas <greivin.fallas@ridgerun.com>");
 
+  gst_video_inference_install_top_k_properties (vi_class);
+
   vi_class->start = GST_DEBUG_FUNCPTR (gst_resnet50v1_start);
   vi_class->stop = GST_DEBUG_FUNCPTR (gst_resnet50v1_stop);
   vi_class->preprocess = GST_DEBUG_FUNCPTR (gst_resnet50v1_preprocess);
@@ -67,10 +67,6 @@ GST_DEBUG_CATEGORY_STATIC (gst_tinyyolov2_debug_category);
 #define DEFAULT_IOU_THRESH 0.30
 
 #define TOTAL_CLASSES 20
-#define TOTAL_BOXES 845
-
-const gdouble box_anchors[] =
-    { 1.08, 1.19, 3.42, 4.41, 6.63, 11.38, 9.42, 5.11, 16.62, 10.52 };
 
 /* prototypes */
 static void gst_tinyyolov2_set_property (GObject * object,
@@ -97,12 +93,18 @@ enum
   PROP_IOU_THRESH,
 };
 
-/* pad templates */
+/* pad templates, the model runs at 416x416 by default and at any other
+ * size given as RGB, which should be a multiple of 32 */
 #define CAPS								\
   "video/x-raw, "							\
   "width=416, "							\
   "height=416, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  "video/x-raw, "							\
+  "width=[32, 4096], "							\
+  "height=[32, 4096], "							\
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -125,6 +127,8 @@ struct _GstTinyyolov2
   gdouble obj_thresh;
   gdouble prob_thresh;
   gdouble iou_thresh;
+
+  GstInferenceDecodeArena *arena;
 };
 
 struct _GstTinyyolov2Class
@@ -191,6 +195,7 @@ gst_tinyyolov2_init (GstTinyyolov2 * tinyyolov2)
   tinyyolov2->obj_thresh = DEFAULT_OBJ_THRESH;
   tinyyolov2->prob_thresh = DEFAULT_PROB_THRESH;
   tinyyolov2->iou_thresh = DEFAULT_IOU_THRESH;
+  tinyyolov2->arena = gst_inference_decode_arena_new ();
 }
 
 void
@@ -267,7 +272,8 @@ gst_tinyyolov2_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (tinyyolov2, "finalize");
 
-  /* clean up object here */
+  gst_inference_decode_arena_free (tinyyolov2->arena);
+  tinyyolov2->arena = NULL;
 
   G_OBJECT_CLASS (gst_tinyyolov2_parent_class)->finalize (object);
 }
@@ -287,9 +293,8 @@ gst_tinyyolov2_postprocess (GstVideoInference * vi, const gpointer prediction,
 {
   GstTinyyolov2 *tinyyolov2 = NULL;
   GstInferenceMeta *imeta = NULL;
-  BBox *boxes = NULL;
+  GstInferenceDecoderParams params;
   gint num_boxes = 0, i = 0;
-  gdouble **probabilities = NULL;
 
   g_return_val_if_fail (vi, FALSE);
   g_return_val_if_fail (prediction, FALSE);
@@ -297,18 +302,22 @@ gst_tinyyolov2_postprocess (GstVideoInference * vi, const gpointer prediction,
   g_return_val_if_fail (info_model, FALSE);
   g_return_val_if_fail (valid_prediction, FALSE);
 
-  probabilities = g_malloc (sizeof (gdouble *) * TOTAL_BOXES);
-
   imeta = (GstInferenceMeta *) meta_model;
   tinyyolov2 = GST_TINYYOLOV2 (vi);
 
   GST_LOG_OBJECT (tinyyolov2, "Postprocess Meta");
 
   /* Create boxes from prediction data */
-  gst_create_boxes (vi, prediction, valid_prediction,
-      &boxes, &num_boxes, tinyyolov2->obj_thresh,
-      tinyyolov2->prob_thresh, tinyyolov2->iou_thresh, probabilities,
-      TOTAL_CLASSES);
+  gst_inference_decoder_params_init_tinyyolov2 (&params, info_model->width,
+      info_model->height, TOTAL_CLASSES);
+  if (!gst_inference_decode_arena_decode (tinyyolov2->arena, &params,
+          prediction, predsize, tinyyolov2->obj_thresh, tinyyolov2->prob_thresh,
+          tinyyolov2->iou_thresh)) {
+    GST_ERROR_OBJECT (tinyyolov2, "Prediction is too small for a %dx%d input",
+        info_model->width, info_model->height);
+    return FALSE;
+  }
+  num_boxes = tinyyolov2->arena->num_boxes;
 
   GST_LOG_OBJECT (tinyyolov2, "Number of predictions: %d", num_boxes);
 
@@ -319,15 +328,11 @@ gst_tinyyolov2_postprocess (GstVideoInference * vi, const gpointer prediction,
 
   for (i = 0; i < num_boxes; i++) {
     GstInferencePrediction *pred =
-        gst_create_prediction_from_box (vi, &boxes[i], labels_list, num_labels,
-        probabilities[i]);
+        gst_inference_decode_arena_create_prediction (tinyyolov2->arena, vi, i,
+        labels_list, num_labels);
     gst_inference_prediction_append (imeta->prediction, pred);
-    g_free (probabilities[i]);
   }
 
-  /* Free boxes after creation */
-  g_free (boxes);
-  g_free (probabilities);
   /* Log predictions */
   gst_inference_print_predictions (vi, gst_tinyyolov2_debug_category, imeta);
 
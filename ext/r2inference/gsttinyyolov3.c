@@ -67,14 +67,14 @@ GST_DEBUG_CATEGORY_STATIC (gst_tinyyolov3_debug_category);
 #define MIN_NUM_CLASSES 1
 #define DEFAULT_NUM_CLASSES 80
 
-#define TOTAL_BOXES 2535
-
 /* prototypes */
 static void gst_tinyyolov3_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
 static void gst_tinyyolov3_get_property (GObject * object,
     guint property_id, GValue * value, GParamSpec * pspec);
 
+static void gst_tinyyolov3_finalize (GObject * object);
+
 static gboolean gst_tinyyolov3_preprocess (GstVideoInference * vi,
     GstVideoFrame * inframe, GstVideoFrame * outframe);
 static gboolean
@@ -93,12 +93,18 @@ enum
   PROP_NUM_CLASSES,
 };
 
-/* pad templates */
+/* pad templates, the model runs at 416x416 by default and at any other
+ * size given as RGB, which should be a multiple of 32 */
 #define CAPS								\
   "video/x-raw, "							\
   "width=416, "								\
   "height=416, "							\
-  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}"
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  "video/x-raw, "							\
+  "width=[32, 4096], "							\
+  "height=[32, 4096], "							\
+  "format={RGB, RGBx, RGBA, BGR, BGRx, BGRA, xRGB, ARGB, xBGR, ABGR}; "	\
+  GST_VIDEO_INFERENCE_FUSED_CAPS
 
 static GstStaticPadTemplate sink_model_factory =
 GST_STATIC_PAD_TEMPLATE ("sink_model",
@@ -122,6 +128,8 @@ struct _GstTinyyolov3
   gdouble prob_thresh;
   gdouble iou_thresh;
   guint num_classes;
+
+  GstInferenceDecodeArena *arena;
 };
 
 struct _GstTinyyolov3Class
@@ -161,6 +169,7 @@ gst_tinyyolov3_class_init (GstTinyyolov3Class * klass)
 
   gobject_class->set_property = gst_tinyyolov3_set_property;
   gobject_class->get_property = gst_tinyyolov3_get_property;
+  gobject_class->finalize = gst_tinyyolov3_finalize;
 
   g_object_class_install_property (gobject_class, PROP_OBJ_THRESH,
       g_param_spec_double ("object-threshold", "obj-thresh",
@@ -194,6 +203,7 @@ gst_tinyyolov3_init (GstTinyyolov3 * tinyyolov3)
   tinyyolov3->prob_thresh = DEFAULT_PROB_THRESH;
   tinyyolov3->iou_thresh = DEFAULT_IOU_THRESH;
   tinyyolov3->num_classes = DEFAULT_NUM_CLASSES;
+  tinyyolov3->arena = gst_inference_decode_arena_new ();
 }
 
 static void
@@ -264,6 +274,19 @@ gst_tinyyolov3_get_property (GObject * object, guint property_id,
   }
 }
 
+static void
+gst_tinyyolov3_finalize (GObject * object)
+{
+  GstTinyyolov3 *tinyyolov3 = GST_TINYYOLOV3 (object);
+
+  GST_DEBUG_OBJECT (tinyyolov3, "finalize");
+
+  gst_inference_decode_arena_free (tinyyolov3->arena);
+  tinyyolov3->arena = NULL;
+
+  G_OBJECT_CLASS (gst_tinyyolov3_parent_class)->finalize (object);
+}
+
 static gboolean
 gst_tinyyolov3_preprocess (GstVideoInference * vi,
     GstVideoFrame * inframe, GstVideoFrame * outframe)
@@ -279,9 +302,8 @@ gst_tinyyolov3_postprocess (GstVideoInference * vi, const gpointer prediction,
 {
   GstTinyyolov3 *tinyyolov3 = NULL;
   GstInferenceMeta *imeta = NULL;
-  BBox *boxes = NULL;
+  GstInferenceDecoderParams params;
   gint num_boxes = 0, i = 0;
-  gdouble **probabilities = NULL;
 
   g_return_val_if_fail (vi, FALSE);
   g_return_val_if_fail (prediction, FALSE);
@@ -289,18 +311,22 @@ gst_tinyyolov3_postprocess (GstVideoInference * vi, const gpointer prediction,
   g_return_val_if_fail (info_model, FALSE);
   g_return_val_if_fail (valid_prediction, FALSE);
 
-  probabilities = g_malloc (sizeof (gdouble *) * TOTAL_BOXES);
-
   imeta = (GstInferenceMeta *) meta_model;
   tinyyolov3 = GST_TINYYOLOV3 (vi);
 
   GST_LOG_OBJECT (tinyyolov3, "Postprocess Meta");
 
   /* Create boxes from prediction data */
-  gst_create_boxes_float (vi, prediction, valid_prediction,
-      &boxes, &num_boxes, tinyyolov3->obj_thresh,
-      tinyyolov3->prob_thresh, tinyyolov3->iou_thresh, probabilities,
-      tinyyolov3->num_classes);
+  gst_inference_decoder_params_init_tinyyolov3 (&params, info_model->width,
+      info_model->height, tinyyolov3->num_classes);
+  if (!gst_inference_decode_arena_decode (tinyyolov3->arena, &params,
+          prediction, predsize, tinyyolov3->obj_thresh, tinyyolov3->prob_thresh,
+          tinyyolov3->iou_thresh)) {
+    GST_ERROR_OBJECT (tinyyolov3, "Prediction is too small for a %dx%d input",
+        info_model->width, info_model->height);
+    return FALSE;
+  }
+  num_boxes = tinyyolov3->arena->num_boxes;
 
   GST_LOG_OBJECT (tinyyolov3, "Number of predictions: %d", num_boxes);
 
@@ -312,16 +338,11 @@ gst_tinyyolov3_postprocess (GstVideoInference * vi, const gpointer prediction,
 
   for (i = 0; i < num_boxes; i++) {
     GstInferencePrediction *pred =
-        gst_create_prediction_from_box (vi, &boxes[i], labels_list, num_labels,
-        probabilities[i]);
+        gst_inference_decode_arena_create_prediction (tinyyolov3->arena, vi, i,
+        labels_list, num_labels);
     gst_inference_prediction_append (imeta->prediction, pred);
-    g_free (probabilities[i]);
   }
 
-  /* Free boxes after creation */
-  g_free (boxes);
-  g_free (probabilities);
-
   /* Log predictions */
   gst_inference_print_predictions (vi, gst_tinyyolov3_debug_category, imeta);
 
@@ -27,6 +27,9 @@
 #include <cstring>
 #include <memory>
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_backend_debug_category);
 #define GST_CAT_DEFAULT gst_base_backend_debug_category
@@ -85,8 +88,71 @@ class InferenceProperty {
   const gchar *get_name() {
     return apspec->name;
   }
+
+  std::string to_string() {
+    gchar *contents = g_strdup_value_contents (avalue);
+    std::string value (contents);
+
+    g_free (contents);
+    return value;
+  }
+};
+
+struct GstBaseBackendEngineEntry;
+
+/* A model loaded once for every backend with the same key */
+struct GstBaseBackendModelEntry {
+  /* Guards loading, configuring and starting over the model */
+  GMutex mutex;
+  std::shared_ptr < r2i::ILoader > loader;
+  std::shared_ptr < r2i::IModel > model;
+  std::weak_ptr < GstBaseBackendEngineEntry > engine;
+
+  GstBaseBackendModelEntry() {
+    g_mutex_init (&mutex);
+  }
+
+  ~GstBaseBackendModelEntry() {
+    g_mutex_clear (&mutex);
+  }
 };
 
+/* An engine shared by every backend of a model that asks for it */
+struct GstBaseBackendEngineEntry {
+  /* Serializes the predictions and parameter changes */
+  GMutex mutex;
+  std::shared_ptr < GstBaseBackendModelEntry > model;
+  std::shared_ptr < r2i::IEngine > engine;
+  std::shared_ptr < r2i::IParameters > params;
+  gboolean started;
+
+  GstBaseBackendEngineEntry() {
+    g_mutex_init (&mutex);
+    started = FALSE;
+  }
+
+  /* The last backend to let go stops it */
+  ~GstBaseBackendEngineEntry() {
+    if (started && engine->Stop ().IsError ()) {
+      GST_WARNING ("Failed to stop the shared backend engine");
+    }
+    g_mutex_clear (&mutex);
+  }
+};
+
+/* An engine of the pool of a backend, with its own parameters */
+struct GstBaseBackendPoolEngine {
+  std::shared_ptr < r2i::IEngine > engine;
+  std::shared_ptr < r2i::IParameters > params;
+  std::shared_ptr < r2i::IFrame > frame;
+};
+
+/* Loaded models by framework, location and write-before-start
+ * parameters. Entries go away with the last backend using them */
+static GMutex gst_base_backend_registry_mutex;
+static std::map < std::string, std::weak_ptr < GstBaseBackendModelEntry > >
+gst_base_backend_registry;
+
 typedef struct _GstBaseBackendPrivate GstBaseBackendPrivate;
 struct _GstBaseBackendPrivate {
   r2i::FrameworkCode code;
@@ -94,12 +160,28 @@ struct _GstBaseBackendPrivate {
   std::shared_ptr < r2i::ILoader > loader;
   std::shared_ptr < r2i::IModel > model;
   std::shared_ptr < r2i::IParameters > params;
+  /* Reconfigured over the input tensor of every prediction on engine,
+   * it only points to it */
+  std::shared_ptr < r2i::IFrame > frame;
   std::unique_ptr < r2i::IFrameworkFactory > factory;
   GMutex backend_mutex;
   gboolean backend_started;
   std::shared_ptr < std::list<InferenceProperty *> > property_list;
+  /* Parameters listed by the backend when it was created, kept for
+   * the restarts */
+  std::shared_ptr < std::vector < r2i::ParameterMeta > > param_metas;
   gboolean backend_created;
-
+  GstBaseBackendSharing sharing;
+  std::shared_ptr < GstBaseBackendModelEntry > shared_model;
+  std::shared_ptr < GstBaseBackendEngineEntry > shared_engine;
+  /* Engines over the same model besides the first one, so predictions
+   * may run concurrently. Each prediction takes an idle one, indices
+   * start at 1 in idle_engines and 0 is engine */
+  guint num_engines;
+  std::shared_ptr < std::vector < GstBaseBackendPoolEngine > > pool;
+  GAsyncQueue *idle_engines;
+  /* Held by the prediction on engine while there is no pool */
+  GMutex engine_mutex;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GstBaseBackend, gst_base_backend, G_TYPE_OBJECT,
@@ -112,6 +194,26 @@ G_DEFINE_TYPE_WITH_CODE (GstBaseBackend, gst_base_backend, G_TYPE_OBJECT,
 static GParamSpec *gst_base_backend_param_to_spec (r2i::ParameterMeta *param);
 static int gst_base_backend_param_flags (int flags);
 static void gst_base_backend_finalize (GObject *obj);
+static gboolean gst_base_backend_apply_before_start (GstBaseBackend *self,
+    GstBaseBackendPrivate *priv, std::vector<r2i::ParameterMeta> &params,
+    gboolean apply, r2i::RuntimeError &error);
+static std::string gst_base_backend_model_key (GstBaseBackendPrivate *priv,
+    const gchar *model_location, std::vector<r2i::ParameterMeta> &params);
+static gboolean gst_base_backend_share (GstBaseBackend *self,
+                                        GstBaseBackendPrivate *priv, const gchar *model_location,
+                                        std::vector<r2i::ParameterMeta> &params, r2i::RuntimeError &error);
+static void gst_base_backend_apply_property (GstBaseBackend *self,
+    GstBaseBackendPrivate *priv, InferenceProperty *property,
+    r2i::RuntimeError &error);
+static gboolean gst_base_backend_make_pool (GstBaseBackend *self,
+    GstBaseBackendPrivate *priv, std::vector<r2i::ParameterMeta> &params,
+    r2i::RuntimeError &error);
+static void gst_base_backend_clear_pool (GstBaseBackendPrivate *priv);
+static guint gst_base_backend_acquire_engine (GstBaseBackendPrivate *priv,
+    std::shared_ptr < r2i::IEngine > &engine,
+    std::shared_ptr < r2i::IFrame > &frame);
+static void gst_base_backend_release_engine (GstBaseBackendPrivate *priv,
+    guint index);
 
 #define GST_BASE_BACKEND_ERROR gst_base_backend_error_quark()
 
@@ -129,9 +231,15 @@ static void
 gst_base_backend_init (GstBaseBackend *self) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
   g_mutex_init(&priv->backend_mutex);
+  g_mutex_init(&priv->engine_mutex);
   priv->backend_started = false;
   priv->backend_created = false;
+  priv->sharing = GST_BASE_BACKEND_SHARING_NONE;
   priv->property_list = std::make_shared<std::list<InferenceProperty *>>();
+  priv->param_metas = std::make_shared<std::vector<r2i::ParameterMeta>>();
+  priv->num_engines = 1;
+  priv->pool = std::make_shared<std::vector<GstBaseBackendPoolEngine>>();
+  priv->idle_engines = NULL;
 }
 
 static void
@@ -139,13 +247,20 @@ gst_base_backend_finalize (GObject *obj) {
   GstBaseBackend *self = GST_BASE_BACKEND (obj);
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
   g_mutex_clear (&priv->backend_mutex);
+  g_mutex_clear (&priv->engine_mutex);
 
   priv->engine = nullptr;
   priv->loader = nullptr;
   priv->model = nullptr;
   priv->params = nullptr;
+  priv->frame = nullptr;
   priv->factory = nullptr;
   priv-> property_list = nullptr;
+  priv->param_metas = nullptr;
+  priv->shared_engine = nullptr;
+  priv->shared_model = nullptr;
+  gst_base_backend_clear_pool (priv);
+  priv->pool = nullptr;
 
   G_OBJECT_CLASS (gst_base_backend_parent_class)->finalize (obj);
 }
@@ -244,20 +359,35 @@ gst_base_backend_set_property (GObject *object, guint property_id,
 
   g_mutex_lock (&priv->backend_mutex);
   if (priv->backend_started) {
+    if (priv->shared_engine) {
+      g_mutex_lock (&priv->shared_engine->mutex);
+    }
     switch (pspec->value_type) {
       case G_TYPE_STRING:
         priv->params->Set(pspec->name, g_value_get_string(value));
+        for (auto &pool_engine : *priv->pool) {
+          pool_engine.params->Set(pspec->name, g_value_get_string(value));
+        }
         break;
       case G_TYPE_INT:
         priv->params->Set(pspec->name, g_value_get_int(value));
+        for (auto &pool_engine : *priv->pool) {
+          pool_engine.params->Set(pspec->name, g_value_get_int(value));
+        }
         break;
       case G_TYPE_DOUBLE:
         priv->params->Set(pspec->name, g_value_get_double(value));
+        for (auto &pool_engine : *priv->pool) {
+          pool_engine.params->Set(pspec->name, g_value_get_double(value));
+        }
         break;
       default:
         GST_WARNING_OBJECT (self, "Invalid property type");
         break;
     }
+    if (priv->shared_engine) {
+      g_mutex_unlock (&priv->shared_engine->mutex);
+    }
   } else {
     property = new InferenceProperty(value, pspec);
     priv->property_list->push_back(property);
@@ -277,7 +407,11 @@ gst_base_backend_get_property (GObject *object, guint property_id,
   std::string string_buffer;
   GST_DEBUG_OBJECT (self, "get_property");
 
+  g_mutex_lock (&priv->backend_mutex);
   if (NULL != priv->params ) {
+    if (priv->shared_engine) {
+      g_mutex_lock (&priv->shared_engine->mutex);
+    }
     switch (pspec->value_type) {
       case G_TYPE_STRING:
         priv->params->Get (pspec->name, string_buffer);
@@ -292,7 +426,371 @@ gst_base_backend_get_property (GObject *object, guint property_id,
         g_value_set_double (value, double_buffer);
         break;
     }
+    if (priv->shared_engine) {
+      g_mutex_unlock (&priv->shared_engine->mutex);
+    }
+  }
+  g_mutex_unlock (&priv->backend_mutex);
+}
+
+static void
+gst_base_backend_apply_property (GstBaseBackend *self,
+                                 GstBaseBackendPrivate *priv, InferenceProperty *property,
+                                 r2i::RuntimeError &error) {
+  property->apply_inference_property(self, priv->params, error);
+
+  for (auto &pool_engine : *priv->pool) {
+    if (error.IsError ()) {
+      break;
+    }
+    property->apply_inference_property(self, pool_engine.params, error);
+  }
+}
+
+static void
+gst_base_backend_copy_params (GstBaseBackend *self,
+                              std::shared_ptr < r2i::IParameters > src,
+                              std::shared_ptr < r2i::IParameters > dst,
+                              std::vector<r2i::ParameterMeta> &params) {
+  r2i::RuntimeError error;
+  int int_buffer;
+  double double_buffer;
+  std::string string_buffer;
+
+  /* Best effort, parameters that were never set may fail to read */
+  for (auto &param : params) {
+    if (!(r2i::ParameterMeta::Flags::READ & param.flags) ||
+        !(r2i::ParameterMeta::Flags::WRITE & param.flags)) {
+      continue;
+    }
+
+    switch (param.type) {
+      case (r2i::ParameterMeta::Type::INTEGER):
+        error = src->Get (param.name, int_buffer);
+        if (!error.IsError ()) {
+          error = dst->Set (param.name, int_buffer);
+        }
+        break;
+      case (r2i::ParameterMeta::Type::STRING):
+        error = src->Get (param.name, string_buffer);
+        if (!error.IsError ()) {
+          error = dst->Set (param.name, string_buffer);
+        }
+        break;
+      case (r2i::ParameterMeta::Type::DOUBLE):
+        error = src->Get (param.name, double_buffer);
+        if (!error.IsError ()) {
+          error = dst->Set (param.name, double_buffer);
+        }
+        break;
+      default:
+        continue;
+    }
+
+    if (error.IsError ()) {
+      GST_DEBUG_OBJECT (self, "Could not copy parameter %s to the pool: %s",
+                        param.name.c_str (), error.GetDescription ().c_str ());
+    }
+  }
+}
+
+static gboolean
+gst_base_backend_make_pool (GstBaseBackend *self, GstBaseBackendPrivate *priv,
+                            std::vector<r2i::ParameterMeta> &params,
+                            r2i::RuntimeError &error) {
+  GstBaseBackendPoolEngine pool_engine;
+  guint num_engines = priv->num_engines;
+  guint i;
+
+  /* A shared engine is already serialized between its backends */
+  if (priv->shared_engine) {
+    if (num_engines > 1) {
+      GST_WARNING_OBJECT (self, "Engines are shared, ignoring %u engines",
+                          num_engines);
+    }
+    num_engines = 1;
+  }
+
+  if (priv->pool->size () + 1 == num_engines) {
+    return TRUE;
+  }
+
+  gst_base_backend_clear_pool (priv);
+  if (1 == num_engines) {
+    return TRUE;
+  }
+
+  GST_INFO_OBJECT (self, "Creating a pool of %u engines", num_engines);
+
+  /* The new engines start with the parameters the first one has, the
+   * queued ones are applied to all of them afterwards */
+  for (i = 1; i < num_engines; i++) {
+    pool_engine.engine = priv->factory->MakeEngine (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to start the backend engine");
+      goto error;
+    }
+
+    error = pool_engine.engine->SetModel (priv->model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to set model to engine");
+      goto error;
+    }
+
+    pool_engine.params = priv->factory->MakeParameters (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to set get parameters for backend");
+      goto error;
+    }
+
+    error = pool_engine.params->Configure(pool_engine.engine, priv->model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to configure mode to backend");
+      goto error;
+    }
+
+    pool_engine.frame = priv->factory->MakeFrame (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to create the backend frame");
+      goto error;
+    }
+
+    gst_base_backend_copy_params (self, priv->params, pool_engine.params,
+                                  params);
+    priv->pool->push_back (pool_engine);
+  }
+
+  priv->idle_engines = g_async_queue_new ();
+  for (i = 0; i < num_engines; i++) {
+    g_async_queue_push (priv->idle_engines, GUINT_TO_POINTER (i + 1));
+  }
+
+  return TRUE;
+
+error:
+  gst_base_backend_clear_pool (priv);
+  return FALSE;
+}
+
+static void
+gst_base_backend_clear_pool (GstBaseBackendPrivate *priv) {
+  if (priv->idle_engines) {
+    g_async_queue_unref (priv->idle_engines);
+    priv->idle_engines = NULL;
+  }
+
+  if (priv->pool) {
+    priv->pool->clear ();
+  }
+}
+
+/* Waits for an idle engine of the pool, or takes the only one there is,
+ * along with the frame predictions on it use */
+static guint
+gst_base_backend_acquire_engine (GstBaseBackendPrivate *priv,
+                                 std::shared_ptr < r2i::IEngine > &engine,
+                                 std::shared_ptr < r2i::IFrame > &frame) {
+  guint index = 0;
+
+  /* Without a pool, callers take turns on the only engine */
+  if (priv->idle_engines) {
+    index = GPOINTER_TO_UINT (g_async_queue_pop (priv->idle_engines)) - 1;
+  } else {
+    g_mutex_lock (&priv->engine_mutex);
+  }
+
+  if (0 == index) {
+    engine = priv->engine;
+    frame = priv->frame;
+  } else {
+    engine = (*priv->pool)[index - 1].engine;
+    frame = (*priv->pool)[index - 1].frame;
+  }
+
+  return index;
+}
+
+static void
+gst_base_backend_release_engine (GstBaseBackendPrivate *priv, guint index) {
+  if (priv->idle_engines) {
+    g_async_queue_push (priv->idle_engines, GUINT_TO_POINTER (index + 1));
+  } else {
+    g_mutex_unlock (&priv->engine_mutex);
+  }
+}
+
+static gboolean
+gst_base_backend_apply_before_start (GstBaseBackend *self,
+                                     GstBaseBackendPrivate *priv, std::vector<r2i::ParameterMeta> &params,
+                                     gboolean apply, r2i::RuntimeError &error) {
+  InferenceProperty *property;
+  std::list<InferenceProperty *>::iterator property_it;
+  std::vector<r2i::ParameterMeta>::iterator param_it;
+  gboolean before_start;
+
+  property_it = priv->property_list->begin();
+  while (property_it != priv->property_list->end()) {
+    property = *property_it;
+    before_start = FALSE;
+    for (param_it = params.begin(); param_it != params.end(); ++param_it) {
+      if (!g_strcmp0(property->get_name(), param_it->name.c_str())) {
+        before_start = r2i::ParameterMeta::Flags::WRITE_BEFORE_START &
+                       param_it->flags;
+        break;
+      }
+    }
+
+    if (!before_start) {
+      ++property_it;
+      continue;
+    }
+
+    if (apply) {
+      gst_base_backend_apply_property (self, priv, property, error);
+    }
+    delete property;
+    property_it = priv->property_list->erase(property_it);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to set backend parameters");
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static std::string
+gst_base_backend_model_key (GstBaseBackendPrivate *priv,
+                            const gchar *model_location, std::vector<r2i::ParameterMeta> &params) {
+  /* Sorted by name, the last value set wins as when applying them */
+  std::map < std::string, std::string > values;
+  std::string key;
+
+  for (auto property : *priv->property_list) {
+    for (auto &param : params) {
+      if (!g_strcmp0(property->get_name(), param.name.c_str())) {
+        if (r2i::ParameterMeta::Flags::WRITE_BEFORE_START & param.flags) {
+          values[param.name] = property->to_string ();
+        }
+        break;
+      }
+    }
+  }
+
+  key = std::to_string (static_cast<int>(priv->code)) + "\n" + model_location;
+  for (auto &value : values) {
+    key += "\n" + value.first + "=" + value.second;
+  }
+
+  return key;
+}
+
+static gboolean
+gst_base_backend_share (GstBaseBackend *self, GstBaseBackendPrivate *priv,
+                        const gchar *model_location, std::vector<r2i::ParameterMeta> &params,
+                        r2i::RuntimeError &error) {
+  std::shared_ptr < GstBaseBackendModelEntry > entry;
+  std::shared_ptr < GstBaseBackendEngineEntry > engine;
+  std::shared_ptr < r2i::IEngine > own_engine;
+  std::map < std::string, std::weak_ptr < GstBaseBackendModelEntry > >::iterator
+  it;
+  std::string key;
+
+  /* The write-before-start parameters are part of the key */
+  priv->params = priv->factory->MakeParameters (error);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to set get parameters for backend");
+    return FALSE;
+  }
+  error = priv->params->List (params);
+  if (error.IsError ()) {
+    GST_ERROR_OBJECT (self, "Failed to list the backend parameters");
+    return FALSE;
+  }
+  key = gst_base_backend_model_key (priv, model_location, params);
+
+  g_mutex_lock (&gst_base_backend_registry_mutex);
+  for (it = gst_base_backend_registry.begin ();
+       it != gst_base_backend_registry.end ();) {
+    if (it->second.expired ()) {
+      it = gst_base_backend_registry.erase (it);
+    } else {
+      ++it;
+    }
   }
+  entry = gst_base_backend_registry[key].lock ();
+  if (!entry) {
+    entry = std::make_shared < GstBaseBackendModelEntry > ();
+    gst_base_backend_registry[key] = entry;
+  }
+  g_mutex_unlock (&gst_base_backend_registry_mutex);
+
+  /* Other backends of the same model wait for it here instead of
+   * loading it again */
+  g_mutex_lock (&entry->mutex);
+
+  if (entry->model) {
+    GST_INFO_OBJECT (self, "Sharing the loaded model %s", model_location);
+  } else {
+    entry->loader = priv->factory->MakeLoader (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to start the model loader");
+      goto unlock;
+    }
+
+    entry->model = entry->loader->Load (model_location, error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to load model");
+      entry->model = nullptr;
+      goto unlock;
+    }
+  }
+
+  if (GST_BASE_BACKEND_SHARING_ENGINE == priv->sharing) {
+    engine = entry->engine.lock ();
+  }
+
+  if (engine) {
+    GST_INFO_OBJECT (self, "Sharing the engine of %s", model_location);
+    priv->params = engine->params;
+  } else {
+    own_engine = priv->factory->MakeEngine (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to start the backend engine");
+      goto unlock;
+    }
+
+    error = own_engine->SetModel (entry->model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to set model to engine");
+      goto unlock;
+    }
+
+    error = priv->params->Configure(own_engine, entry->model);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to configure mode to backend");
+      goto unlock;
+    }
+
+    if (GST_BASE_BACKEND_SHARING_ENGINE == priv->sharing) {
+      engine = std::make_shared < GstBaseBackendEngineEntry > ();
+      engine->model = entry;
+      engine->engine = own_engine;
+      engine->params = priv->params;
+      entry->engine = engine;
+    }
+  }
+
+  priv->shared_model = entry;
+  priv->shared_engine = engine;
+  priv->loader = entry->loader;
+  priv->model = entry->model;
+  priv->engine = engine ? engine->engine : own_engine;
+
+unlock:
+  g_mutex_unlock (&entry->mutex);
+
+  return !error.IsError ();
 }
 
 gboolean
@@ -301,16 +799,17 @@ gst_base_backend_start (GstBaseBackend *self, const gchar *model_location,
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
   r2i::RuntimeError error;
   InferenceProperty *property;
-  std::list<InferenceProperty *>::iterator property_it;
-  static std::vector<r2i::ParameterMeta> params;
-  static std::vector<r2i::ParameterMeta>::iterator param_it;
+  gboolean started = FALSE;
 
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (model_location, FALSE);
   g_return_val_if_fail (err, FALSE);
 
+  std::vector<r2i::ParameterMeta> &params = *priv->param_metas;
+
 
   if (!priv->backend_created) {
+    params.clear ();
     priv->factory = r2i::IFrameworkFactory::MakeFactory (priv->code,
                     error);
     if (error.IsError ()) {
@@ -318,6 +817,15 @@ gst_base_backend_start (GstBaseBackend *self, const gchar *model_location,
       goto error;
     }
 
+    if (GST_BASE_BACKEND_SHARING_NONE != priv->sharing) {
+      if (!gst_base_backend_share (self, priv, model_location, params,
+                                   error)) {
+        goto error;
+      }
+      priv->backend_created = true;
+      goto created;
+    }
+
     priv->engine = priv->factory->MakeEngine (error);
     if (error.IsError ()) {
       GST_ERROR_OBJECT (self, "Failed to start the backend engine");
@@ -360,42 +868,77 @@ gst_base_backend_start (GstBaseBackend *self, const gchar *model_location,
     priv->backend_created = true;
   }
 
+created:
+  if (!priv->frame) {
+    priv->frame = priv->factory->MakeFrame (error);
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to create the backend frame");
+      goto error;
+    }
+  }
+
   g_mutex_lock (&priv->backend_mutex);
-  for (property_it = priv->property_list->begin();
-       property_it != priv->property_list->end(); ++property_it) {
-    property = *property_it;
-    for (param_it = params.begin(); param_it != params.end(); ++param_it) {
-      if (!g_strcmp0(property->get_name(), param_it->name.c_str())) {
-        if (r2i::ParameterMeta::Flags::WRITE_BEFORE_START & param_it->flags) {
-          property->apply_inference_property(self, priv->params, error);
-          property->~InferenceProperty();
-          priv->property_list->erase(property_it--);
-          if (error.IsError ()) {
-            GST_ERROR_OBJECT (self, "Failed to set backend parameters");
-	    goto start_error;
-          }
-        }
+
+  /* A shared model is configured and started by one backend at a time */
+  if (priv->shared_model) {
+    g_mutex_lock (&priv->shared_model->mutex);
+  }
+
+  /* A running shared engine already got the same write-before-start
+   * parameters, they are part of the key */
+  if (priv->shared_engine && priv->shared_engine->started) {
+    gst_base_backend_apply_before_start (self, priv, params, FALSE, error);
+  } else if (gst_base_backend_make_pool (self, priv, params, error)
+             && gst_base_backend_apply_before_start (self, priv, params, TRUE,
+                 error)) {
+    error = priv->engine->Start ();
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to start the backend engine");
+    } else if (priv->shared_engine) {
+      priv->shared_engine->started = TRUE;
+    }
+
+    for (auto &pool_engine : *priv->pool) {
+      if (error.IsError ()) {
         break;
       }
+      error = pool_engine.engine->Start ();
+      if (error.IsError ()) {
+        GST_ERROR_OBJECT (self, "Failed to start the backend engine pool");
+      }
     }
   }
+  started = !error.IsError ();
 
-  error = priv->engine->Start ();
-  if (error.IsError ()) {
-    GST_ERROR_OBJECT (self, "Failed to start the backend engine");
+  if (priv->shared_model) {
+    g_mutex_unlock (&priv->shared_model->mutex);
+  }
+
+  if (!started) {
     goto start_error;
   }
 
+  if (priv->shared_engine) {
+    g_mutex_lock (&priv->shared_engine->mutex);
+  }
   while (!priv->property_list->empty()) {
     property = priv->property_list->front();
-    property->apply_inference_property(self, priv->params, error);
-    property->~InferenceProperty();
+    gst_base_backend_apply_property (self, priv, property, error);
+    delete property;
     priv->property_list->pop_front();
     if (error.IsError ()) {
       GST_ERROR_OBJECT (self, "Failed to set backend parameters");
-      goto start_error;
+      break;
     }
   }
+  if (priv->shared_engine) {
+    g_mutex_unlock (&priv->shared_engine->mutex);
+  }
+
+  if (error.IsError ()) {
+    goto start_error;
+  }
+
   priv->backend_started = true;
   g_mutex_unlock (&priv->backend_mutex);
 
@@ -418,6 +961,27 @@ gst_base_backend_stop (GstBaseBackend *self, GError **err) {
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (err, FALSE);
 
+  /* The last backend using a shared engine stops it, the next start
+   * looks it up again */
+  if (priv->shared_engine) {
+    g_mutex_lock (&priv->backend_mutex);
+    priv->engine = nullptr;
+    priv->params = nullptr;
+    priv->shared_engine = nullptr;
+    priv->backend_created = false;
+    priv->backend_started = false;
+    g_mutex_unlock (&priv->backend_mutex);
+    return TRUE;
+  }
+
+  for (auto &pool_engine : *priv->pool) {
+    error = pool_engine.engine->Stop ();
+    if (error.IsError ()) {
+      GST_ERROR_OBJECT (self, "Failed to stop the backend engine pool");
+      goto error;
+    }
+  }
+
   error = priv->engine->Stop ();
   if (error.IsError ()) {
     GST_ERROR_OBJECT (self, "Failed to stop the backend engine");
@@ -453,88 +1017,140 @@ gst_base_backend_cast_format (GstVideoFormat format) {
   return image_format;
 }
 
-gboolean
-gst_base_backend_process_frame (GstBaseBackend *self, GstVideoFrame *input_frame,
-                           gpointer *prediction_data, gsize *prediction_size, GError **err) {
-  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
-  std::vector<std::shared_ptr<r2i::IPrediction>> predictions;
-  std::shared_ptr < r2i::IFrame > frame;
-  r2i::RuntimeError error;
-  gint num_outputs = 0;
-  gsize extra_size = 0;
-  gpointer data = NULL;
-  gpointer data_offset = 0;
-  gsize size = 0;
-  gint i = 0;
+typedef std::vector<std::shared_ptr<r2i::IPrediction>> GstBaseBackendPredictions;
 
-  g_return_val_if_fail (priv, FALSE);
-  g_return_val_if_fail (input_frame, FALSE);
-  g_return_val_if_fail (prediction_data, FALSE);
-  g_return_val_if_fail (prediction_size, FALSE);
-  g_return_val_if_fail (err, FALSE);
+static void
+gst_base_backend_free_predictions (gpointer data) {
+  delete static_cast<GstBaseBackendPredictions *>(data);
+}
 
-  frame = priv->factory->MakeFrame (error);
-  if (error.IsError ()) {
-    goto error;
-  }
+static gboolean
+gst_base_backend_predict (GstBaseBackend *self, GstBaseBackendPrivate *priv,
+                          std::shared_ptr < r2i::IEngine > engine,
+                          std::shared_ptr < r2i::IFrame > frame, GstVideoFrame *input_frame,
+                          GstInferenceTensorList **tensors, r2i::RuntimeError &error) {
+  GstBaseBackendPredictions *predictions = new GstBaseBackendPredictions ();
+  GstInferenceTensor *tensor = NULL;
+  gint num_outputs = 0;
+  gint i = 0;
 
   GST_LOG_OBJECT (self, "Processing Frame of size %d x %d",
                   input_frame->info.width, input_frame->info.height);
 
+  /* Backends sharing an engine take turns on it, the frame points to
+   * the input until the prediction is done */
+  if (priv->shared_engine) {
+    g_mutex_lock (&priv->shared_engine->mutex);
+  }
+
   error =
     frame->Configure (input_frame->data[0], input_frame->info.width,
                       input_frame->info.height,
                       gst_base_backend_cast_format(input_frame->info.finfo->format),
                       r2i::DataType::Id::FLOAT);
   if (error.IsError ()) {
-    goto error;
+    goto unlock;
   }
 
-  error = priv->engine->Predict (frame, predictions);
+  error = engine->Predict (frame, *predictions);
 
   /* We verify it the error is not implemented to keep compatibility with
    backends that do not support multiple predictions */
   if (r2i::RuntimeError::Code::NOT_IMPLEMENTED == error.GetCode()) {
     std::shared_ptr < r2i::IPrediction > prediction;
 
-    prediction = priv->engine->Predict (frame, error);
-    predictions.push_back(prediction);
+    prediction = engine->Predict (frame, error);
+    predictions->push_back(prediction);
+  }
+
+unlock:
+  if (priv->shared_engine) {
+    g_mutex_unlock (&priv->shared_engine->mutex);
   }
 
   if (error.IsError ()) {
-    goto error;
+    goto free_predictions;
   }
 
-  num_outputs = predictions.size();
+  num_outputs = predictions->size();
   GST_LOG_OBJECT (self, "Got %d predictions", num_outputs);
 
   if (0 == num_outputs) {
     error.Set (r2i::RuntimeError::Code::WRONG_ENGINE_STATE,
                "Engine got 0 predictions");
-    goto error;
+    goto free_predictions;
   }
 
-  /* Concatenate all the outputs in a 1D array */
+  /* The views borrow the prediction buffers, the list keeps the
+   predictions alive until it is freed */
+  *tensors = gst_inference_tensor_list_new (num_outputs, predictions,
+             gst_base_backend_free_predictions);
   for (i = 0; i < num_outputs; i++) {
-    /* Compute the size including the new tensor and reallocate memory */
-    extra_size = predictions[i]->GetResultSize ();
-    data = g_realloc (data, size + extra_size);
+    tensor = &(*tensors)->tensors[i];
+    tensor->data = (*predictions)[i]->GetResultData ();
+    tensor->size = (*predictions)[i]->GetResultSize ();
+    /* Frames are configured as float, so are the outputs */
+    tensor->type = GST_INFERENCE_TENSOR_TYPE_FLOAT;
+    tensor->num_elements = tensor->size / sizeof (gfloat);
+
+    GST_LOG_OBJECT (self, "Output %d at %p has %lu bytes", i, tensor->data,
+                    tensor->size);
+  }
+
+  return TRUE;
+
+free_predictions:
+  delete predictions;
+  return FALSE;
+}
 
-    /* Compute the offset to concatenate the new tensor */
-    data_offset = (void *) ((gsize) data + size);
-    /* Could we avoid memory copy ?*/
-    memcpy (data_offset, predictions[i]->GetResultData (), extra_size);
-    size += extra_size;
+gboolean
+gst_base_backend_process_frame (GstBaseBackend *self, GstVideoFrame *input_frame,
+                           gpointer *prediction_data, gsize *prediction_size, GError **err) {
+  GstInferenceTensorList *tensors = NULL;
+
+  g_return_val_if_fail (prediction_data, FALSE);
+  g_return_val_if_fail (prediction_size, FALSE);
+
+  if (!gst_base_backend_process_frame_tensors (self, input_frame, &tensors,
+      err)) {
+    return FALSE;
   }
 
-  *prediction_size = size;
-  *prediction_data = data;
+  /* Kept for consumers that expect all the outputs in a single array */
+  *prediction_data = gst_inference_tensor_list_concat (tensors,
+                     prediction_size);
+  gst_inference_tensor_list_free (tensors);
 
   GST_LOG_OBJECT (self, "Size of prediction %p is %lu",
                   *prediction_data, *prediction_size);
 
-  frame = nullptr;
-  predictions.clear();
+  return TRUE;
+}
+
+gboolean
+gst_base_backend_process_frame_tensors (GstBaseBackend *self,
+                                        GstVideoFrame *input_frame, GstInferenceTensorList **tensors,
+                                        GError **err) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::shared_ptr < r2i::IEngine > engine;
+  std::shared_ptr < r2i::IFrame > frame;
+  r2i::RuntimeError error;
+  gboolean predicted;
+  guint index;
+
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (input_frame, FALSE);
+  g_return_val_if_fail (tensors, FALSE);
+  g_return_val_if_fail (err, FALSE);
+
+  index = gst_base_backend_acquire_engine (priv, engine, frame);
+  predicted = gst_base_backend_predict (self, priv, engine, frame,
+                                        input_frame, tensors, error);
+  gst_base_backend_release_engine (priv, index);
+  if (!predicted) {
+    goto error;
+  }
 
   return TRUE;
 error:
@@ -544,6 +1160,57 @@ error:
   return FALSE;
 }
 
+gboolean
+gst_base_backend_process_batch (GstBaseBackend *self, GstVideoFrame **input_frames,
+                                guint num_frames, GstInferenceTensorList **tensors, GError **err) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (self);
+  std::shared_ptr < r2i::IEngine > engine;
+  std::shared_ptr < r2i::IFrame > frame;
+  r2i::RuntimeError error;
+  guint index;
+  guint i = 0;
+
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (input_frames, FALSE);
+  g_return_val_if_fail (tensors, FALSE);
+  g_return_val_if_fail (err, FALSE);
+
+  GST_LOG_OBJECT (self, "Processing batch of %u frames", num_frames);
+
+  for (i = 0; i < num_frames; i++) {
+    tensors[i] = NULL;
+  }
+
+  /* The whole batch runs on the same engine. R2Inference frames describe
+   * a single image, so its frame is reconfigured for every tensor */
+  index = gst_base_backend_acquire_engine (priv, engine, frame);
+  for (i = 0; i < num_frames; i++) {
+    if (!gst_base_backend_predict (self, priv, engine, frame, input_frames[i],
+                                   &tensors[i], error)) {
+      break;
+    }
+  }
+  gst_base_backend_release_engine (priv, index);
+
+  if (i < num_frames) {
+    goto free_predictions;
+  }
+
+  return TRUE;
+
+free_predictions:
+  for (i = 0; i < num_frames; i++) {
+    if (tensors[i]) {
+      gst_inference_tensor_list_free (tensors[i]);
+      tensors[i] = NULL;
+    }
+  }
+  g_set_error (err, GST_BASE_BACKEND_ERROR, error.GetCode (),
+               "R2Inference Error: (Code:%d) %s", error.GetCode (),
+               error.GetDescription ().c_str ());
+  return FALSE;
+}
+
 gboolean
 gst_base_backend_set_framework_code (GstBaseBackend *backend, r2i::FrameworkCode code) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (backend);
@@ -554,6 +1221,51 @@ gst_base_backend_set_framework_code (GstBaseBackend *backend, r2i::FrameworkCode
 
 }
 
+void
+gst_base_backend_set_num_engines (GstBaseBackend *backend,
+                                  guint num_engines) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (backend);
+  g_return_if_fail (priv);
+  g_return_if_fail (num_engines > 0);
+
+  /* Takes effect on the next start */
+  priv->num_engines = num_engines;
+}
+
+void
+gst_base_backend_set_sharing (GstBaseBackend *backend,
+                              GstBaseBackendSharing sharing) {
+  GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (backend);
+  g_return_if_fail (priv);
+
+  /* Takes effect the next time the model is loaded */
+  priv->sharing = sharing;
+}
+
+GType
+gst_base_backend_sharing_get_type (void) {
+  static GType type = G_TYPE_INVALID;
+  if (G_UNLIKELY (type == G_TYPE_INVALID)) {
+    static const GEnumValue values[] = {
+      {
+        GST_BASE_BACKEND_SHARING_NONE,
+        "GST_BASE_BACKEND_SHARING_NONE", "none"
+      },
+      {
+        GST_BASE_BACKEND_SHARING_MODEL,
+        "GST_BASE_BACKEND_SHARING_MODEL", "model"
+      },
+      {
+        GST_BASE_BACKEND_SHARING_ENGINE,
+        "GST_BASE_BACKEND_SHARING_ENGINE", "engine"
+      },
+      {0, NULL, NULL},
+    };
+    type = g_enum_register_static ("GstBaseBackendSharing", values);
+  }
+  return type;
+}
+
 guint
 gst_base_backend_get_framework_code (GstBaseBackend *backend) {
   GstBaseBackendPrivate *priv = GST_BASE_BACKEND_PRIVATE (backend);
@@ -24,8 +24,34 @@
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <gst/r2inference/gstinferencetensor.h>
 
 G_BEGIN_DECLS
+
+#define GST_TYPE_BASE_BACKEND_SHARING (gst_base_backend_sharing_get_type ())
+/**
+ * GstBaseBackendSharing:
+ * @GST_BASE_BACKEND_SHARING_NONE : Every backend loads its own model and
+ *   runs its own engine
+ * @GST_BASE_BACKEND_SHARING_MODEL : Backends with the same framework,
+ *   model and write-before-start parameters share the loaded model, each
+ *   one runs its own engine over it
+ * @GST_BASE_BACKEND_SHARING_ENGINE : Such backends also share a single
+ *   engine, predictions take turns on it and runtime parameters apply to
+ *   all of them
+ *
+ * How a backend shares what it loads with the other backends of the
+ * process.
+ **/
+typedef enum
+{
+  GST_BASE_BACKEND_SHARING_NONE,
+  GST_BASE_BACKEND_SHARING_MODEL,
+  GST_BASE_BACKEND_SHARING_ENGINE,
+} GstBaseBackendSharing;
+
+GType gst_base_backend_sharing_get_type (void) G_GNUC_CONST;
+
 #define GST_TYPE_BASE_BACKEND gst_base_backend_get_type ()
 G_DECLARE_DERIVABLE_TYPE (GstBaseBackend, gst_base_backend, GST, BASE_BACKEND, GObject);
 
@@ -39,8 +65,15 @@ GQuark gst_base_backend_error_quark (void);
 gboolean gst_base_backend_start (GstBaseBackend *, const gchar *, GError **);
 gboolean gst_base_backend_stop (GstBaseBackend *, GError **);
 guint gst_base_backend_get_framework_code (GstBaseBackend *);
+void gst_base_backend_set_sharing (GstBaseBackend *, GstBaseBackendSharing);
+void gst_base_backend_set_num_engines (GstBaseBackend *, guint);
 gboolean gst_base_backend_process_frame (GstBaseBackend *, GstVideoFrame *,
                                     gpointer *, gsize *, GError **);
+gboolean gst_base_backend_process_frame_tensors (GstBaseBackend *,
+                                    GstVideoFrame *, GstInferenceTensorList **,
+                                    GError **);
+gboolean gst_base_backend_process_batch (GstBaseBackend *, GstVideoFrame **,
+                                    guint, GstInferenceTensorList **, GError **);
 
 G_END_DECLS
 #endif //__GST_BASE_BACKEND_H__
@@ -29,6 +29,7 @@
 #define DEFAULT_NUM_CLASSES 0
 #define DEFAULT_PROBABILITIES NULL
 #define DEFAULT_LABELS NULL
+#define DEFAULT_TOP NULL
 
 static GType gst_inference_classification_get_type (void);
 GST_DEFINE_MINI_OBJECT_TYPE (GstInferenceClassification,
@@ -38,6 +39,8 @@ static void classification_free (GstInferenceClassification * self);
 static void classification_reset (GstInferenceClassification * self);
 
 static gdouble *probabilities_copy (const gdouble * from, gint num_classes);
+static GstInferenceClassScore *top_copy (const GstInferenceClassScore * from,
+    gint num_top);
 
 static guint64 get_new_id (void);
 
@@ -65,20 +68,25 @@ classification_reset (GstInferenceClassification * self)
   self->class_prob = DEFAULT_CLASS_PROB;
   self->num_classes = DEFAULT_NUM_CLASSES;
 
-  if (self->class_label) {
+  /* Labels that come from a shared table are not ours to free */
+  if (self->label_table) {
+    gst_inference_labels_unref (self->label_table);
+    self->label_table = NULL;
+  } else {
     g_free (self->class_label);
+    g_strfreev (self->labels);
   }
   self->class_label = DEFAULT_CLASS_LABEL;
+  self->labels = DEFAULT_LABELS;
 
   if (self->probabilities) {
     g_free (self->probabilities);
   }
   self->probabilities = DEFAULT_PROBABILITIES;
 
-  if (self->labels) {
-    g_strfreev (self->labels);
-  }
-  self->labels = DEFAULT_LABELS;
+  g_free (self->top);
+  self->top = DEFAULT_TOP;
+  self->num_top = 0;
 }
 
 GstInferenceClassification *
@@ -96,6 +104,8 @@ gst_inference_classification_new (void)
   self->class_label = NULL;
   self->probabilities = NULL;
   self->labels = NULL;
+  self->label_table = NULL;
+  self->top = NULL;
 
   classification_reset (self);
 
@@ -119,6 +129,20 @@ probabilities_copy (const gdouble * from, gint num_classes)
   return to;
 }
 
+static GstInferenceClassScore *
+top_copy (const GstInferenceClassScore * from, gint num_top)
+{
+  GstInferenceClassScore *to = NULL;
+
+  g_return_val_if_fail (from, NULL);
+  g_return_val_if_fail (num_top > 0, NULL);
+
+  to = g_new (GstInferenceClassScore, num_top);
+  memcpy (to, from, num_top * sizeof (GstInferenceClassScore));
+
+  return to;
+}
+
 GstInferenceClassification *
 gst_inference_classification_new_full (gint class_id, gdouble class_prob,
     const gchar * class_label, gint num_classes, const gdouble * probabilities,
@@ -149,6 +173,50 @@ gst_inference_classification_new_full (gint class_id, gdouble class_prob,
   return self;
 }
 
+GstInferenceClassification *
+gst_inference_classification_new_with_labels (gint class_id,
+    gdouble class_prob, gint num_classes, const gdouble * probabilities,
+    GstInferenceLabels * labels)
+{
+  GstInferenceClassification *self = gst_inference_classification_new ();
+
+  GST_INFERENCE_CLASSIFICATION_LOCK (self);
+
+  self->class_id = class_id;
+  self->class_prob = class_prob;
+  self->num_classes = num_classes;
+
+  if (probabilities && num_classes > 0) {
+    self->probabilities = probabilities_copy (probabilities, num_classes);
+  }
+
+  if (labels) {
+    self->label_table = gst_inference_labels_ref (labels);
+    self->labels = labels->labels;
+    self->class_label = (gchar *) gst_inference_labels_get (labels, class_id);
+  }
+
+  GST_INFERENCE_CLASSIFICATION_UNLOCK (self);
+
+  return self;
+}
+
+void
+gst_inference_classification_set_top (GstInferenceClassification * self,
+    const GstInferenceClassScore * top, gint num_top)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (top || 0 == num_top);
+
+  GST_INFERENCE_CLASSIFICATION_LOCK (self);
+
+  g_free (self->top);
+  self->top = num_top > 0 ? top_copy (top, num_top) : NULL;
+  self->num_top = num_top;
+
+  GST_INFERENCE_CLASSIFICATION_UNLOCK (self);
+}
+
 GstInferenceClassification *
 gst_inference_classification_ref (GstInferenceClassification * self)
 {
@@ -182,8 +250,18 @@ gst_inference_classification_copy (const GstInferenceClassification * self)
   other->class_prob = self->class_prob;
   other->num_classes = self->num_classes;
 
-  if (self->class_label) {
-    other->class_label = g_strdup (self->class_label);
+  if (self->label_table) {
+    other->label_table = gst_inference_labels_ref (self->label_table);
+    other->class_label = self->class_label;
+    other->labels = self->labels;
+  } else {
+    if (self->class_label) {
+      other->class_label = g_strdup (self->class_label);
+    }
+
+    if (self->labels) {
+      other->labels = g_strdupv (self->labels);
+    }
   }
 
   if (self->probabilities) {
@@ -191,8 +269,9 @@ gst_inference_classification_copy (const GstInferenceClassification * self)
         probabilities_copy (self->probabilities, self->num_classes);
   }
 
-  if (self->labels) {
-    other->labels = g_strdupv (self->labels);
+  if (self->top) {
+    other->top = top_copy (self->top, self->num_top);
+    other->num_top = self->num_top;
   }
 
   GST_INFERENCE_CLASSIFICATION_UNLOCK ((GstInferenceClassification *) self);
@@ -204,14 +283,28 @@ gchar *
 gst_inference_classification_to_string (GstInferenceClassification * self,
     gint level)
 {
-  gint indent = level * 2;
-  gchar *serial = NULL;
+  GString *string = NULL;
 
   g_return_val_if_fail (self, NULL);
 
+  string = g_string_new (NULL);
+  gst_inference_classification_serialize (self, level, string);
+
+  return g_string_free (string, FALSE);
+}
+
+void
+gst_inference_classification_serialize (GstInferenceClassification * self,
+    gint level, GString * string)
+{
+  gint indent = level * 2;
+
+  g_return_if_fail (self);
+  g_return_if_fail (string);
+
   GST_INFERENCE_CLASSIFICATION_LOCK (self);
 
-  serial = g_strdup_printf ("{\n"
+  g_string_append_printf (string, "{\n"
       "%*s  \"Id\" : %" G_GUINT64_FORMAT ",\n"
       "%*s  \"Class\" : %d,\n"
       "%*s  \"Label\" : \"%s\",\n"
@@ -224,8 +317,6 @@ gst_inference_classification_to_string (GstInferenceClassification * self,
       indent, "", self->class_prob, indent, "", self->num_classes, indent, "");
 
   GST_INFERENCE_CLASSIFICATION_UNLOCK (self);
-
-  return serial;
 }
 
 static void
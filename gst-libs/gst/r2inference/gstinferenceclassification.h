@@ -23,9 +23,24 @@
 #define __GST_INFERENCE_CLASSIFICATION__
 
 #include <gst/gst.h>
+#include <gst/r2inference/gstinferencelabels.h>
 
 G_BEGIN_DECLS
 
+/**
+ * GstInferenceClassScore:
+ * @class_id: the numerical id of the class
+ * @prob: the probability of the class
+ *
+ * One of the most probable classes of a classification.
+ */
+typedef struct _GstInferenceClassScore GstInferenceClassScore;
+struct _GstInferenceClassScore
+{
+  gint class_id;
+  gdouble prob;
+};
+
 /**
  * GstInferenceClassification:
  * @classification_id: a unique id associated to this classification
@@ -38,6 +53,13 @@ G_BEGIN_DECLS
  * @probabilities: the entire array of probabilities of the prediction
  * @labels: the entire array of labels of the prediction or NULL if
  * not available
+ * @num_top: the amount of entries in @top
+ * @top: the most probable classes, by descending probability, or NULL
+ * if not available
+ *
+ * When the classification was created from a #GstInferenceLabels table,
+ * @class_label and @labels point into the shared table and must not be
+ * modified or freed.
  */
 typedef struct _GstInferenceClassification GstInferenceClassification;
 struct _GstInferenceClassification
@@ -54,6 +76,11 @@ struct _GstInferenceClassification
   gint num_classes;
   gdouble *probabilities;
   gchar **labels;
+  gint num_top;
+  GstInferenceClassScore *top;
+
+  /*<private>*/
+  GstInferenceLabels *label_table;
 };
 
 /**
@@ -86,6 +113,38 @@ GstInferenceClassification * gst_inference_classification_new_full (gint class_i
     const gchar * class_label, gint num_classes, const gdouble * probabilities,
     gchar ** labels);
 
+/**
+ * gst_inference_classification_new_with_labels:
+ * @class_id: the numerical id associated to the assigned class
+ * @class_prob: the resulting probability of the assigned
+ * class. Typically between 0 and 1
+ * @num_classes: the amount of classes of the entire prediction
+ * @probabilities: the entire array of probabilities of the
+ * prediction. A copy of the array is made.
+ * @labels: the label table of the prediction or NULL if not
+ * available. A reference is taken, no strings are copied.
+ *
+ * Creates a new GstInferenceClassification whose labels are looked up
+ * in a shared label table.
+ *
+ * Returns: A newly allocated and initialized GstInferenceClassification.
+ */
+GstInferenceClassification * gst_inference_classification_new_with_labels (
+    gint class_id, gdouble class_prob, gint num_classes,
+    const gdouble * probabilities, GstInferenceLabels * labels);
+
+/**
+ * gst_inference_classification_set_top:
+ * @self: the classification to modify
+ * @top: the most probable classes, by descending probability. A copy
+ * of the array is made.
+ * @num_top: the amount of entries in @top
+ *
+ * Replaces the most probable classes of a classification.
+ */
+void gst_inference_classification_set_top (GstInferenceClassification * self,
+    const GstInferenceClassScore * top, gint num_top);
+
 /**
  * gst_inference_classification_reset:
  * @self: the classification to reset 
@@ -99,8 +158,8 @@ void gst_inference_classification_reset (GstInferenceClassification * self);
  * @self: the classification to copy
  *
  * Copies a classification into a newly allocated one. This is a deep
- * copy, meaning that all arrays are copied as well. No pointers are
- * shared.
+ * copy, meaning that all arrays are copied as well, except for a shared
+ * label table which is only referenced.
  *
  * Returns: a newly allocated copy of the original classification
  */
@@ -137,6 +196,17 @@ void gst_inference_classification_unref (GstInferenceClassification * self);
  */
 gchar * gst_inference_classification_to_string (GstInferenceClassification * self, gint level);
 
+/**
+ * gst_inference_classification_serialize:
+ * @self: the classification to serialize
+ * @level: the indentation level
+ * @string: the string to append the serialization to
+ *
+ * Appends the same serialization as
+ * gst_inference_classification_to_string() to @string.
+ */
+void gst_inference_classification_serialize (GstInferenceClassification * self, gint level, GString * string);
+
 /**
  * GST_INFERENCE_CLASSIFICATION_LOCK:
  * @c: The GstInferenceClassification to lock
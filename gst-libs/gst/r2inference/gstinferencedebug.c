@@ -32,8 +32,14 @@ gst_inference_print_predictions (GstVideoInference * vi,
   g_return_if_fail (category != NULL);
   g_return_if_fail (inference_meta != NULL);
 
-  pred = inference_meta->prediction;
+  /* Serializing the whole tree is too expensive to do for nothing */
+  if (gst_debug_category_get_threshold (category) < GST_LEVEL_LOG) {
+    return;
+  }
+
+  pred = gst_inference_meta_ref_prediction (inference_meta);
   spred = gst_inference_prediction_to_string (pred);
+  gst_inference_prediction_unref (pred);
 
   GST_CAT_LOG (category, "\n%s", spred);
 
@@ -0,0 +1,112 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencelabels.h"
+
+static GType gst_inference_labels_get_type (void);
+GST_DEFINE_MINI_OBJECT_TYPE (GstInferenceLabels, gst_inference_labels);
+
+static GstInferenceLabels *labels_new (gchar ** labels);
+static GstInferenceLabels *labels_copy (const GstInferenceLabels * self);
+static void labels_free (GstInferenceLabels * self);
+
+/* The table is immutable, so a copy can be the table itself */
+static GstInferenceLabels *
+labels_copy (const GstInferenceLabels * self)
+{
+  return gst_inference_labels_ref ((GstInferenceLabels *) self);
+}
+
+/* Takes ownership of labels */
+static GstInferenceLabels *
+labels_new (gchar ** labels)
+{
+  GstInferenceLabels *self = g_slice_new (GstInferenceLabels);
+
+  gst_mini_object_init (GST_MINI_OBJECT_CAST (self), 0,
+      gst_inference_labels_get_type (),
+      (GstMiniObjectCopyFunction) labels_copy, NULL,
+      (GstMiniObjectFreeFunction) labels_free);
+
+  self->labels = labels;
+  self->num_labels = g_strv_length (labels);
+
+  return self;
+}
+
+GstInferenceLabels *
+gst_inference_labels_new (const gchar * labels)
+{
+  if (NULL == labels) {
+    return NULL;
+  }
+
+  return labels_new (g_strsplit (labels, ";", 0));
+}
+
+GstInferenceLabels *
+gst_inference_labels_new_from_strv (gchar ** labels)
+{
+  if (NULL == labels) {
+    return NULL;
+  }
+
+  return labels_new (g_strdupv (labels));
+}
+
+const gchar *
+gst_inference_labels_get (const GstInferenceLabels * self, gint index)
+{
+  g_return_val_if_fail (self, NULL);
+
+  if (index < 0 || index >= self->num_labels) {
+    return NULL;
+  }
+
+  return self->labels[index];
+}
+
+GstInferenceLabels *
+gst_inference_labels_ref (GstInferenceLabels * self)
+{
+  g_return_val_if_fail (self, NULL);
+
+  return (GstInferenceLabels *)
+      gst_mini_object_ref (GST_MINI_OBJECT_CAST (self));
+}
+
+void
+gst_inference_labels_unref (GstInferenceLabels * self)
+{
+  g_return_if_fail (self);
+
+  gst_mini_object_unref (GST_MINI_OBJECT_CAST (self));
+}
+
+static void
+labels_free (GstInferenceLabels * self)
+{
+  g_strfreev (self->labels);
+  self->labels = NULL;
+  self->num_labels = 0;
+
+  g_slice_free (GstInferenceLabels, self);
+}
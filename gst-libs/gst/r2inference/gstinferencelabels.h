@@ -0,0 +1,103 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_LABELS__
+#define __GST_INFERENCE_LABELS__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstInferenceLabels:
+ * @num_labels: the amount of labels in the table
+ * @labels: NULL terminated array with the labels
+ *
+ * Immutable table of labels, shared by reference between the element
+ * that created it and every classification that uses it. Neither the
+ * array nor the strings may be modified.
+ */
+typedef struct _GstInferenceLabels GstInferenceLabels;
+struct _GstInferenceLabels
+{
+  /*<private>*/
+  GstMiniObject base;
+
+  /*<public>*/
+  gint num_labels;
+  gchar **labels;
+};
+
+/**
+ * gst_inference_labels_new:
+ * @labels: the labels separated by semicolons
+ *
+ * Creates a new GstInferenceLabels by splitting @labels.
+ *
+ * Returns: A newly allocated GstInferenceLabels, or NULL if @labels is
+ * NULL.
+ */
+GstInferenceLabels * gst_inference_labels_new (const gchar * labels);
+
+/**
+ * gst_inference_labels_new_from_strv:
+ * @labels: NULL terminated array of labels. A copy is made.
+ *
+ * Creates a new GstInferenceLabels from an array of labels.
+ *
+ * Returns: A newly allocated GstInferenceLabels, or NULL if @labels is
+ * NULL.
+ */
+GstInferenceLabels * gst_inference_labels_new_from_strv (gchar ** labels);
+
+/**
+ * gst_inference_labels_get:
+ * @self: the label table
+ * @index: the numerical id of the class
+ *
+ * Returns: the label of the class, or NULL if out of range. The label
+ * belongs to @self.
+ */
+const gchar * gst_inference_labels_get (const GstInferenceLabels * self,
+    gint index);
+
+/**
+ * gst_inference_labels_ref:
+ * @self: the label table to ref
+ *
+ * Increase the reference counter of the label table.
+ *
+ * Returns: the same label table, for convenience purposes.
+ */
+GstInferenceLabels * gst_inference_labels_ref (GstInferenceLabels * self);
+
+/**
+ * gst_inference_labels_unref:
+ * @self: the label table to unref
+ *
+ * Decreases the reference counter of the label table. When the
+ * reference counter hits zero, the table is freed.
+ */
+void gst_inference_labels_unref (GstInferenceLabels * self);
+
+G_END_DECLS
+
+#endif // __GST_INFERENCE_LABELS__
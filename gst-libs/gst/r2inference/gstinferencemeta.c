@@ -24,11 +24,80 @@
 #include <gst/video/video.h>
 #include <string.h>
 
+/* Binary encoding, every field is little-endian. See
+ * GST_INFERENCE_META_SERIAL_VERSION */
+#define SERIAL_MAGIC "GINF"
+#define SERIAL_NONE G_MAXUINT32
+#define SERIAL_ENABLED (1 << 0)
+
+/* Header: magic, version, the sizes of the header and of each record,
+ * the size of everything, the amount of each record, the size of the
+ * strings and the stream id string */
+#define SERIAL_HEADER_SIZE 40
+#define SERIAL_HEADER_VERSION 4
+#define SERIAL_HEADER_HEADER_SIZE 6
+#define SERIAL_HEADER_NODE_SIZE 8
+#define SERIAL_HEADER_CLASS_SIZE 10
+#define SERIAL_HEADER_SCORE_SIZE 12
+#define SERIAL_HEADER_SIZE_ALL 16
+#define SERIAL_HEADER_NUM_NODES 20
+#define SERIAL_HEADER_NUM_CLASSES 24
+#define SERIAL_HEADER_NUM_SCORES 28
+#define SERIAL_HEADER_STRINGS_SIZE 32
+#define SERIAL_HEADER_STREAM_ID 36
+
+/* Node: id, box, parent, classifications and flags */
+#define SERIAL_NODE_SIZE 40
+#define SERIAL_NODE_ID 0
+#define SERIAL_NODE_X 8
+#define SERIAL_NODE_Y 12
+#define SERIAL_NODE_WIDTH 16
+#define SERIAL_NODE_HEIGHT 20
+#define SERIAL_NODE_PARENT 24
+#define SERIAL_NODE_FIRST_CLASS 28
+#define SERIAL_NODE_NUM_CLASSES 32
+#define SERIAL_NODE_FLAGS 36
+
+/* Classification: id, probability, class, label string and scores */
+#define SERIAL_CLASS_SIZE 40
+#define SERIAL_CLASS_ID 0
+#define SERIAL_CLASS_PROB 8
+#define SERIAL_CLASS_CLASS_ID 16
+#define SERIAL_CLASS_NUM_CLASSES 20
+#define SERIAL_CLASS_LABEL 24
+#define SERIAL_CLASS_FIRST_SCORE 28
+#define SERIAL_CLASS_NUM_SCORES 32
+
+/* Top score: probability and class */
+#define SERIAL_SCORE_SIZE 16
+#define SERIAL_SCORE_PROB 0
+#define SERIAL_SCORE_CLASS_ID 8
+
+typedef struct _SerialState SerialState;
+struct _SerialState
+{
+  guint num_nodes;
+  guint num_classes;
+  guint num_scores;
+  gsize strings_size;
+
+  guint8 *nodes;
+  guint8 *classes;
+  guint8 *scores;
+  gchar *strings;
+};
+
 static gboolean gst_inference_meta_init (GstMeta * meta,
     gpointer params, GstBuffer * buffer);
 static void gst_inference_meta_free (GstMeta * meta, GstBuffer * buffer);
 static gboolean gst_inference_meta_transform (GstBuffer * transbuf,
     GstMeta * meta, GstBuffer * buffer, GQuark type, gpointer data);
+static void meta_replace_prediction (GstInferenceMeta * meta,
+    GstInferencePrediction * prediction);
+static void serial_count (GstInferencePrediction * pred, SerialState * state);
+static guint32 serial_write_string (SerialState * state, const gchar * str);
+static void serial_write (GstInferencePrediction * pred, gint parent,
+    SerialState * state);
 
 GType
 gst_inference_meta_api_get_type (void)
@@ -66,6 +135,7 @@ gst_inference_meta_transform_existing_meta (GstBuffer * dest, GstMeta * meta,
 {
   GstInferenceMeta *dmeta, *smeta;
   GstInferencePrediction *pred = NULL;
+  GstInferencePrediction *sroot = NULL;
   gboolean ret = TRUE;
   gboolean needs_scale = FALSE;
 
@@ -80,17 +150,21 @@ gst_inference_meta_transform_existing_meta (GstBuffer * dest, GstMeta * meta,
 
   g_return_val_if_fail (dmeta, FALSE);
 
+  /* Merging reads the source tree as it is now and writes to dest */
+  sroot = gst_inference_meta_ref_prediction (smeta);
   pred =
-      gst_inference_prediction_find (dmeta->prediction,
-      smeta->prediction->prediction_id);
+      gst_inference_prediction_find (gst_inference_meta_get_prediction
+      (dmeta), sroot->prediction_id);
 
   if (!pred) {
     GST_ERROR
         ("Predictions between metas do not match. Something really wrong happened");
+    gst_inference_prediction_unref (sroot);
     g_return_val_if_reached (FALSE);
   }
 
-  needs_scale = gst_inference_prediction_merge (smeta->prediction, pred);
+  needs_scale = gst_inference_prediction_merge (sroot, pred);
+  gst_inference_prediction_unref (sroot);
 
   /* Transfer Stream ID */
   g_free (dmeta->stream_id);
@@ -140,25 +214,37 @@ gst_inference_meta_transform_new_meta (GstBuffer * dest, GstMeta * meta,
     return FALSE;
   }
 
-  gst_inference_prediction_unref (dmeta->prediction);
-
   /* Transfer Stream ID */
   g_free (dmeta->stream_id);
   dmeta->stream_id = g_strdup (smeta->stream_id);
 
+  /* Both metas share the tree, it is copied or scaled only when one of
+   * them actually needs it */
   if (GST_META_TRANSFORM_IS_COPY (type)) {
     GST_LOG ("Copy inference metadata");
 
-    dmeta->prediction = gst_inference_prediction_copy (smeta->prediction);
+    g_mutex_lock (&smeta->lock);
+    meta_replace_prediction (dmeta,
+        gst_inference_prediction_ref (smeta->prediction));
+    dmeta->scale_pending = smeta->scale_pending;
+    dmeta->scale_from = smeta->scale_from;
+    dmeta->scale_to = smeta->scale_to;
+    g_mutex_unlock (&smeta->lock);
     return TRUE;
   }
 
   if (GST_VIDEO_META_TRANSFORM_IS_SCALE (type)) {
     GstVideoMetaTransform *trans = (GstVideoMetaTransform *) data;
 
-    dmeta->prediction =
-        gst_inference_prediction_scale (smeta->prediction, trans->out_info,
-        trans->in_info);
+    g_mutex_lock (&smeta->lock);
+    meta_replace_prediction (dmeta,
+        gst_inference_prediction_ref (smeta->prediction));
+    /* Consecutive scales collapse into a single one */
+    dmeta->scale_from =
+        smeta->scale_pending ? smeta->scale_from : *trans->in_info;
+    dmeta->scale_to = *trans->out_info;
+    dmeta->scale_pending = TRUE;
+    g_mutex_unlock (&smeta->lock);
     return TRUE;
   }
 
@@ -200,6 +286,8 @@ gst_inference_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
 
   imeta->prediction = root;
   imeta->stream_id = NULL;
+  imeta->scale_pending = FALSE;
+  g_mutex_init (&imeta->lock);
 
   return TRUE;
 }
@@ -215,4 +303,501 @@ gst_inference_meta_free (GstMeta * meta, GstBuffer * buffer)
   imeta = (GstInferenceMeta *) meta;
   gst_inference_prediction_unref (imeta->prediction);
   g_free (imeta->stream_id);
+  g_mutex_clear (&imeta->lock);
+}
+
+GstInferencePrediction *
+gst_inference_meta_get_prediction (GstInferenceMeta * meta)
+{
+  GstInferencePrediction *prediction = NULL;
+
+  g_return_val_if_fail (meta != NULL, NULL);
+
+  g_mutex_lock (&meta->lock);
+
+  if (meta->scale_pending) {
+    prediction = gst_inference_prediction_scale (meta->prediction,
+        &meta->scale_to, &meta->scale_from);
+  } else if (GST_MINI_OBJECT_REFCOUNT_VALUE (meta->prediction) > 1) {
+    prediction = gst_inference_prediction_copy (meta->prediction);
+  }
+
+  if (prediction) {
+    meta_replace_prediction (meta, prediction);
+  } else {
+    prediction = meta->prediction;
+  }
+
+  g_mutex_unlock (&meta->lock);
+
+  return prediction;
+}
+
+GstInferencePrediction *
+gst_inference_meta_ref_prediction (GstInferenceMeta * meta)
+{
+  GstInferencePrediction *prediction = NULL;
+
+  g_return_val_if_fail (meta != NULL, NULL);
+
+  /* Other readers may hold the tree, so it is never swapped here */
+  g_mutex_lock (&meta->lock);
+
+  if (meta->scale_pending) {
+    prediction = gst_inference_prediction_scale (meta->prediction,
+        &meta->scale_to, &meta->scale_from);
+  } else {
+    prediction = gst_inference_prediction_ref (meta->prediction);
+  }
+
+  g_mutex_unlock (&meta->lock);
+
+  return prediction;
+}
+
+void
+gst_inference_meta_set_prediction (GstInferenceMeta * meta,
+    GstInferencePrediction * prediction)
+{
+  g_return_if_fail (meta != NULL);
+  g_return_if_fail (prediction != NULL);
+
+  g_mutex_lock (&meta->lock);
+  meta_replace_prediction (meta, prediction);
+  g_mutex_unlock (&meta->lock);
+}
+
+/* Called with the meta lock */
+static void
+meta_replace_prediction (GstInferenceMeta * meta,
+    GstInferencePrediction * prediction)
+{
+  gst_inference_prediction_unref (meta->prediction);
+  meta->prediction = prediction;
+  meta->scale_pending = FALSE;
+}
+
+static void
+serial_count (GstInferencePrediction * pred, SerialState * state)
+{
+  GstInferenceClassification *c = NULL;
+  GList *iter = NULL;
+  GNode *node = NULL;
+
+  state->num_nodes++;
+
+  for (iter = pred->classifications; iter != NULL; iter = g_list_next (iter)) {
+    c = (GstInferenceClassification *) iter->data;
+    state->num_classes++;
+    state->num_scores += c->num_top;
+    if (c->class_label) {
+      state->strings_size += strlen (c->class_label) + 1;
+    }
+  }
+
+  for (node = g_node_first_child (pred->predictions); node != NULL;
+      node = g_node_next_sibling (node)) {
+    serial_count ((GstInferencePrediction *) node->data, state);
+  }
+}
+
+static guint32
+serial_write_string (SerialState * state, const gchar * str)
+{
+  gsize len;
+  guint32 offset;
+
+  if (NULL == str) {
+    return SERIAL_NONE;
+  }
+
+  len = strlen (str) + 1;
+  offset = state->strings_size;
+  memcpy (state->strings + offset, str, len);
+  state->strings_size += len;
+
+  return offset;
+}
+
+static void
+serial_write (GstInferencePrediction * pred, gint parent, SerialState * state)
+{
+  GstInferenceClassification *c = NULL;
+  GList *iter = NULL;
+  GNode *node = NULL;
+  guint8 *record = NULL;
+  gint index = state->num_nodes;
+  gint i;
+
+  record = state->nodes + index * SERIAL_NODE_SIZE;
+  GST_WRITE_UINT64_LE (record + SERIAL_NODE_ID, pred->prediction_id);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_X, pred->bbox.x);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_Y, pred->bbox.y);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_WIDTH, pred->bbox.width);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_HEIGHT, pred->bbox.height);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_PARENT, parent);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_FIRST_CLASS, state->num_classes);
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_NUM_CLASSES,
+      g_list_length (pred->classifications));
+  GST_WRITE_UINT32_LE (record + SERIAL_NODE_FLAGS,
+      pred->enabled ? SERIAL_ENABLED : 0);
+  state->num_nodes++;
+
+  for (iter = pred->classifications; iter != NULL; iter = g_list_next (iter)) {
+    c = (GstInferenceClassification *) iter->data;
+
+    GST_INFERENCE_CLASSIFICATION_LOCK (c);
+
+    record = state->classes + state->num_classes * SERIAL_CLASS_SIZE;
+    GST_WRITE_UINT64_LE (record + SERIAL_CLASS_ID, c->classification_id);
+    GST_WRITE_DOUBLE_LE (record + SERIAL_CLASS_PROB, c->class_prob);
+    GST_WRITE_UINT32_LE (record + SERIAL_CLASS_CLASS_ID, c->class_id);
+    GST_WRITE_UINT32_LE (record + SERIAL_CLASS_NUM_CLASSES, c->num_classes);
+    GST_WRITE_UINT32_LE (record + SERIAL_CLASS_LABEL,
+        serial_write_string (state, c->class_label));
+    GST_WRITE_UINT32_LE (record + SERIAL_CLASS_FIRST_SCORE, state->num_scores);
+    GST_WRITE_UINT32_LE (record + SERIAL_CLASS_NUM_SCORES, c->num_top);
+    state->num_classes++;
+
+    for (i = 0; i < c->num_top; i++) {
+      record = state->scores + state->num_scores * SERIAL_SCORE_SIZE;
+      GST_WRITE_DOUBLE_LE (record + SERIAL_SCORE_PROB, c->top[i].prob);
+      GST_WRITE_UINT32_LE (record + SERIAL_SCORE_CLASS_ID, c->top[i].class_id);
+      state->num_scores++;
+    }
+
+    GST_INFERENCE_CLASSIFICATION_UNLOCK (c);
+  }
+
+  for (node = g_node_first_child (pred->predictions); node != NULL;
+      node = g_node_next_sibling (node)) {
+    serial_write ((GstInferencePrediction *) node->data, index, state);
+  }
+}
+
+void
+gst_inference_meta_serialize (GstInferenceMeta * meta, GByteArray * array)
+{
+  GstInferencePrediction *root = NULL;
+  SerialState state = { 0 };
+  guint8 *header = NULL;
+  guint offset = 0;
+  gsize size = 0;
+
+  g_return_if_fail (meta != NULL);
+  g_return_if_fail (array != NULL);
+
+  root = gst_inference_meta_ref_prediction (meta);
+
+  GST_INFERENCE_PREDICTION_LOCK (root);
+
+  /* Size everything first, so the records are written in place */
+  serial_count (root, &state);
+  if (meta->stream_id) {
+    state.strings_size += strlen (meta->stream_id) + 1;
+  }
+
+  size = SERIAL_HEADER_SIZE + state.num_nodes * SERIAL_NODE_SIZE +
+      state.num_classes * SERIAL_CLASS_SIZE +
+      state.num_scores * SERIAL_SCORE_SIZE + state.strings_size;
+  offset = array->len;
+  g_byte_array_set_size (array, offset + size);
+
+  header = array->data + offset;
+  memcpy (header, SERIAL_MAGIC, 4);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_VERSION,
+      GST_INFERENCE_META_SERIAL_VERSION);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_HEADER_SIZE, SERIAL_HEADER_SIZE);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_NODE_SIZE, SERIAL_NODE_SIZE);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_CLASS_SIZE, SERIAL_CLASS_SIZE);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_SCORE_SIZE, SERIAL_SCORE_SIZE);
+  GST_WRITE_UINT16_LE (header + SERIAL_HEADER_SCORE_SIZE + 2, 0);
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_SIZE_ALL, size);
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_NUM_NODES, state.num_nodes);
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_NUM_CLASSES, state.num_classes);
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_NUM_SCORES, state.num_scores);
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_STRINGS_SIZE,
+      state.strings_size);
+
+  state.nodes = header + SERIAL_HEADER_SIZE;
+  state.classes = state.nodes + state.num_nodes * SERIAL_NODE_SIZE;
+  state.scores = state.classes + state.num_classes * SERIAL_CLASS_SIZE;
+  state.strings = (gchar *) state.scores + state.num_scores *
+      SERIAL_SCORE_SIZE;
+
+  /* Written again as they are filled */
+  state.num_nodes = 0;
+  state.num_classes = 0;
+  state.num_scores = 0;
+  state.strings_size = 0;
+
+  GST_WRITE_UINT32_LE (header + SERIAL_HEADER_STREAM_ID,
+      serial_write_string (&state, meta->stream_id));
+  serial_write (root, -1, &state);
+
+  GST_INFERENCE_PREDICTION_UNLOCK (root);
+
+  gst_inference_prediction_unref (root);
+}
+
+gsize
+gst_inference_meta_reader_peek_size (const guint8 * data, gsize size)
+{
+  g_return_val_if_fail (data != NULL || 0 == size, 0);
+
+  if (size < SERIAL_HEADER_SIZE_ALL + 4 || memcmp (data, SERIAL_MAGIC, 4)) {
+    return 0;
+  }
+
+  return GST_READ_UINT32_LE (data + SERIAL_HEADER_SIZE_ALL);
+}
+
+gboolean
+gst_inference_meta_reader_init (GstInferenceMetaReader * reader,
+    const guint8 * data, gsize size)
+{
+  guint64 total = 0;
+  guint header_size = 0;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (data != NULL || 0 == size, FALSE);
+
+  memset (reader, 0, sizeof (GstInferenceMetaReader));
+
+  if (size < SERIAL_HEADER_SIZE || memcmp (data, SERIAL_MAGIC, 4)) {
+    GST_WARNING ("Not a serialized inference meta");
+    return FALSE;
+  }
+
+  if (GST_READ_UINT16_LE (data + SERIAL_HEADER_VERSION) !=
+      GST_INFERENCE_META_SERIAL_VERSION) {
+    GST_WARNING ("Unsupported serialized inference meta version %u",
+        GST_READ_UINT16_LE (data + SERIAL_HEADER_VERSION));
+    return FALSE;
+  }
+
+  header_size = GST_READ_UINT16_LE (data + SERIAL_HEADER_HEADER_SIZE);
+  reader->node_size = GST_READ_UINT16_LE (data + SERIAL_HEADER_NODE_SIZE);
+  reader->class_size = GST_READ_UINT16_LE (data + SERIAL_HEADER_CLASS_SIZE);
+  reader->score_size = GST_READ_UINT16_LE (data + SERIAL_HEADER_SCORE_SIZE);
+  reader->num_nodes = GST_READ_UINT32_LE (data + SERIAL_HEADER_NUM_NODES);
+  reader->num_classes = GST_READ_UINT32_LE (data + SERIAL_HEADER_NUM_CLASSES);
+  reader->num_scores = GST_READ_UINT32_LE (data + SERIAL_HEADER_NUM_SCORES);
+  reader->strings_size = GST_READ_UINT32_LE (data + SERIAL_HEADER_STRINGS_SIZE);
+
+  /* Newer writers may only make the records larger */
+  if (header_size < SERIAL_HEADER_SIZE || reader->node_size < SERIAL_NODE_SIZE
+      || reader->class_size < SERIAL_CLASS_SIZE
+      || reader->score_size < SERIAL_SCORE_SIZE || 0 == reader->num_nodes) {
+    GST_WARNING ("Invalid serialized inference meta header");
+    return FALSE;
+  }
+
+  total = (guint64) header_size +
+      (guint64) reader->num_nodes * reader->node_size +
+      (guint64) reader->num_classes * reader->class_size +
+      (guint64) reader->num_scores * reader->score_size + reader->strings_size;
+  if (total > GST_READ_UINT32_LE (data + SERIAL_HEADER_SIZE_ALL)
+      || total > size) {
+    GST_WARNING ("Truncated serialized inference meta");
+    return FALSE;
+  }
+
+  reader->nodes = data + header_size;
+  reader->classes = reader->nodes + reader->num_nodes * reader->node_size;
+  reader->scores = reader->classes + reader->num_classes * reader->class_size;
+  reader->strings = (const gchar *) reader->scores +
+      reader->num_scores * reader->score_size;
+
+  /* Every string ends within the strings */
+  if (reader->strings_size > 0
+      && reader->strings[reader->strings_size - 1] != '\0') {
+    GST_WARNING ("Invalid serialized inference meta strings");
+    return FALSE;
+  }
+
+  reader->stream_id = NULL;
+  if (GST_READ_UINT32_LE (data + SERIAL_HEADER_STREAM_ID) != SERIAL_NONE) {
+    if (GST_READ_UINT32_LE (data + SERIAL_HEADER_STREAM_ID) >=
+        reader->strings_size) {
+      GST_WARNING ("Invalid serialized inference meta stream id");
+      return FALSE;
+    }
+    reader->stream_id = reader->strings +
+        GST_READ_UINT32_LE (data + SERIAL_HEADER_STREAM_ID);
+  }
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_meta_reader_get_node (const GstInferenceMetaReader * reader,
+    guint index, GstInferenceMetaNode * node)
+{
+  const guint8 *record = NULL;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (node != NULL, FALSE);
+
+  if (index >= reader->num_nodes) {
+    return FALSE;
+  }
+
+  record = reader->nodes + index * reader->node_size;
+  node->prediction_id = GST_READ_UINT64_LE (record + SERIAL_NODE_ID);
+  node->enabled = ! !(GST_READ_UINT32_LE (record + SERIAL_NODE_FLAGS) &
+      SERIAL_ENABLED);
+  node->bbox.x = (gint32) GST_READ_UINT32_LE (record + SERIAL_NODE_X);
+  node->bbox.y = (gint32) GST_READ_UINT32_LE (record + SERIAL_NODE_Y);
+  node->bbox.width = GST_READ_UINT32_LE (record + SERIAL_NODE_WIDTH);
+  node->bbox.height = GST_READ_UINT32_LE (record + SERIAL_NODE_HEIGHT);
+  node->parent = (gint32) GST_READ_UINT32_LE (record + SERIAL_NODE_PARENT);
+  node->first_class = GST_READ_UINT32_LE (record + SERIAL_NODE_FIRST_CLASS);
+  node->num_classes = GST_READ_UINT32_LE (record + SERIAL_NODE_NUM_CLASSES);
+
+  /* Parents come first, and only the root has none */
+  if ((0 == index) != (node->parent < 0) || node->parent >= (gint) index
+      || node->first_class > reader->num_classes
+      || node->num_classes > reader->num_classes - node->first_class) {
+    GST_WARNING ("Invalid serialized inference meta node %u", index);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_meta_reader_get_class (const GstInferenceMetaReader * reader,
+    guint index, GstInferenceMetaClass * c)
+{
+  const guint8 *record = NULL;
+  guint32 label;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (c != NULL, FALSE);
+
+  if (index >= reader->num_classes) {
+    return FALSE;
+  }
+
+  record = reader->classes + index * reader->class_size;
+  c->classification_id = GST_READ_UINT64_LE (record + SERIAL_CLASS_ID);
+  c->class_prob = GST_READ_DOUBLE_LE (record + SERIAL_CLASS_PROB);
+  c->class_id = (gint32) GST_READ_UINT32_LE (record + SERIAL_CLASS_CLASS_ID);
+  c->num_classes =
+      (gint32) GST_READ_UINT32_LE (record + SERIAL_CLASS_NUM_CLASSES);
+  c->first_score = GST_READ_UINT32_LE (record + SERIAL_CLASS_FIRST_SCORE);
+  c->num_scores = GST_READ_UINT32_LE (record + SERIAL_CLASS_NUM_SCORES);
+  label = GST_READ_UINT32_LE (record + SERIAL_CLASS_LABEL);
+
+  if ((label != SERIAL_NONE && label >= reader->strings_size)
+      || c->first_score > reader->num_scores
+      || c->num_scores > reader->num_scores - c->first_score) {
+    GST_WARNING ("Invalid serialized inference meta classification %u",
+        index);
+    return FALSE;
+  }
+
+  c->class_label = SERIAL_NONE == label ? NULL : reader->strings + label;
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_meta_reader_get_score (const GstInferenceMetaReader * reader,
+    guint index, GstInferenceClassScore * score)
+{
+  const guint8 *record = NULL;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (score != NULL, FALSE);
+
+  if (index >= reader->num_scores) {
+    return FALSE;
+  }
+
+  record = reader->scores + index * reader->score_size;
+  score->prob = GST_READ_DOUBLE_LE (record + SERIAL_SCORE_PROB);
+  score->class_id =
+      (gint32) GST_READ_UINT32_LE (record + SERIAL_SCORE_CLASS_ID);
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_meta_deserialize (GstInferenceMeta * meta, const guint8 * data,
+    gsize size)
+{
+  GstInferenceMetaReader reader;
+  GstInferenceMetaNode node;
+  GstInferenceMetaClass mclass;
+  GstInferencePrediction **preds = NULL;
+  GstInferencePrediction *pred = NULL;
+  GstInferenceClassification *c = NULL;
+  GstInferenceClassScore *top = NULL;
+  gboolean ret = FALSE;
+  guint i, j, k;
+
+  g_return_val_if_fail (meta != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  if (!gst_inference_meta_reader_init (&reader, data, size)) {
+    return FALSE;
+  }
+
+  preds = g_new0 (GstInferencePrediction *, reader.num_nodes);
+
+  for (i = 0; i < reader.num_nodes; i++) {
+    if (!gst_inference_meta_reader_get_node (&reader, i, &node)) {
+      goto out;
+    }
+
+    pred = gst_inference_prediction_new_full (&node.bbox);
+    pred->prediction_id = node.prediction_id;
+    pred->enabled = node.enabled;
+    preds[i] = pred;
+
+    /* Owned by its parent from now on, the root owns everything */
+    if (node.parent >= 0) {
+      gst_inference_prediction_append (preds[node.parent], pred);
+    }
+
+    for (j = node.first_class; j < node.first_class + node.num_classes; j++) {
+      if (!gst_inference_meta_reader_get_class (&reader, j, &mclass)) {
+        goto out;
+      }
+
+      c = gst_inference_classification_new_full (mclass.class_id,
+          mclass.class_prob, mclass.class_label, mclass.num_classes, NULL,
+          NULL);
+      c->classification_id = mclass.classification_id;
+      gst_inference_prediction_append_classification (pred, c);
+
+      if (mclass.num_scores > 0) {
+        top = g_new (GstInferenceClassScore, mclass.num_scores);
+        for (k = 0; k < mclass.num_scores; k++) {
+          gst_inference_meta_reader_get_score (&reader,
+              mclass.first_score + k, &top[k]);
+        }
+        gst_inference_classification_set_top (c, top, mclass.num_scores);
+        g_free (top);
+      }
+    }
+  }
+
+  g_free (meta->stream_id);
+  meta->stream_id = g_strdup (reader.stream_id);
+
+  gst_inference_meta_set_prediction (meta, gst_inference_prediction_ref
+      (preds[0]));
+
+  ret = TRUE;
+
+out:
+  if (preds[0]) {
+    gst_inference_prediction_unref (preds[0]);
+  }
+  g_free (preds);
+
+  return ret;
 }
@@ -24,6 +24,7 @@
 
 #include <gst/gst.h>
 
+#include <gst/video/video.h>
 #include <gst/r2inference/gstinferenceprediction.h>
 
 G_BEGIN_DECLS
@@ -46,6 +47,12 @@ struct _BBox
 
 /**
  * Implements the placeholder for inference information.
+ *
+ * Copies and scales of the buffer share the prediction tree with the
+ * original, and scaling is only applied when the tree is needed. Use
+ * gst_inference_meta_ref_prediction() to read the tree and
+ * gst_inference_meta_get_prediction() to modify it, instead of reading
+ * prediction directly.
  */
 typedef struct _GstInferenceMeta GstInferenceMeta;
 struct _GstInferenceMeta
@@ -55,11 +62,209 @@ struct _GstInferenceMeta
   GstInferencePrediction *prediction;
 
   gchar *stream_id;
+
+  /*< private >*/
+  GMutex lock;
+  gboolean scale_pending;
+  GstVideoInfo scale_from;
+  GstVideoInfo scale_to;
 };
 
 
 GType gst_inference_meta_api_get_type (void);
 const GstMetaInfo *gst_inference_meta_get_info (void);
 
+/**
+ * \brief Get the prediction tree of the meta, ready to be modified. A
+ * tree still shared with other buffers is copied and a pending scale is
+ * applied first, and the result replaces the tree of the meta. Only
+ * call it on the meta of a writable buffer.
+ *
+ * \param meta The inference meta
+ *
+ * \return The root prediction, owned by the meta
+ */
+GstInferencePrediction *gst_inference_meta_get_prediction (GstInferenceMeta *
+    meta);
+
+/**
+ * \brief Get the prediction tree of the meta to read it. A pending scale
+ * is applied to a copy, the tree of the meta is left as it is, so this
+ * is safe on buffers that are not writable. The tree may be shared and
+ * must not be modified.
+ *
+ * \param meta The inference meta
+ *
+ * \return A reference to the root prediction, unref it after use
+ */
+GstInferencePrediction *gst_inference_meta_ref_prediction (GstInferenceMeta *
+    meta);
+
+/**
+ * \brief Replace the prediction tree of the meta, dropping any pending
+ * scale.
+ *
+ * \param meta The inference meta
+ * \param prediction The new root prediction, the meta takes ownership
+ */
+void gst_inference_meta_set_prediction (GstInferenceMeta * meta,
+    GstInferencePrediction * prediction);
+
+/**
+ * Version of the binary encoding written by gst_inference_meta_serialize().
+ * The layout is little-endian: a header, then the nodes, the
+ * classifications and the top scores as flat arrays of fixed size
+ * records, then the strings. New fields are only appended to the
+ * records, whose sizes are part of the header, so a reader accepts any
+ * record at least as large as the one it knows.
+ */
+#define GST_INFERENCE_META_SERIAL_VERSION 1
+
+/**
+ * MIME type of the buffers holding serialized metas.
+ */
+#define GST_INFERENCE_META_SERIAL_CAPS "application/x-inference-meta"
+
+/**
+ * A serialized prediction. Nodes are stored parents first, the root
+ * being node 0 with no parent.
+ */
+typedef struct _GstInferenceMetaNode GstInferenceMetaNode;
+struct _GstInferenceMetaNode
+{
+  guint64 prediction_id;
+  gboolean enabled;
+  BoundingBox bbox;
+  /* Index of the parent node, -1 for the root */
+  gint parent;
+  guint first_class;
+  guint num_classes;
+};
+
+/**
+ * A serialized classification. The label points into the serialized
+ * data, or is NULL if there is none.
+ */
+typedef struct _GstInferenceMetaClass GstInferenceMetaClass;
+struct _GstInferenceMetaClass
+{
+  guint64 classification_id;
+  gint class_id;
+  gdouble class_prob;
+  const gchar *class_label;
+  gint num_classes;
+  guint first_score;
+  guint num_scores;
+};
+
+/**
+ * Reads serialized metas in place, nothing is copied or allocated.
+ */
+typedef struct _GstInferenceMetaReader GstInferenceMetaReader;
+struct _GstInferenceMetaReader
+{
+  guint num_nodes;
+  guint num_classes;
+  guint num_scores;
+  /* Points into the serialized data, or NULL */
+  const gchar *stream_id;
+
+  /*< private >*/
+  const guint8 *nodes;
+  const guint8 *classes;
+  const guint8 *scores;
+  const gchar *strings;
+  gsize strings_size;
+  guint node_size;
+  guint class_size;
+  guint score_size;
+};
+
+/**
+ * \brief Append the binary encoding of the meta. A tree shared with
+ * other buffers is read in place, without copying it.
+ *
+ * \param meta The inference meta
+ * \param array Where to append the encoding, reusing it between frames
+ * avoids reallocations
+ */
+void gst_inference_meta_serialize (GstInferenceMeta * meta,
+    GByteArray * array);
+
+/**
+ * \brief Replace the prediction tree and stream id of the meta by the
+ * serialized ones. Ids are kept.
+ *
+ * \param meta The inference meta
+ * \param data The serialized meta
+ * \param size The size of data
+ *
+ * \return FALSE if the data is not a valid serialized meta, the meta
+ * is left as it was
+ */
+gboolean gst_inference_meta_deserialize (GstInferenceMeta * meta,
+    const guint8 * data, gsize size);
+
+/**
+ * \brief Validate a serialized meta and prepare to read it. The data
+ * must outlive the reader.
+ *
+ * \param reader The reader to initialize
+ * \param data The serialized meta
+ * \param size The size of data, it may extend past the serialized meta
+ *
+ * \return FALSE if the data is not a valid serialized meta
+ */
+gboolean gst_inference_meta_reader_init (GstInferenceMetaReader * reader,
+    const guint8 * data, gsize size);
+
+/**
+ * \brief Get the size of a serialized meta from its header, to find the
+ * next one in a stream of them
+ *
+ * \param data The serialized meta
+ * \param size The available data
+ *
+ * \return The size of the whole serialized meta, or 0 if there is not
+ * enough data to tell or it is not a serialized meta
+ */
+gsize gst_inference_meta_reader_peek_size (const guint8 * data, gsize size);
+
+/**
+ * \brief Read a node
+ *
+ * \param reader The reader
+ * \param index Index of the node
+ * \param node Where to store the node
+ *
+ * \return FALSE if the index or the node is not valid
+ */
+gboolean gst_inference_meta_reader_get_node (const GstInferenceMetaReader *
+    reader, guint index, GstInferenceMetaNode * node);
+
+/**
+ * \brief Read a classification
+ *
+ * \param reader The reader
+ * \param index Index of the classification
+ * \param c Where to store the classification
+ *
+ * \return FALSE if the index or the classification is not valid
+ */
+gboolean gst_inference_meta_reader_get_class (const GstInferenceMetaReader *
+    reader, guint index, GstInferenceMetaClass * c);
+
+/**
+ * \brief Read one of the top scores of a classification
+ *
+ * \param reader The reader
+ * \param index Index of the score
+ * \param score Where to store the score
+ *
+ * \return FALSE if the index is not valid
+ */
+gboolean gst_inference_meta_reader_get_score (const GstInferenceMetaReader *
+    reader, guint index, GstInferenceClassScore * score);
+
 G_END_DECLS
 #endif // GST_INFERENCE_META_H
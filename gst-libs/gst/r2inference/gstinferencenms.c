@@ -0,0 +1,528 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencenms.h"
+#include "gstinferencepreprocesskernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(GST_INFERENCE_HAVE_X86)
+#include <immintrin.h>
+#elif defined(GST_INFERENCE_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef struct _GstInferenceNmsEntry GstInferenceNmsEntry;
+struct _GstInferenceNmsEntry
+{
+  gdouble score;
+  gint label;
+  guint index;
+};
+
+/* The candidates are kept as a structure of arrays in processing order,
+ * so the overlap of one box against all the others vectorizes */
+struct _GstInferenceNms
+{
+  guint capacity;
+  gfloat *x1;
+  gfloat *y1;
+  gfloat *x2;
+  gfloat *y2;
+  gfloat *area;
+  gdouble *score;
+  guint *index;
+  gfloat *iou;
+  guint *kept;
+  GstInferenceNmsEntry *entries;
+};
+
+/* Compute the IoU of the pivot box against the boxes in [start, end) */
+typedef void (*GstInferenceNmsIouFunc) (GstInferenceNms * nms, guint pivot,
+    guint start, guint end);
+
+static void gst_inference_nms_reserve (GstInferenceNms * nms, guint size);
+static void gst_inference_nms_move (GstInferenceNms * nms, guint from,
+    guint to);
+static void gst_inference_nms_swap (GstInferenceNms * nms, guint a, guint b);
+static gint gst_inference_nms_compare_score (const void *a, const void *b);
+static gint gst_inference_nms_compare_class (const void *a, const void *b);
+static guint gst_inference_nms_hard (GstInferenceNms * nms,
+    GstInferenceNmsIouFunc iou_func, const GstInferenceNmsParams * params,
+    guint start, guint end, guint * kept);
+static guint gst_inference_nms_soft (GstInferenceNms * nms,
+    GstInferenceNmsIouFunc iou_func, const GstInferenceNmsParams * params,
+    guint start, guint end, guint * kept);
+static void gst_inference_nms_iou_c (GstInferenceNms * nms, guint pivot,
+    guint start, guint end);
+static GstInferenceNmsIouFunc gst_inference_nms_get_iou_func (void);
+
+static GPrivate gst_inference_nms_private =
+G_PRIVATE_INIT ((GDestroyNotify) gst_inference_nms_free);
+
+static void
+gst_inference_nms_iou_c (GstInferenceNms * nms, guint pivot, guint start,
+    guint end)
+{
+  gfloat px1 = nms->x1[pivot];
+  gfloat py1 = nms->y1[pivot];
+  gfloat px2 = nms->x2[pivot];
+  gfloat py2 = nms->y2[pivot];
+  gfloat parea = nms->area[pivot];
+  gfloat width, height, inter;
+  guint j;
+
+  for (j = start; j < end; ++j) {
+    width = MIN (px2, nms->x2[j]) - MAX (px1, nms->x1[j]);
+    height = MIN (py2, nms->y2[j]) - MAX (py1, nms->y1[j]);
+    inter = MAX (width, 0.0f) * MAX (height, 0.0f);
+    nms->iou[j] = inter / (parea + nms->area[j] - inter);
+  }
+}
+
+#if defined(GST_INFERENCE_HAVE_X86)
+
+static void gst_inference_nms_iou_sse41 (GstInferenceNms * nms, guint pivot,
+    guint start, guint end);
+static void gst_inference_nms_iou_avx2 (GstInferenceNms * nms, guint pivot,
+    guint start, guint end);
+
+GST_INFERENCE_TARGET ("sse4.1")
+static void
+gst_inference_nms_iou_sse41 (GstInferenceNms * nms, guint pivot, guint start,
+    guint end)
+{
+  __m128 px1 = _mm_set1_ps (nms->x1[pivot]);
+  __m128 py1 = _mm_set1_ps (nms->y1[pivot]);
+  __m128 px2 = _mm_set1_ps (nms->x2[pivot]);
+  __m128 py2 = _mm_set1_ps (nms->y2[pivot]);
+  __m128 parea = _mm_set1_ps (nms->area[pivot]);
+  __m128 zero = _mm_setzero_ps ();
+  __m128 width, height, inter, uni;
+  guint j = start;
+
+  for (; j + 4 <= end; j += 4) {
+    width = _mm_sub_ps (_mm_min_ps (px2, _mm_loadu_ps (nms->x2 + j)),
+        _mm_max_ps (px1, _mm_loadu_ps (nms->x1 + j)));
+    height = _mm_sub_ps (_mm_min_ps (py2, _mm_loadu_ps (nms->y2 + j)),
+        _mm_max_ps (py1, _mm_loadu_ps (nms->y1 + j)));
+    inter = _mm_mul_ps (_mm_max_ps (width, zero), _mm_max_ps (height, zero));
+    uni = _mm_sub_ps (_mm_add_ps (parea, _mm_loadu_ps (nms->area + j)), inter);
+    _mm_storeu_ps (nms->iou + j, _mm_div_ps (inter, uni));
+  }
+
+  gst_inference_nms_iou_c (nms, pivot, j, end);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static void
+gst_inference_nms_iou_avx2 (GstInferenceNms * nms, guint pivot, guint start,
+    guint end)
+{
+  __m256 px1 = _mm256_set1_ps (nms->x1[pivot]);
+  __m256 py1 = _mm256_set1_ps (nms->y1[pivot]);
+  __m256 px2 = _mm256_set1_ps (nms->x2[pivot]);
+  __m256 py2 = _mm256_set1_ps (nms->y2[pivot]);
+  __m256 parea = _mm256_set1_ps (nms->area[pivot]);
+  __m256 zero = _mm256_setzero_ps ();
+  __m256 width, height, inter, uni;
+  guint j = start;
+
+  for (; j + 8 <= end; j += 8) {
+    width = _mm256_sub_ps (_mm256_min_ps (px2, _mm256_loadu_ps (nms->x2 + j)),
+        _mm256_max_ps (px1, _mm256_loadu_ps (nms->x1 + j)));
+    height = _mm256_sub_ps (_mm256_min_ps (py2, _mm256_loadu_ps (nms->y2 + j)),
+        _mm256_max_ps (py1, _mm256_loadu_ps (nms->y1 + j)));
+    inter = _mm256_mul_ps (_mm256_max_ps (width, zero),
+        _mm256_max_ps (height, zero));
+    uni = _mm256_sub_ps (_mm256_add_ps (parea,
+            _mm256_loadu_ps (nms->area + j)), inter);
+    _mm256_storeu_ps (nms->iou + j, _mm256_div_ps (inter, uni));
+  }
+
+  gst_inference_nms_iou_c (nms, pivot, j, end);
+}
+
+#elif defined(GST_INFERENCE_HAVE_NEON)
+
+static void gst_inference_nms_iou_neon (GstInferenceNms * nms, guint pivot,
+    guint start, guint end);
+
+static void
+gst_inference_nms_iou_neon (GstInferenceNms * nms, guint pivot, guint start,
+    guint end)
+{
+  float32x4_t px1 = vdupq_n_f32 (nms->x1[pivot]);
+  float32x4_t py1 = vdupq_n_f32 (nms->y1[pivot]);
+  float32x4_t px2 = vdupq_n_f32 (nms->x2[pivot]);
+  float32x4_t py2 = vdupq_n_f32 (nms->y2[pivot]);
+  float32x4_t parea = vdupq_n_f32 (nms->area[pivot]);
+  float32x4_t zero = vdupq_n_f32 (0.0f);
+  float32x4_t width, height, inter, uni;
+  guint j = start;
+
+  for (; j + 4 <= end; j += 4) {
+    width = vsubq_f32 (vminq_f32 (px2, vld1q_f32 (nms->x2 + j)),
+        vmaxq_f32 (px1, vld1q_f32 (nms->x1 + j)));
+    height = vsubq_f32 (vminq_f32 (py2, vld1q_f32 (nms->y2 + j)),
+        vmaxq_f32 (py1, vld1q_f32 (nms->y1 + j)));
+    inter = vmulq_f32 (vmaxq_f32 (width, zero), vmaxq_f32 (height, zero));
+    uni = vsubq_f32 (vaddq_f32 (parea, vld1q_f32 (nms->area + j)), inter);
+    vst1q_f32 (nms->iou + j, vdivq_f32 (inter, uni));
+  }
+
+  gst_inference_nms_iou_c (nms, pivot, j, end);
+}
+
+#endif
+
+static GstInferenceNmsIouFunc
+gst_inference_nms_get_iou_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceNmsIouFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_nms_iou_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    if (gst_inference_kernel_supported (GST_INFERENCE_KERNEL_AVX2)) {
+      func = gst_inference_nms_iou_avx2;
+    } else if (gst_inference_kernel_supported (GST_INFERENCE_KERNEL_SSE41)) {
+      func = gst_inference_nms_iou_sse41;
+    }
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    func = gst_inference_nms_iou_neon;
+#endif
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+void
+gst_inference_nms_params_init (GstInferenceNmsParams * params,
+    gdouble iou_thresh)
+{
+  g_return_if_fail (params);
+
+  params->method = GST_INFERENCE_NMS_HARD;
+  params->iou_thresh = iou_thresh;
+  params->score_thresh = 0;
+  params->sigma = 0.5;
+  params->per_class = TRUE;
+  params->top_k = 0;
+}
+
+GstInferenceNms *
+gst_inference_nms_new (void)
+{
+  return g_slice_new0 (GstInferenceNms);
+}
+
+void
+gst_inference_nms_free (GstInferenceNms * nms)
+{
+  g_return_if_fail (nms);
+
+  g_free (nms->x1);
+  g_free (nms->y1);
+  g_free (nms->x2);
+  g_free (nms->y2);
+  g_free (nms->area);
+  g_free (nms->score);
+  g_free (nms->index);
+  g_free (nms->iou);
+  g_free (nms->kept);
+  g_free (nms->entries);
+  g_slice_free (GstInferenceNms, nms);
+}
+
+static void
+gst_inference_nms_reserve (GstInferenceNms * nms, guint size)
+{
+  guint capacity = MAX (nms->capacity, 64);
+
+  if (size <= nms->capacity) {
+    return;
+  }
+
+  while (capacity < size) {
+    capacity *= 2;
+  }
+
+  nms->x1 = g_renew (gfloat, nms->x1, capacity);
+  nms->y1 = g_renew (gfloat, nms->y1, capacity);
+  nms->x2 = g_renew (gfloat, nms->x2, capacity);
+  nms->y2 = g_renew (gfloat, nms->y2, capacity);
+  nms->area = g_renew (gfloat, nms->area, capacity);
+  nms->score = g_renew (gdouble, nms->score, capacity);
+  nms->index = g_renew (guint, nms->index, capacity);
+  nms->iou = g_renew (gfloat, nms->iou, capacity);
+  nms->kept = g_renew (guint, nms->kept, capacity);
+  nms->entries = g_renew (GstInferenceNmsEntry, nms->entries, capacity);
+  nms->capacity = capacity;
+}
+
+static void
+gst_inference_nms_move (GstInferenceNms * nms, guint from, guint to)
+{
+  nms->x1[to] = nms->x1[from];
+  nms->y1[to] = nms->y1[from];
+  nms->x2[to] = nms->x2[from];
+  nms->y2[to] = nms->y2[from];
+  nms->area[to] = nms->area[from];
+  nms->score[to] = nms->score[from];
+  nms->index[to] = nms->index[from];
+}
+
+static void
+gst_inference_nms_swap (GstInferenceNms * nms, guint a, guint b)
+{
+  /* The kept list is scratch space outside the processed range */
+  guint tmp = nms->capacity - 1;
+
+  gst_inference_nms_move (nms, a, tmp);
+  gst_inference_nms_move (nms, b, a);
+  gst_inference_nms_move (nms, tmp, b);
+}
+
+static gint
+gst_inference_nms_compare_score (const void *a, const void *b)
+{
+  const GstInferenceNmsEntry *ea = (const GstInferenceNmsEntry *) a;
+  const GstInferenceNmsEntry *eb = (const GstInferenceNmsEntry *) b;
+
+  /* Higher score first, ties keep the input order */
+  if (ea->score != eb->score) {
+    return ea->score > eb->score ? -1 : 1;
+  }
+
+  return ea->index < eb->index ? -1 : (ea->index > eb->index);
+}
+
+static gint
+gst_inference_nms_compare_class (const void *a, const void *b)
+{
+  const GstInferenceNmsEntry *ea = (const GstInferenceNmsEntry *) a;
+  const GstInferenceNmsEntry *eb = (const GstInferenceNmsEntry *) b;
+
+  if (ea->label != eb->label) {
+    return ea->label < eb->label ? -1 : 1;
+  }
+
+  return gst_inference_nms_compare_score (a, b);
+}
+
+static guint
+gst_inference_nms_hard (GstInferenceNms * nms, GstInferenceNmsIouFunc iou_func,
+    const GstInferenceNmsParams * params, guint start, guint end,
+    guint * kept)
+{
+  gfloat iou_thresh = params->iou_thresh;
+  guint num_kept = 0;
+  guint i, j, last;
+
+  /* The range is sorted by score, so the first survivor is always kept.
+   * Survivors are compacted after every pivot, which keeps the work
+   * proportional to the boxes still alive. Kept boxes are reported by
+   * position, compaction never moves anything below the pivot */
+  for (i = start; i < end; ++i) {
+    kept[num_kept++] = i;
+    if (params->top_k > 0 && num_kept == params->top_k && !params->per_class) {
+      break;
+    }
+
+    iou_func (nms, i, i + 1, end);
+
+    last = i + 1;
+    for (j = i + 1; j < end; ++j) {
+      if (!(nms->iou[j] > iou_thresh)) {
+        gst_inference_nms_move (nms, j, last++);
+      }
+    }
+    end = last;
+  }
+
+  return num_kept;
+}
+
+static guint
+gst_inference_nms_soft (GstInferenceNms * nms, GstInferenceNmsIouFunc iou_func,
+    const GstInferenceNmsParams * params, guint start, guint end,
+    guint * kept)
+{
+  gfloat iou_thresh = params->iou_thresh;
+  gdouble score_thresh = params->score_thresh;
+  gdouble sigma = MAX (params->sigma, 1e-6);
+  gfloat iou;
+  guint num_kept = 0;
+  guint i, j, best;
+
+  for (i = start; i < end; ++i) {
+    /* Decays change the order, look for the best remaining box */
+    best = i;
+    for (j = i + 1; j < end; ++j) {
+      if (nms->score[j] > nms->score[best]) {
+        best = j;
+      }
+    }
+    if (best != i) {
+      gst_inference_nms_swap (nms, i, best);
+    }
+
+    kept[num_kept++] = i;
+
+    iou_func (nms, i, i + 1, end);
+
+    j = i + 1;
+    while (j < end) {
+      iou = nms->iou[j];
+      if (iou > 0) {
+        if (GST_INFERENCE_NMS_SOFT_GAUSSIAN == params->method) {
+          nms->score[j] *= exp (-(iou * iou) / sigma);
+        } else if (iou > iou_thresh) {
+          nms->score[j] *= 1.0 - iou;
+        }
+      }
+
+      /* Drop the boxes that decayed too much */
+      if (nms->score[j] < score_thresh) {
+        end--;
+        gst_inference_nms_move (nms, end, j);
+        nms->iou[j] = nms->iou[end];
+      } else {
+        j++;
+      }
+    }
+  }
+
+  return num_kept;
+}
+
+guint
+gst_inference_nms_run (GstInferenceNms * nms,
+    const GstInferenceNmsParams * params, BBox * boxes, guint num_boxes,
+    guint * keep)
+{
+  GstInferenceNmsIouFunc iou_func = gst_inference_nms_get_iou_func ();
+  GstInferenceNmsEntry *entry = NULL;
+  BBox *box = NULL;
+  guint num_candidates = 0;
+  guint num_kept = 0;
+  guint start, end, i;
+  gboolean soft;
+
+  g_return_val_if_fail (params, 0);
+  g_return_val_if_fail (boxes || 0 == num_boxes, 0);
+  g_return_val_if_fail (keep || 0 == num_boxes, 0);
+
+  if (0 == num_boxes) {
+    return 0;
+  }
+
+  if (NULL == nms) {
+    nms = g_private_get (&gst_inference_nms_private);
+    if (NULL == nms) {
+      nms = gst_inference_nms_new ();
+      g_private_set (&gst_inference_nms_private, nms);
+    }
+  }
+
+  /* One extra slot for the swaps */
+  gst_inference_nms_reserve (nms, num_boxes + 1);
+  soft = GST_INFERENCE_NMS_HARD != params->method;
+
+  for (i = 0; i < num_boxes; ++i) {
+    if (boxes[i].prob < params->score_thresh) {
+      continue;
+    }
+    entry = &nms->entries[num_candidates++];
+    entry->score = boxes[i].prob;
+    entry->label = boxes[i].label;
+    entry->index = i;
+  }
+
+  qsort (nms->entries, num_candidates, sizeof (GstInferenceNmsEntry),
+      params->per_class ? gst_inference_nms_compare_class :
+      gst_inference_nms_compare_score);
+
+  for (i = 0; i < num_candidates; ++i) {
+    box = &boxes[nms->entries[i].index];
+    nms->x1[i] = box->x;
+    nms->y1[i] = box->y;
+    nms->x2[i] = box->x + box->width;
+    nms->y2[i] = box->y + box->height;
+    nms->area[i] = box->width * box->height;
+    nms->score[i] = box->prob;
+    nms->index[i] = nms->entries[i].index;
+  }
+
+  /* Classes are contiguous after sorting, suppress each one on its own */
+  for (start = 0; start < num_candidates; start = end) {
+    end = num_candidates;
+    if (params->per_class) {
+      for (end = start + 1; end < num_candidates; ++end) {
+        if (nms->entries[end].label != nms->entries[start].label) {
+          break;
+        }
+      }
+    }
+
+    if (soft) {
+      num_kept += gst_inference_nms_soft (nms, iou_func, params, start, end,
+          nms->kept + num_kept);
+    } else {
+      num_kept += gst_inference_nms_hard (nms, iou_func, params, start, end,
+          nms->kept + num_kept);
+    }
+  }
+
+  /* Go back to the input indices, with the decayed scores if any */
+  for (i = 0; i < num_kept; ++i) {
+    if (soft) {
+      boxes[nms->index[nms->kept[i]]].prob = nms->score[nms->kept[i]];
+    }
+    nms->kept[i] = nms->index[nms->kept[i]];
+  }
+
+  /* Merge the classes back in score order */
+  if (params->per_class || soft) {
+    for (i = 0; i < num_kept; ++i) {
+      nms->entries[i].score = boxes[nms->kept[i]].prob;
+      nms->entries[i].index = nms->kept[i];
+    }
+    qsort (nms->entries, num_kept, sizeof (GstInferenceNmsEntry),
+        gst_inference_nms_compare_score);
+    for (i = 0; i < num_kept; ++i) {
+      nms->kept[i] = nms->entries[i].index;
+    }
+  }
+
+  if (params->top_k > 0) {
+    num_kept = MIN (num_kept, params->top_k);
+  }
+
+  memcpy (keep, nms->kept, num_kept * sizeof (guint));
+
+  return num_kept;
+}
@@ -0,0 +1,104 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_NMS_H__
+#define __GST_INFERENCE_NMS_H__
+
+#include <gst/r2inference/gstinferencemeta.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_INFERENCE_NMS_HARD,
+  GST_INFERENCE_NMS_SOFT_LINEAR,
+  GST_INFERENCE_NMS_SOFT_GAUSSIAN,
+} GstInferenceNmsMethod;
+
+/**
+ * GstInferenceNmsParams:
+ * @method: Drop the overlapping boxes, or decay their score (soft-NMS)
+ * @iou_thresh: Overlap above which a box is suppressed, or decayed by the
+ *   linear soft-NMS
+ * @score_thresh: Boxes with a lower score are dropped, before and after
+ *   any soft-NMS decay
+ * @sigma: Spread of the gaussian soft-NMS decay
+ * @per_class: Only let boxes with the same label suppress each other
+ * @top_k: Maximum number of boxes to keep, 0 for no limit
+ */
+typedef struct _GstInferenceNmsParams GstInferenceNmsParams;
+struct _GstInferenceNmsParams
+{
+  GstInferenceNmsMethod method;
+  gdouble iou_thresh;
+  gdouble score_thresh;
+  gdouble sigma;
+  gboolean per_class;
+  guint top_k;
+};
+
+/* Reusable scratch memory for the suppression, not thread safe */
+typedef struct _GstInferenceNms GstInferenceNms;
+
+/**
+ * \brief Fill the parameters for a per class hard NMS without score
+ * threshold nor box limit
+ *
+ * \param params The parameters to initialize
+ * \param iou_thresh Threshold of iou to consider that a box is duplicated
+ */
+void gst_inference_nms_params_init (GstInferenceNmsParams * params,
+    gdouble iou_thresh);
+
+/**
+ * \brief Create a new NMS engine. Its scratch memory grows with the
+ * largest set of boxes seen and is reused across runs.
+ */
+GstInferenceNms *gst_inference_nms_new (void);
+
+/**
+ * \brief Free a NMS engine
+ *
+ * \param nms The engine to free
+ */
+void gst_inference_nms_free (GstInferenceNms * nms);
+
+/**
+ * \brief Run greedy non-maximum suppression over a set of boxes
+ *
+ * \param nms The engine to run, or NULL to use one owned by the calling
+ * thread
+ * \param params The suppression parameters
+ * \param boxes The candidate boxes. Soft-NMS updates the prob of the
+ * boxes it keeps with their decayed score
+ * \param num_boxes The number of candidate boxes
+ * \param keep Return location for the index of every kept box in
+ * descending score order, must have room for num_boxes entries
+ *
+ * \return The number of kept boxes
+ */
+guint gst_inference_nms_run (GstInferenceNms * nms,
+    const GstInferenceNmsParams * params, BBox * boxes, guint num_boxes,
+    guint * keep);
+
+G_END_DECLS
+
+#endif //__GST_INFERENCE_NMS_H__
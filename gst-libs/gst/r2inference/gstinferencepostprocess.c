@@ -21,192 +21,242 @@
 
 #define _USE_MATH_DEFINES
 #include "gstinferencepostprocess.h"
+#include "gstinferencepostprocesskernels.h"
 #include <string.h>
 #include <math.h>
 
-#define TOTAL_BOXES_5 845
-#define TOTAL_BOXES_15 2535
+#define TINYYOLOV2_STRIDE 32
+#define TINYYOLOV2_INPUT_SIZE 416
 
 /* Functions declaration*/
 
-static gdouble gst_intersection_over_union (BBox box_1, BBox box_2);
-static void gst_delete_box (BBox * boxes, gint * num_boxes, gint index);
-static void gst_box_to_pixels (BBox * normalized_box, gint row, gint col,
-    gint box);
-static gdouble gst_sigmoid (gdouble x);
-static void gst_get_boxes_from_prediction (gfloat obj_thresh,
-    gfloat prob_thresh, gpointer prediction, BBox * boxes, gint * elements,
-    gint grid_h, gint grid_w, gint boxes_size, gdouble ** probabilities,
-    gint num_classes);
-static void gst_get_boxes_from_prediction_float (gfloat obj_thresh,
-    gfloat prob_thresh, gpointer prediction, BBox * boxes, gint * elements,
-    gint total_boxes, gdouble ** probabilities, gint num_classes);
-
-static gdouble
-gst_intersection_over_union (BBox box_1, BBox box_2)
+static gfloat gst_float_threshold (gdouble threshold);
+static gboolean gst_score_box (const gfloat * box, gfloat prob_thresh,
+    gint num_classes, BBox * result);
+static gint gst_get_boxes_from_grid (const GstInferenceDecoderParams * params,
+    gdouble obj_thresh, gdouble prob_thresh, const gfloat * prediction,
+    GstInferenceDecodeArena * arena);
+static void gst_grid_boxes_to_pixels (const GstInferenceDecoderParams *
+    params, GstInferenceDecodeArena * arena);
+static gint gst_get_boxes_from_corners (gdouble obj_thresh,
+    gdouble prob_thresh, const gfloat * prediction,
+    GstInferenceDecodeArena * arena, gint total_boxes, gint num_classes);
+static gboolean gst_inference_decode_arena_reserve (GstInferenceDecodeArena *
+    arena, gint capacity, gint num_classes);
+static void gst_inference_decode_arena_suppress (GstInferenceDecodeArena *
+    arena, gdouble iou_thresh);
+static gboolean gst_inference_decode_arena_copy_out (GstInferenceDecodeArena *
+    arena, BBox ** resulting_boxes, gint * elements, gdouble ** probabilities);
+static GstInferenceClassification *gst_create_classification (GstVideoInference
+    * vi, gint class_id, gdouble class_prob, gint num_classes,
+    const gdouble * probabilities, gchar ** labels_list, gint num_labels);
+
+void
+gst_remove_duplicated_boxes (gdouble iou_thresh, BBox * boxes, gint * num_boxes)
 {
-  /*
-   * Evaluate the intersection-over-union for two boxes
-   * The intersection-over-union metric determines how close
-   * two boxes are to being the same box.
-   */
-  gdouble intersection_dim_1;
-  gdouble intersection_dim_2;
-  gdouble intersection_area;
-  gdouble union_area;
-
-  /* First diminsion of the intersecting box */
-  intersection_dim_1 =
-      MIN (box_1.x + box_1.width, box_2.x + box_2.width) - MAX (box_1.x,
-      box_2.x);
-
-  /* Second dimension of the intersecting box */
-  intersection_dim_2 =
-      MIN (box_1.y + box_1.height, box_2.y + box_2.height) - MAX (box_1.y,
-      box_2.y);
-
-  if ((intersection_dim_1 < 0) || (intersection_dim_2 < 0)) {
-    intersection_area = 0;
-  } else {
-    intersection_area = intersection_dim_1 * intersection_dim_2;
-  }
-  union_area = box_1.width * box_1.height + box_2.width * box_2.height -
-      intersection_area;
-  return intersection_area / union_area;
+  GstInferenceNmsParams params;
+
+  gst_inference_nms_params_init (&params, iou_thresh);
+  gst_remove_duplicated_boxes_full (&params, boxes, NULL, num_boxes);
 }
 
-static void
-gst_delete_box (BBox * boxes, gint * num_boxes, gint index)
+void
+gst_remove_duplicated_boxes_full (const GstInferenceNmsParams * params,
+    BBox * boxes, gdouble ** probabilities, gint * num_boxes)
 {
-  gint i, last_index;
-
+  guint *keep = NULL;
+  BBox *kept_boxes = NULL;
+  gdouble **sorted_probs = NULL;
+  gboolean *kept = NULL;
+  guint num_kept = 0;
+  gint i, j;
+
+  g_return_if_fail (params != NULL);
   g_return_if_fail (boxes != NULL);
   g_return_if_fail (num_boxes != NULL);
 
-  if (*num_boxes > 0 && index < *num_boxes && index > -1) {
-    last_index = *num_boxes - 1;
-    for (i = index; i < last_index; i++) {
-      boxes[i] = boxes[i + 1];
-    }
-    *num_boxes -= 1;
+  if (*num_boxes <= 0) {
+    return;
   }
-}
 
-void
-gst_remove_duplicated_boxes (gdouble iou_thresh, BBox * boxes, gint * num_boxes)
-{
-  /* Remove duplicated boxes. A box is considered a duplicate if its
-   * intersection over union metric is above a threshold
-   */
-  gdouble iou;
-  gint it1, it2;
+  keep = g_new (guint, *num_boxes);
+  num_kept = gst_inference_nms_run (NULL, params, boxes, *num_boxes, keep);
 
-  g_return_if_fail (boxes != NULL);
-  g_return_if_fail (num_boxes != NULL);
+  kept_boxes = g_new (BBox, MAX (num_kept, 1));
+  for (i = 0; i < (gint) num_kept; i++) {
+    kept_boxes[i] = boxes[keep[i]];
+  }
 
-  for (it1 = 0; it1 < *num_boxes - 1; it1++) {
-    for (it2 = it1 + 1; it2 < *num_boxes; it2++) {
-      if (boxes[it1].label == boxes[it2].label) {
-        iou = gst_intersection_over_union (boxes[it1], boxes[it2]);
-        if (iou > iou_thresh) {
-          if (boxes[it1].prob > boxes[it2].prob) {
-            gst_delete_box (boxes, num_boxes, it2);
-            it2--;
-          } else {
-            gst_delete_box (boxes, num_boxes, it1);
-            it1--;
-            break;
-          }
-        }
+  /* Keep the probabilities next to their box, and move the ones of the
+   * dropped boxes behind so the caller can still release them */
+  if (probabilities) {
+    sorted_probs = g_new (gdouble *, *num_boxes);
+    kept = g_new0 (gboolean, *num_boxes);
+    for (i = 0; i < (gint) num_kept; i++) {
+      sorted_probs[i] = probabilities[keep[i]];
+      kept[keep[i]] = TRUE;
+    }
+    for (i = 0, j = num_kept; i < *num_boxes; i++) {
+      if (!kept[i]) {
+        sorted_probs[j++] = probabilities[i];
       }
     }
+    memcpy (probabilities, sorted_probs, *num_boxes * sizeof (gdouble *));
+    g_free (sorted_probs);
+    g_free (kept);
   }
+
+  memcpy (boxes, kept_boxes, num_kept * sizeof (BBox));
+  *num_boxes = num_kept;
+
+  g_free (kept_boxes);
+  g_free (keep);
 }
 
-/* sigmoid approximation as a lineal function */
-static gdouble
-gst_sigmoid (gdouble x)
+static gfloat
+gst_float_threshold (gdouble threshold)
 {
-  return 1.0 / (1.0 + pow (M_E, -1.0 * x));
+  gfloat value = threshold;
+
+  /* The largest float not above the threshold, so comparing a float
+   * against either gives the same answer */
+  if (value > threshold) {
+    value = nextafterf (value, -INFINITY);
+  }
+
+  return value;
 }
 
-static void
-gst_box_to_pixels (BBox * normalized_box, gint row, gint col, gint box)
+static gboolean
+gst_score_box (const gfloat * box, gfloat prob_thresh, gint num_classes,
+    BBox * result)
 {
-  gint grid_size = 32;
-  const gdouble box_anchors[] =
-      { 1.08, 1.19, 3.42, 4.41, 6.63, 11.38, 9.42, 5.11, 16.62, 10.52 };
+  GstInferenceArgmaxFunc argmax = NULL;
+  gfloat max_class_prob = 0;
+  gint max_class_prob_index = 0;
 
-  g_return_if_fail (normalized_box != NULL);
+  argmax = gst_inference_argmax_get_func ();
+  max_class_prob_index = argmax (box + 5, num_classes, &max_class_prob);
 
-  /* adjust the box center according to its cell and grid dim */
-  normalized_box->x = (col + gst_sigmoid (normalized_box->x)) * grid_size;
-  normalized_box->y = (row + gst_sigmoid (normalized_box->y)) * grid_size;
+  /* A box with no class above zero is class 0 with no probability */
+  if (max_class_prob_index < 0 || max_class_prob <= 0) {
+    max_class_prob = 0;
+    max_class_prob_index = 0;
+  }
 
-  /* adjust the lengths and widths */
-  normalized_box->width =
-      pow (M_E, normalized_box->width) * box_anchors[2 * box] * grid_size;
-  normalized_box->height =
-      pow (M_E, normalized_box->height) * box_anchors[2 * box + 1] * grid_size;
+  if (!(max_class_prob > prob_thresh)) {
+    return FALSE;
+  }
+
+  result->label = max_class_prob_index;
+  result->prob = max_class_prob;
+
+  return TRUE;
 }
 
-static void
-gst_get_boxes_from_prediction (gfloat obj_thresh, gfloat prob_thresh,
-    gpointer prediction, BBox * boxes, gint * elements, gint grid_h,
-    gint grid_w, gint boxes_size, gdouble ** probabilities, gint num_classes)
+static gint
+gst_get_boxes_from_grid (const GstInferenceDecoderParams * params,
+    gdouble obj_thresh, gdouble prob_thresh, const gfloat * prediction,
+    GstInferenceDecodeArena * arena)
 {
-  gint i, j, c, b;
-  gint index;
-  gdouble obj_prob;
-  gdouble cur_class_prob, max_class_prob;
-  gint max_class_prob_index;
+  GstInferenceCompactAboveFunc compact = NULL;
+  const GstInferenceAnchorLevel *level = NULL;
+  const gfloat *box = NULL;
+  gint i, j, b, k, cell;
+  guint l;
   gint counter = 0;
-  gint box_dim = 5;
-
-  g_return_if_fail (boxes != NULL);
-  g_return_if_fail (elements != NULL);
-  g_return_if_fail (probabilities != NULL);
-
-  /* Iterate rows */
-  for (i = 0; i < grid_h; i++) {
-    /* Iterate colums */
-    for (j = 0; j < grid_w; j++) {
-      /* Iterate boxes */
-      for (b = 0; b < boxes_size; b++) {
-        index = ((i * grid_w + j) * boxes_size + b) * (box_dim + num_classes);
-        obj_prob = ((gfloat *) prediction)[index + 4];
-        /* If the Objectness score is over the threshold add it to the boxes list */
-        if (obj_prob > obj_thresh) {
-          double *actual_probs = g_malloc (num_classes * sizeof (gdouble));
-          max_class_prob = 0;
-          max_class_prob_index = 0;
-          for (c = 0; c < num_classes; c++) {
-            cur_class_prob = ((gfloat *) prediction)[index + box_dim + c];
-            actual_probs[c] = cur_class_prob;
-            if (cur_class_prob > max_class_prob) {
-              max_class_prob = cur_class_prob;
-              max_class_prob_index = c;
-            }
-          }
-          if (max_class_prob > prob_thresh) {
-            BBox result;
-            result.label = max_class_prob_index;
-            result.prob = max_class_prob;
-            result.x = ((gfloat *) prediction)[index];
-            result.y = ((gfloat *) prediction)[index + 1];
-            result.width = ((gfloat *) prediction)[index + 2];
-            result.height = ((gfloat *) prediction)[index + 3];
-            gst_box_to_pixels (&result, i, j, b);
-            result.x = result.x - result.width * 0.5;
-            result.y = result.y - result.height * 0.5;
-            boxes[counter] = result;
-            counter = counter + 1;
-            probabilities[counter - 1] = actual_probs;
-          }
-        }
+  gint num_candidates, level_boxes;
+  gint num_classes = params->num_classes;
+  gint box_size = 5 + num_classes;
+  gfloat obj_limit = gst_float_threshold (obj_thresh);
+  gfloat prob_limit = gst_float_threshold (prob_thresh);
+  gfloat *transform = NULL;
+  BBox result;
+
+  g_return_val_if_fail (prediction != NULL, 0);
+  g_return_val_if_fail (arena != NULL, 0);
+
+  compact = gst_inference_compact_above_get_func ();
+
+  for (l = 0; l < params->num_levels; l++) {
+    level = &params->levels[l];
+    level_boxes = (params->input_height / level->stride) *
+        (params->input_width / level->stride) * level->num_anchors;
+
+    /* Most boxes have no object, only score the ones that do */
+    num_candidates = compact (prediction + 4, box_size, level_boxes,
+        obj_limit, arena->candidates);
+
+    for (k = 0; k < num_candidates; k++) {
+      box = prediction + arena->candidates[k] * box_size;
+      if (!gst_score_box (box, prob_limit, num_classes, &result)) {
+        continue;
       }
+
+      /* Boxes are stored row by row, then column and anchor */
+      b = arena->candidates[k] % level->num_anchors;
+      cell = arena->candidates[k] / level->num_anchors;
+      i = cell / (params->input_width / level->stride);
+      j = cell % (params->input_width / level->stride);
+
+      /* Cell corner and anchor size, the offsets of all the boxes are
+       * applied at once afterwards */
+      result.x = j * level->stride;
+      result.y = i * level->stride;
+      result.width = level->anchors[2 * b] * level->stride;
+      result.height = level->anchors[2 * b + 1] * level->stride;
+      arena->boxes[counter] = result;
+      arena->levels[counter] = l;
+      memcpy (arena->probabilities + counter * num_classes, box + 5,
+          num_classes * sizeof (gfloat));
+
+      transform = arena->transform + 4 * counter;
+      transform[0] = -box[0];
+      transform[1] = -box[1];
+      transform[2] = box[2];
+      transform[3] = box[3];
+      counter = counter + 1;
     }
-    *elements = counter;
+
+    prediction += level_boxes * box_size;
+  }
+
+  arena->num_boxes = counter;
+  arena->num_classes = num_classes;
+
+  return counter;
+}
+
+static void
+gst_grid_boxes_to_pixels (const GstInferenceDecoderParams * params,
+    GstInferenceDecodeArena * arena)
+{
+  GstInferenceExpFunc exp_func = NULL;
+  const gfloat *transform = NULL;
+  BBox *box = NULL;
+  gdouble stride;
+  gint i;
+
+  g_return_if_fail (params != NULL);
+  g_return_if_fail (arena != NULL);
+
+  /* exp (-tx), exp (-ty), exp (tw) and exp (th) of every box in one go */
+  exp_func = gst_inference_exp_get_func ();
+  exp_func (arena->transform, arena->transform, 4 * arena->num_boxes);
+
+  for (i = 0; i < arena->num_boxes; i++) {
+    box = &arena->boxes[i];
+    transform = arena->transform + 4 * i;
+    stride = params->levels[arena->levels[i]].stride;
+
+    /* adjust the lengths and widths */
+    box->width = box->width * transform[2];
+    box->height = box->height * transform[3];
+
+    /* adjust the box center according to its cell, sigmoid (t) is
+     * 1 / (1 + exp (-t)), and move it to the top left corner */
+    box->x = box->x + stride / (1.0 + transform[0]) - box->width * 0.5;
+    box->y = box->y + stride / (1.0 + transform[1]) - box->height * 0.5;
   }
 }
 
@@ -216,10 +266,9 @@ gst_create_boxes (GstVideoInference * vi, const gpointer prediction,
     gint * elements, gfloat obj_thresh, gfloat prob_thresh, gfloat iou_thresh,
     gdouble ** probabilities, gint num_classes)
 {
-  gint grid_h = 13;
-  gint grid_w = 13;
-  gint boxes_size = 5;
-  BBox boxes[TOTAL_BOXES_5];
+  GstInferenceDecodeArena *arena = NULL;
+  gsize predsize = 0;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (vi != NULL, FALSE);
   g_return_val_if_fail (prediction != NULL, FALSE);
@@ -230,14 +279,21 @@ gst_create_boxes (GstVideoInference * vi, const gpointer prediction,
 
   *elements = 0;
 
-  gst_get_boxes_from_prediction (obj_thresh, prob_thresh, prediction, boxes,
-      elements, grid_h, grid_w, boxes_size, probabilities, num_classes);
-  gst_remove_duplicated_boxes (iou_thresh, boxes, elements);
+  /* No size is given here, the output is trusted to fit the 416x416 layout */
+  predsize = G_MAXSIZE;
+  arena = gst_inference_decode_arena_new ();
+  if (!gst_inference_decode_arena_create_boxes (arena, prediction, predsize,
+          obj_thresh, prob_thresh, iou_thresh, num_classes)) {
+    goto out;
+  }
 
-  *resulting_boxes = g_malloc (*elements * sizeof (BBox));
-  memcpy (*resulting_boxes, boxes, *elements * sizeof (BBox));
+  ret = gst_inference_decode_arena_copy_out (arena, resulting_boxes, elements,
+      probabilities);
 
-  return TRUE;
+out:
+  gst_inference_decode_arena_free (arena);
+
+  return ret;
 }
 
 GstInferencePrediction *
@@ -246,7 +302,6 @@ gst_create_prediction_from_box (GstVideoInference * vi, BBox * box,
 {
   GstInferencePrediction *predict = NULL;
   GstInferenceClassification *c = NULL;
-  gchar *label = NULL;
   BoundingBox bbox;
 
   g_return_val_if_fail (vi != NULL, NULL);
@@ -260,114 +315,172 @@ gst_create_prediction_from_box (GstVideoInference * vi, BBox * box,
 
   predict = gst_inference_prediction_new_full (&bbox);
 
-  if (num_labels > box->label) {
-    label = labels_list[box->label];
-  }
-  c = gst_inference_classification_new_full (box->label, box->prob, label,
-      num_labels, probabilities, labels_list);
+  c = gst_create_classification (vi, box->label, box->prob, num_labels,
+      probabilities, labels_list, num_labels);
   gst_inference_prediction_append_classification (predict, c);
 
   return predict;
 }
 
+gint
+gst_get_top_classes (const gfloat * values, gint num_values, gint k,
+    GstInferenceClassScore * top)
+{
+  GstInferenceFindAboveFunc find_above = NULL;
+  gfloat threshold = -INFINITY;
+  gint num_top = 0, i, pos;
+
+  g_return_val_if_fail (values != NULL || 0 == num_values, 0);
+  g_return_val_if_fail (top != NULL || 0 == k, 0);
+
+  if (k <= 0) {
+    return 0;
+  }
+
+  find_above = gst_inference_find_above_get_func ();
+
+  /* Once k classes are found, only values above the smallest of them
+   * are looked at. The scan skips everything else a vector at a time */
+  for (i = find_above (values, 0, num_values, threshold);
+      i < num_values; i = find_above (values, i + 1, num_values, threshold)) {
+    pos = num_top < k ? num_top++ : k - 1;
+
+    /* Ties keep the lowest class first */
+    for (; pos > 0 && top[pos - 1].prob < values[i]; --pos) {
+      top[pos] = top[pos - 1];
+    }
+    top[pos].class_id = i;
+    top[pos].prob = values[i];
+
+    if (num_top == k) {
+      threshold = (gfloat) top[k - 1].prob;
+    }
+  }
+
+  return num_top;
+}
+
 GstInferenceClassification *
 gst_create_class_from_prediction (GstVideoInference * vi,
     const gpointer prediction, gsize predsize, gchar ** labels_list,
     gint num_labels)
 {
-  gdouble max = -1;
-  gint index = 0;
+  const gfloat *values = (const gfloat *) prediction;
+  GstInferenceClassScore *top = NULL;
+  GstInferenceClassification *c = NULL;
+  gboolean full_probabilities = FALSE;
   gdouble *probs = NULL;
-  gint num_classes = 0;
-  const gchar *label = NULL;
+  gint num_classes = 0, num_top = 0, k = 0;
+  gint class_id = 0;
+  gdouble class_prob = -1;
 
   g_return_val_if_fail (vi != NULL, NULL);
+  g_return_val_if_fail (prediction != NULL || 0 == predsize, NULL);
 
   num_classes = predsize / sizeof (gfloat);
 
-  /* FIXME: This is just dumb */
-  if (sizeof (gfloat) != sizeof (gdouble)) {
-    probs = g_malloc (num_classes * sizeof (gdouble));
+  k = MIN (gst_video_inference_get_top_k (vi, &full_probabilities),
+      (guint) num_classes);
+  top = g_new (GstInferenceClassScore, MAX (k, 1));
 
+  num_top = gst_get_top_classes (values, num_classes, k, top);
+  if (num_top > 0) {
+    class_id = top[0].class_id;
+    class_prob = top[0].prob;
+  }
+
+  c = gst_create_classification (vi, class_id, class_prob, num_classes, NULL,
+      labels_list, num_labels);
+  gst_inference_classification_set_top (c, top, num_top);
+  g_free (top);
+
+  /* The full vector is only widened when requested, straight into the
+   * classification */
+  if (full_probabilities && num_classes > 0) {
+    probs = g_new (gdouble, num_classes);
     for (gint i = 0; i < num_classes; ++i) {
-      probs[i] = (gdouble) ((gfloat *) prediction)[i];
+      probs[i] = values[i];
     }
-  } else {
-    probs = (gdouble *) prediction;
+
+    GST_INFERENCE_CLASSIFICATION_LOCK (c);
+    c->probabilities = probs;
+    GST_INFERENCE_CLASSIFICATION_UNLOCK (c);
   }
 
-  /* Obtain the highest probability and set it as class */
-  for (gint i = 0; i < num_classes; ++i) {
-    gdouble current = probs[i];
-    if (current > max) {
-      max = current;
-      index = i;
+  return c;
+}
+
+static GstInferenceClassification *
+gst_create_classification (GstVideoInference * vi, gint class_id,
+    gdouble class_prob, gint num_classes, const gdouble * probabilities,
+    gchar ** labels_list, gint num_labels)
+{
+  GstInferenceLabels *labels = NULL;
+  GstInferenceClassification *c = NULL;
+  const gchar *label = NULL;
+
+  /* Reference the element label table when the list comes from it,
+   * instead of copying every string */
+  labels = gst_video_inference_get_labels (vi);
+  if (labels && labels->labels == labels_list) {
+    c = gst_inference_classification_new_with_labels (class_id, class_prob,
+        num_classes, probabilities, labels);
+  } else {
+    if (num_labels > class_id) {
+      label = labels_list[class_id];
     }
+    c = gst_inference_classification_new_full (class_id, class_prob, label,
+        num_classes, probabilities, labels_list);
   }
 
-  if (num_labels > index) {
-    label = labels_list[index];
+  if (labels) {
+    gst_inference_labels_unref (labels);
   }
-  return gst_inference_classification_new_full (index, max, label, num_classes,
-      probs, labels_list);
+
+  return c;
 }
 
-static void
-gst_get_boxes_from_prediction_float (gfloat obj_thresh, gfloat prob_thresh,
-    gpointer prediction, BBox * boxes, gint * elements, gint total_boxes,
-    gdouble ** probabilities, gint num_classes)
+static gint
+gst_get_boxes_from_corners (gdouble obj_thresh, gdouble prob_thresh,
+    const gfloat * prediction, GstInferenceDecodeArena * arena,
+    gint total_boxes, gint num_classes)
 {
-  gint i, c;
-  gint index;
-  gdouble obj_prob;
-  gdouble cur_class_prob, max_class_prob;
-  gint max_class_prob_index;
+  GstInferenceCompactAboveFunc compact = NULL;
+  const gfloat *box = NULL;
+  gint k, num_candidates;
   gint counter = 0;
-  gint box_class_base;
-  gint box_dim = 5;
-  gint dimensions_per_box = box_dim + num_classes;
-
-  g_return_if_fail (boxes != NULL);
-  g_return_if_fail (elements != NULL);
-  g_return_if_fail (probabilities != NULL);
-
-  /* Iterate boxes */
-  for (i = 0; i < total_boxes; i++) {
-    index = i * dimensions_per_box;
-    obj_prob = ((gfloat *) prediction)[index + 4];
-
-    /* If the objectness score is over the threshold add it to the boxes list */
-    if (obj_prob > obj_thresh) {
-      double *actual_probs = g_malloc (num_classes * sizeof (gdouble));
-      max_class_prob = 0;
-      max_class_prob_index = 0;
-      box_class_base = index + box_dim;
-
-      /* Iterate each class probability */
-      for (c = 0; c < num_classes; c++) {
-        cur_class_prob = ((gfloat *) prediction)[box_class_base + c];
-        actual_probs[c] = cur_class_prob;
-        if (cur_class_prob > max_class_prob) {
-          max_class_prob = cur_class_prob;
-          max_class_prob_index = c;
-        }
-      }
-
-      if (max_class_prob > prob_thresh) {
-        BBox result;
-        result.label = max_class_prob_index;
-        result.prob = max_class_prob;
-        result.x = ((gfloat *) prediction)[index];
-        result.y = ((gfloat *) prediction)[index + 1];
-        result.width = ((gfloat *) prediction)[index + 2] - result.x;
-        result.height = ((gfloat *) prediction)[index + 3] - result.y;
-        boxes[counter] = result;
-        counter = counter + 1;
-        probabilities[counter - 1] = actual_probs;
-      }
+  gint box_size = 5 + num_classes;
+  gfloat prob_limit = gst_float_threshold (prob_thresh);
+  BBox result;
+
+  g_return_val_if_fail (prediction != NULL, 0);
+  g_return_val_if_fail (arena != NULL, 0);
+
+  /* Most boxes have no object, only score the ones that do */
+  compact = gst_inference_compact_above_get_func ();
+  num_candidates = compact (prediction + 4, box_size, total_boxes,
+      gst_float_threshold (obj_thresh), arena->candidates);
+
+  for (k = 0; k < num_candidates; k++) {
+    box = prediction + arena->candidates[k] * box_size;
+    if (!gst_score_box (box, prob_limit, num_classes, &result)) {
+      continue;
     }
-    *elements = counter;
+
+    result.x = box[0];
+    result.y = box[1];
+    result.width = box[2] - result.x;
+    result.height = box[3] - result.y;
+    arena->boxes[counter] = result;
+    memcpy (arena->probabilities + counter * num_classes, box + 5,
+        num_classes * sizeof (gfloat));
+    counter = counter + 1;
   }
+
+  arena->num_boxes = counter;
+  arena->num_classes = num_classes;
+
+  return counter;
 }
 
 gboolean
@@ -376,21 +489,356 @@ gst_create_boxes_float (GstVideoInference * vi, const gpointer prediction,
     gint * elements, gdouble obj_thresh, gdouble prob_thresh,
     gdouble iou_thresh, gdouble ** probabilities, gint num_classes)
 {
-  BBox boxes[TOTAL_BOXES_15];
+  GstInferenceDecodeArena *arena = NULL;
+  gsize predsize = 0;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (vi != NULL, FALSE);
   g_return_val_if_fail (prediction != NULL, FALSE);
   g_return_val_if_fail (valid_prediction != NULL, FALSE);
   g_return_val_if_fail (resulting_boxes != NULL, FALSE);
   g_return_val_if_fail (elements != NULL, FALSE);
+  g_return_val_if_fail (probabilities != NULL, FALSE);
 
   *elements = 0;
 
-  gst_get_boxes_from_prediction_float (obj_thresh, prob_thresh, prediction,
-      boxes, elements, TOTAL_BOXES_15, probabilities, num_classes);
-  gst_remove_duplicated_boxes (iou_thresh, boxes, elements);
+  /* No size is given here, the output is trusted to fit the 416x416 layout */
+  predsize = G_MAXSIZE;
+  arena = gst_inference_decode_arena_new ();
+  if (!gst_inference_decode_arena_create_boxes_float (arena, prediction,
+          predsize, obj_thresh, prob_thresh, iou_thresh, num_classes)) {
+    goto out;
+  }
+
+  ret = gst_inference_decode_arena_copy_out (arena, resulting_boxes, elements,
+      probabilities);
+
+out:
+  gst_inference_decode_arena_free (arena);
+
+  return ret;
+}
+
+GstInferenceDecodeArena *
+gst_inference_decode_arena_new (void)
+{
+  GstInferenceDecodeArena *arena = g_new0 (GstInferenceDecodeArena, 1);
+
+  arena->nms = gst_inference_nms_new ();
+
+  return arena;
+}
+
+void
+gst_inference_decode_arena_free (GstInferenceDecodeArena * arena)
+{
+  if (NULL == arena) {
+    return;
+  }
+
+  gst_inference_nms_free (arena->nms);
+  g_free (arena->boxes);
+  g_free (arena->probabilities);
+  g_free (arena->scratch_boxes);
+  g_free (arena->scratch_probabilities);
+  g_free (arena->keep);
+  g_free (arena->row);
+  g_free (arena->transform);
+  g_free (arena->levels);
+  g_free (arena->candidates);
+  g_free (arena);
+}
+
+static gboolean
+gst_inference_decode_arena_reserve (GstInferenceDecodeArena * arena,
+    gint capacity, gint num_classes)
+{
+  gsize matrix_size = 0;
+
+  g_return_val_if_fail (arena != NULL, FALSE);
+  g_return_val_if_fail (capacity >= 0, FALSE);
+  g_return_val_if_fail (num_classes >= 0, FALSE);
+
+  if (capacity > arena->capacity) {
+    arena->boxes = g_renew (BBox, arena->boxes, capacity);
+    arena->scratch_boxes = g_renew (BBox, arena->scratch_boxes, capacity);
+    arena->keep = g_renew (guint, arena->keep, capacity);
+    arena->transform = g_renew (gfloat, arena->transform, 4 * capacity);
+    arena->levels = g_renew (guint, arena->levels, capacity);
+    arena->candidates = g_renew (guint, arena->candidates, capacity);
+    arena->capacity = capacity;
+  }
+
+  matrix_size = (gsize) capacity * num_classes;
+  if (matrix_size > arena->matrix_size) {
+    arena->probabilities = g_renew (gfloat, arena->probabilities,
+        matrix_size);
+    arena->scratch_probabilities = g_renew (gfloat,
+        arena->scratch_probabilities, matrix_size);
+    arena->matrix_size = matrix_size;
+  }
+
+  if (num_classes > arena->row_size) {
+    arena->row = g_renew (gdouble, arena->row, num_classes);
+    arena->row_size = num_classes;
+  }
+
+  return TRUE;
+}
+
+static void
+gst_inference_decode_arena_suppress (GstInferenceDecodeArena * arena,
+    gdouble iou_thresh)
+{
+  GstInferenceNmsParams params;
+  BBox *boxes = NULL;
+  gfloat *probabilities = NULL;
+  gsize row_bytes = 0;
+  guint num_kept = 0;
+  guint i = 0;
+
+  g_return_if_fail (arena != NULL);
+
+  if (arena->num_boxes <= 0) {
+    return;
+  }
+
+  gst_inference_nms_params_init (&params, iou_thresh);
+  num_kept = gst_inference_nms_run (arena->nms, &params, arena->boxes,
+      arena->num_boxes, arena->keep);
+
+  /* Gather the survivors in score order into the scratch buffers and
+   * swap them in, so no row needs to be moved twice */
+  row_bytes = arena->num_classes * sizeof (gfloat);
+  for (i = 0; i < num_kept; i++) {
+    arena->scratch_boxes[i] = arena->boxes[arena->keep[i]];
+    memcpy (arena->scratch_probabilities + i * arena->num_classes,
+        arena->probabilities + arena->keep[i] * arena->num_classes,
+        row_bytes);
+  }
+
+  boxes = arena->boxes;
+  arena->boxes = arena->scratch_boxes;
+  arena->scratch_boxes = boxes;
+
+  probabilities = arena->probabilities;
+  arena->probabilities = arena->scratch_probabilities;
+  arena->scratch_probabilities = probabilities;
+
+  arena->num_boxes = num_kept;
+}
+
+void
+gst_inference_decoder_params_init (GstInferenceDecoderParams * params,
+    GstInferenceBoxLayout layout, gint input_width, gint input_height,
+    gint num_classes)
+{
+  g_return_if_fail (params != NULL);
+  g_return_if_fail (num_classes >= 0);
+
+  memset (params, 0, sizeof (GstInferenceDecoderParams));
+  params->layout = layout;
+  params->input_width = input_width;
+  params->input_height = input_height;
+  params->num_classes = num_classes;
+}
+
+gboolean
+gst_inference_decoder_params_add_level (GstInferenceDecoderParams * params,
+    gint stride, const gdouble * anchors, gint num_anchors)
+{
+  GstInferenceAnchorLevel *level = NULL;
+
+  g_return_val_if_fail (params != NULL, FALSE);
+  g_return_val_if_fail (stride > 0, FALSE);
+  g_return_val_if_fail (num_anchors >= 0, FALSE);
+  g_return_val_if_fail (anchors != NULL || 0 == num_anchors
+      || GST_INFERENCE_BOX_LAYOUT_CORNERS == params->layout, FALSE);
+
+  if (params->num_levels >= GST_INFERENCE_MAX_ANCHOR_LEVELS
+      || num_anchors > GST_INFERENCE_MAX_ANCHORS) {
+    return FALSE;
+  }
+
+  level = &params->levels[params->num_levels++];
+  level->stride = stride;
+  level->num_anchors = num_anchors;
+  if (anchors) {
+    memcpy (level->anchors, anchors, 2 * num_anchors * sizeof (gdouble));
+  }
+
+  return TRUE;
+}
+
+void
+gst_inference_decoder_params_init_tinyyolov2 (GstInferenceDecoderParams *
+    params, gint input_width, gint input_height, gint num_classes)
+{
+  const gdouble box_anchors[] =
+      { 1.08, 1.19, 3.42, 4.41, 6.63, 11.38, 9.42, 5.11, 16.62, 10.52 };
+
+  gst_inference_decoder_params_init (params, GST_INFERENCE_BOX_LAYOUT_GRID,
+      input_width, input_height, num_classes);
+  gst_inference_decoder_params_add_level (params, TINYYOLOV2_STRIDE,
+      box_anchors, G_N_ELEMENTS (box_anchors) / 2);
+}
+
+void
+gst_inference_decoder_params_init_tinyyolov3 (GstInferenceDecoderParams *
+    params, gint input_width, gint input_height, gint num_classes)
+{
+  /* The model decodes the boxes itself, only the count matters */
+  gst_inference_decoder_params_init (params,
+      GST_INFERENCE_BOX_LAYOUT_CORNERS, input_width, input_height,
+      num_classes);
+  gst_inference_decoder_params_add_level (params, 32, NULL, 3);
+  gst_inference_decoder_params_add_level (params, 16, NULL, 3);
+}
+
+gint
+gst_inference_decoder_params_get_num_boxes (const GstInferenceDecoderParams *
+    params)
+{
+  const GstInferenceAnchorLevel *level = NULL;
+  gint num_boxes = 0;
+  guint l;
+
+  g_return_val_if_fail (params != NULL, 0);
+
+  for (l = 0; l < params->num_levels; l++) {
+    level = &params->levels[l];
+    num_boxes += (params->input_width / level->stride) *
+        (params->input_height / level->stride) * level->num_anchors;
+  }
+
+  return num_boxes;
+}
+
+gboolean
+gst_inference_decode_arena_decode (GstInferenceDecodeArena * arena,
+    const GstInferenceDecoderParams * params, const gpointer prediction,
+    gsize predsize, gdouble obj_thresh, gdouble prob_thresh,
+    gdouble iou_thresh)
+{
+  gsize box_size = 0;
+  gint total_boxes = 0;
+
+  g_return_val_if_fail (arena != NULL, FALSE);
+  g_return_val_if_fail (params != NULL, FALSE);
+  g_return_val_if_fail (prediction != NULL, FALSE);
+
+  arena->num_boxes = 0;
+
+  box_size = (5 + params->num_classes) * sizeof (gfloat);
+  total_boxes = gst_inference_decoder_params_get_num_boxes (params);
+
+  if (GST_INFERENCE_BOX_LAYOUT_GRID == params->layout) {
+    /* The position of a box in the output is its cell */
+    if (predsize / box_size < (gsize) total_boxes) {
+      return FALSE;
+    }
+
+    gst_inference_decode_arena_reserve (arena, total_boxes,
+        params->num_classes);
+    gst_get_boxes_from_grid (params, obj_thresh, prob_thresh, prediction,
+        arena);
+    gst_grid_boxes_to_pixels (params, arena);
+  } else {
+    /* Never read past the output, whatever the model gave back */
+    total_boxes = MIN ((gsize) total_boxes, predsize / box_size);
+
+    gst_inference_decode_arena_reserve (arena, total_boxes,
+        params->num_classes);
+    gst_get_boxes_from_corners (obj_thresh, prob_thresh, prediction, arena,
+        total_boxes, params->num_classes);
+  }
+
+  gst_inference_decode_arena_suppress (arena, iou_thresh);
+
+  return TRUE;
+}
+
+gboolean
+gst_inference_decode_arena_create_boxes (GstInferenceDecodeArena * arena,
+    const gpointer prediction, gsize predsize, gfloat obj_thresh,
+    gfloat prob_thresh, gfloat iou_thresh, gint num_classes)
+{
+  GstInferenceDecoderParams params;
+
+  g_return_val_if_fail (arena != NULL, FALSE);
+  g_return_val_if_fail (prediction != NULL, FALSE);
+  g_return_val_if_fail (num_classes >= 0, FALSE);
+
+  gst_inference_decoder_params_init_tinyyolov2 (&params,
+      TINYYOLOV2_INPUT_SIZE, TINYYOLOV2_INPUT_SIZE, num_classes);
+
+  return gst_inference_decode_arena_decode (arena, &params, prediction,
+      predsize, obj_thresh, prob_thresh, iou_thresh);
+}
+
+gboolean
+gst_inference_decode_arena_create_boxes_float (GstInferenceDecodeArena *
+    arena, const gpointer prediction, gsize predsize, gdouble obj_thresh,
+    gdouble prob_thresh, gdouble iou_thresh, gint num_classes)
+{
+  GstInferenceDecoderParams params;
+
+  g_return_val_if_fail (arena != NULL, FALSE);
+  g_return_val_if_fail (prediction != NULL, FALSE);
+  g_return_val_if_fail (num_classes >= 0, FALSE);
+
+  gst_inference_decoder_params_init_tinyyolov3 (&params,
+      TINYYOLOV2_INPUT_SIZE, TINYYOLOV2_INPUT_SIZE, num_classes);
+
+  return gst_inference_decode_arena_decode (arena, &params, prediction,
+      predsize, obj_thresh, prob_thresh, iou_thresh);
+}
+
+GstInferencePrediction *
+gst_inference_decode_arena_create_prediction (GstInferenceDecodeArena *
+    arena, GstVideoInference * vi, gint index, gchar ** labels_list,
+    gint num_labels)
+{
+  const gfloat *probabilities = NULL;
+  gint c = 0;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+  g_return_val_if_fail (index >= 0 && index < arena->num_boxes, NULL);
+
+  /* The classification keeps its own copy, so a single row is enough */
+  probabilities = arena->probabilities + index * arena->num_classes;
+  for (c = 0; c < arena->num_classes; c++) {
+    arena->row[c] = probabilities[c];
+  }
+
+  return gst_create_prediction_from_box (vi, &arena->boxes[index],
+      labels_list, num_labels, arena->row);
+}
+
+static gboolean
+gst_inference_decode_arena_copy_out (GstInferenceDecodeArena * arena,
+    BBox ** resulting_boxes, gint * elements, gdouble ** probabilities)
+{
+  const gfloat *row = NULL;
+  gint i = 0, c = 0;
+
+  g_return_val_if_fail (arena != NULL, FALSE);
+  g_return_val_if_fail (resulting_boxes != NULL, FALSE);
+  g_return_val_if_fail (elements != NULL, FALSE);
+  g_return_val_if_fail (probabilities != NULL, FALSE);
+
+  *resulting_boxes = g_malloc (arena->num_boxes * sizeof (BBox));
+  memcpy (*resulting_boxes, arena->boxes, arena->num_boxes * sizeof (BBox));
+
+  for (i = 0; i < arena->num_boxes; i++) {
+    row = arena->probabilities + i * arena->num_classes;
+    probabilities[i] = g_malloc (arena->num_classes * sizeof (gdouble));
+    for (c = 0; c < arena->num_classes; c++) {
+      probabilities[i][c] = row[c];
+    }
+  }
+
+  *elements = arena->num_boxes;
 
-  *resulting_boxes = g_malloc (*elements * sizeof (BBox));
-  memcpy (*resulting_boxes, boxes, *elements * sizeof (BBox));
   return TRUE;
 }
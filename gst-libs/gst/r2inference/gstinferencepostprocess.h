@@ -21,11 +21,236 @@
 
 #include <gst/r2inference/gstvideoinference.h>
 #include <gst/r2inference/gstinferencemeta.h>
+#include <gst/r2inference/gstinferencenms.h>
 
 #ifndef __GST_INFERENCE_POSTPROCESS_H__
 #define __GST_INFERENCE_POSTPROCESS_H__
 
 G_BEGIN_DECLS
+
+#define GST_INFERENCE_MAX_ANCHOR_LEVELS 5
+#define GST_INFERENCE_MAX_ANCHORS 9
+
+/**
+ * \brief How an anchor based detector lays out its boxes. Every box is
+ * followed by its objectness and the probability of every class.
+ *
+ * GST_INFERENCE_BOX_LAYOUT_GRID: YOLOv2 style raw offsets tx, ty, tw, th
+ * per cell and anchor, row major, decoded as sigmoid offsets within the
+ * cell and exponential scales of the anchor.
+ *
+ * GST_INFERENCE_BOX_LAYOUT_CORNERS: Boxes already decoded by the model as
+ * x1, y1, x2, y2 input pixels, like the YOLOv3 exports.
+ */
+typedef enum
+{
+  GST_INFERENCE_BOX_LAYOUT_GRID,
+  GST_INFERENCE_BOX_LAYOUT_CORNERS,
+} GstInferenceBoxLayout;
+
+/**
+ * \brief One output scale of an anchor based detector
+ */
+typedef struct _GstInferenceAnchorLevel GstInferenceAnchorLevel;
+
+struct _GstInferenceAnchorLevel
+{
+  /* Input pixels covered by a grid cell */
+  gint stride;
+  gint num_anchors;
+  /* Width and height of every anchor, in grid cells */
+  gdouble anchors[2 * GST_INFERENCE_MAX_ANCHORS];
+};
+
+/**
+ * \brief Everything the decoder needs to know about the model output. The
+ * grid of every level follows from the input size, so the same model
+ * exported at a different resolution only changes the input size.
+ */
+typedef struct _GstInferenceDecoderParams GstInferenceDecoderParams;
+
+struct _GstInferenceDecoderParams
+{
+  GstInferenceBoxLayout layout;
+  gint input_width;
+  gint input_height;
+  gint num_classes;
+  /* Levels in the order the model outputs them */
+  guint num_levels;
+  GstInferenceAnchorLevel levels[GST_INFERENCE_MAX_ANCHOR_LEVELS];
+};
+
+/**
+ * \brief Scratch memory the box decoders reuse from frame to frame. It
+ * only grows, so once it fits the model output decoding a frame does not
+ * allocate anything.
+ */
+typedef struct _GstInferenceDecodeArena GstInferenceDecodeArena;
+
+struct _GstInferenceDecodeArena
+{
+  /* Decoded boxes, sorted by descending probability */
+  BBox *boxes;
+  /* Class probabilities, one row of num_classes values per box */
+  gfloat *probabilities;
+  gint num_boxes;
+  gint num_classes;
+
+  /*< private >*/
+  gint capacity;
+  gsize matrix_size;
+  gint row_size;
+  BBox *scratch_boxes;
+  gfloat *scratch_probabilities;
+  guint *keep;
+  gdouble *row;
+  gfloat *transform;
+  guint *levels;
+  guint *candidates;
+  GstInferenceNms *nms;
+};
+
+/**
+ * \brief Fill the decoder parameters, without any level
+ *
+ * \param params The parameters to initialize
+ * \param layout The layout of the boxes
+ * \param input_width The width of the model input
+ * \param input_height The height of the model input
+ * \param num_classes The number of classes
+ */
+void gst_inference_decoder_params_init (GstInferenceDecoderParams * params,
+    GstInferenceBoxLayout layout, gint input_width, gint input_height,
+    gint num_classes);
+
+/**
+ * \brief Append an output level
+ *
+ * \param params The parameters to modify
+ * \param stride Input pixels covered by a grid cell
+ * \param anchors Width and height pairs of every anchor, in grid cells.
+ * May be NULL for the corners layout.
+ * \param num_anchors The number of anchors
+ *
+ * \return FALSE if there are too many levels or anchors
+ */
+gboolean gst_inference_decoder_params_add_level (GstInferenceDecoderParams *
+    params, gint stride, const gdouble * anchors, gint num_anchors);
+
+/**
+ * \brief Fill the decoder parameters of TinyYOLOv2: one 32 pixel grid
+ * with 5 anchors
+ *
+ * \param params The parameters to initialize
+ * \param input_width The width of the model input
+ * \param input_height The height of the model input
+ * \param num_classes The number of classes
+ */
+void gst_inference_decoder_params_init_tinyyolov2 (GstInferenceDecoderParams *
+    params, gint input_width, gint input_height, gint num_classes);
+
+/**
+ * \brief Fill the decoder parameters of TinyYOLOv3: decoded boxes from a
+ * 32 and a 16 pixel grid with 3 anchors each
+ *
+ * \param params The parameters to initialize
+ * \param input_width The width of the model input
+ * \param input_height The height of the model input
+ * \param num_classes The number of classes
+ */
+void gst_inference_decoder_params_init_tinyyolov3 (GstInferenceDecoderParams *
+    params, gint input_width, gint input_height, gint num_classes);
+
+/**
+ * \brief Get the number of boxes the model outputs
+ *
+ * \param params The decoder parameters
+ */
+gint gst_inference_decoder_params_get_num_boxes (const
+    GstInferenceDecoderParams * params);
+
+/**
+ * \brief Create a new, empty decode arena
+ */
+GstInferenceDecodeArena *gst_inference_decode_arena_new (void);
+
+/**
+ * \brief Free a decode arena and everything it holds
+ *
+ * \param arena The arena to free, may be NULL
+ */
+void gst_inference_decode_arena_free (GstInferenceDecodeArena * arena);
+
+/**
+ * \brief Decode the boxes of an anchor based detector into the arena and
+ * remove the duplicated ones. Replaces the previous content of the arena.
+ *
+ * \param arena The arena to decode into
+ * \param params The layout of the model output
+ * \param prediction Value of the prediction
+ * \param predsize Size of the prediction in bytes
+ * \param obj_thresh Objectness threshold
+ * \param prob_thresh Class probability threshold
+ * \param iou_thresh Intersection over union threshold
+ *
+ * \return FALSE if the prediction is too small for the grid layout. Only
+ * the boxes that fit are read in the corners layout.
+ */
+gboolean gst_inference_decode_arena_decode (GstInferenceDecodeArena * arena,
+    const GstInferenceDecoderParams * params, const gpointer prediction,
+    gsize predsize, gdouble obj_thresh, gdouble prob_thresh,
+    gdouble iou_thresh);
+
+/**
+ * \brief Decode a 13x13x5 grid of TinyYOLOv2 boxes, as output for a
+ * 416x416 input, into the arena and remove the duplicated ones. Replaces
+ * the previous content of the arena.
+ *
+ * \param arena The arena to decode into
+ * \param prediction Value of the prediction
+ * \param predsize Size of the prediction in bytes
+ * \param obj_thresh Objectness threshold
+ * \param prob_thresh Class probability threshold
+ * \param iou_thresh Intersection over union threshold
+ * \param num_classes The number of classes
+ *
+ * \return FALSE if the prediction is too small for the grid
+ */
+gboolean gst_inference_decode_arena_create_boxes (GstInferenceDecodeArena *
+    arena, const gpointer prediction, gsize predsize, gfloat obj_thresh,
+    gfloat prob_thresh, gfloat iou_thresh, gint num_classes);
+
+/**
+ * \brief Decode a list of TinyYOLOv3 corner boxes, as output for a
+ * 416x416 input, into the arena and remove the duplicated ones. Replaces
+ * the previous content of the arena.
+ *
+ * \param arena The arena to decode into
+ * \param prediction Value of the prediction
+ * \param predsize Size of the prediction in bytes
+ * \param obj_thresh Objectness threshold
+ * \param prob_thresh Class probability threshold
+ * \param iou_thresh Intersection over union threshold
+ * \param num_classes The number of classes
+ */
+gboolean gst_inference_decode_arena_create_boxes_float (
+    GstInferenceDecodeArena * arena, const gpointer prediction,
+    gsize predsize, gdouble obj_thresh, gdouble prob_thresh,
+    gdouble iou_thresh, gint num_classes);
+
+/**
+ * \brief Create a Prediction from one of the boxes in the arena
+ *
+ * \param arena The arena holding the decoded boxes
+ * \param vi Father object of every architecture
+ * \param index Index of the box, lower than num_boxes
+ * \param labels_list List with all possible lables
+ * \param num_labels The number of posibble labels
+ */
+GstInferencePrediction *gst_inference_decode_arena_create_prediction (
+    GstInferenceDecodeArena * arena, GstVideoInference * vi, gint index,
+    gchar **labels_list, gint num_labels);
+
 /**
  * \brief Fill all the data for the boxes
  *
@@ -78,7 +303,24 @@ GstInferencePrediction *gst_create_prediction_from_box (GstVideoInference * vi,
     BBox * box, gchar **labels_list, gint num_labels, const gdouble * probabilities);
 
 /**
- * \brief Create Classification from prediction data
+ * \brief Find the most probable classes of a prediction
+ *
+ * \param values The probability of every class
+ * \param num_values The number of classes
+ * \param k The maximum number of classes to find
+ * \param top The output, room for k entries, sorted by descending
+ * probability. Ties keep the lowest class first.
+ *
+ * \return The number of classes found. It is k unless there are fewer
+ * classes, NaN and minus infinity are never selected.
+ */
+gint gst_get_top_classes (const gfloat * values, gint num_values, gint k,
+    GstInferenceClassScore * top);
+
+/**
+ * \brief Create Classification from prediction data. Only the top-k
+ * classes of the element are kept, and the probabilities of every class
+ * if full-probabilities is enabled.
  *
  * \param vi Father object of every architecture
  * \param prediction Value of the prediction
@@ -89,7 +331,8 @@ GstInferencePrediction *gst_create_prediction_from_box (GstVideoInference * vi,
 GstInferenceClassification *gst_create_class_from_prediction (GstVideoInference * vi,
     const gpointer prediction, gsize predsize, gchar **labels_list, gint num_labels);
 /**
- * \brief Remove duplicated boxes
+ * \brief Remove duplicated boxes. The remaining boxes are sorted by
+ * descending probability.
  * \param iou_thresh Threshold of iou to consider that a box is duplicated
  * \param boxes Array of bounding boxes
  * \param num_boxes Amount of boxes in the array
@@ -97,5 +340,18 @@ GstInferenceClassification *gst_create_class_from_prediction (GstVideoInference
 void gst_remove_duplicated_boxes (gdouble iou_thresh, BBox * boxes,
     gint * num_boxes);
 
+/**
+ * \brief Remove duplicated boxes with the given NMS parameters. The
+ * remaining boxes are sorted by descending probability.
+ * \param params The non-maximum suppression parameters
+ * \param boxes Array of bounding boxes
+ * \param probabilities Class probabilities of every box, or NULL. They
+ * are reordered along with the boxes, the ones of the removed boxes end
+ * up after the remaining ones.
+ * \param num_boxes Amount of boxes in the array
+ */
+void gst_remove_duplicated_boxes_full (const GstInferenceNmsParams * params,
+    BBox * boxes, gdouble ** probabilities, gint * num_boxes);
+
 G_END_DECLS
 #endif
@@ -0,0 +1,754 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencepostprocesskernels.h"
+
+#include <math.h>
+
+#if defined(GST_INFERENCE_HAVE_X86)
+#include <immintrin.h>
+#elif defined(GST_INFERENCE_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Cephes style exponential: exp (x) = 2^n * exp (r), with n the nearest
+ * integer to x / ln (2) and a polynomial for exp (r). Every kernel runs
+ * the same operations in the same order as the scalar one */
+#define EXP_HI 88.3762626647949f
+#define EXP_LO -88.3762626647949f
+#define EXP_LOG2E 1.44269504088896341f
+#define EXP_LN2_HI 0.693359375f
+#define EXP_LN2_LO -2.12194440e-4f
+#define EXP_P0 1.9875691500e-4f
+#define EXP_P1 1.3981999507e-3f
+#define EXP_P2 8.3334519073e-3f
+#define EXP_P3 4.1665795894e-2f
+#define EXP_P4 1.6666665459e-1f
+#define EXP_P5 5.0000001201e-1f
+
+static gint gst_inference_find_above_c (const gfloat * values, gint start,
+    gint count, gfloat threshold);
+static GstInferenceFindAboveFunc gst_inference_find_above_select (void);
+static gint gst_inference_compact_above_tail (const gfloat * values,
+    gint stride, gint start, gint count, gfloat threshold, guint * indices,
+    gint found);
+static gint gst_inference_compact_above_c (const gfloat * values,
+    gint stride, gint count, gfloat threshold, guint * indices);
+static GstInferenceCompactAboveFunc gst_inference_compact_above_select (void);
+static gint gst_inference_argmax_locate (const gfloat * values, gint start,
+    gint count, gfloat partial, gfloat * max);
+static gint gst_inference_argmax_c (const gfloat * values, gint count,
+    gfloat * max);
+static GstInferenceArgmaxFunc gst_inference_argmax_select (void);
+static void gst_inference_exp_tail (const gfloat * in, gfloat * out,
+    gint start, gint count);
+static void gst_inference_exp_c (const gfloat * in, gfloat * out,
+    gint count);
+static GstInferenceExpFunc gst_inference_exp_select (void);
+
+static gint
+gst_inference_find_above_c (const gfloat * values, gint start, gint count,
+    gfloat threshold)
+{
+  gint i;
+
+  for (i = start; i < count; ++i) {
+    if (values[i] > threshold) {
+      break;
+    }
+  }
+
+  return i;
+}
+
+static gint
+gst_inference_compact_above_tail (const gfloat * values, gint stride,
+    gint start, gint count, gfloat threshold, guint * indices, gint found)
+{
+  gint i;
+
+  for (i = start; i < count; ++i) {
+    if (values[i * stride] > threshold) {
+      indices[found++] = i;
+    }
+  }
+
+  return found;
+}
+
+static gint
+gst_inference_compact_above_c (const gfloat * values, gint stride,
+    gint count, gfloat threshold, guint * indices)
+{
+  return gst_inference_compact_above_tail (values, stride, 0, count,
+      threshold, indices, 0);
+}
+
+/* Finishes a vectorized reduction: folds the values from start on into
+ * the partial maximum and looks for its first occurrence */
+static gint
+gst_inference_argmax_locate (const gfloat * values, gint start, gint count,
+    gfloat partial, gfloat * max)
+{
+  gint i;
+
+  for (i = start; i < count; ++i) {
+    if (values[i] > partial) {
+      partial = values[i];
+    }
+  }
+
+  *max = partial;
+  if (-INFINITY == partial) {
+    return -1;
+  }
+
+  for (i = 0; values[i] != partial; ++i) {
+  }
+
+  return i;
+}
+
+static gint
+gst_inference_argmax_c (const gfloat * values, gint count, gfloat * max)
+{
+  gint i, index = -1;
+
+  *max = -INFINITY;
+  for (i = 0; i < count; ++i) {
+    if (values[i] > *max) {
+      *max = values[i];
+      index = i;
+    }
+  }
+
+  return index;
+}
+
+static void
+gst_inference_exp_tail (const gfloat * in, gfloat * out, gint start,
+    gint count)
+{
+  union
+  {
+    gint32 i;
+    gfloat f;
+  } pow2n;
+  gfloat x, n, z, y;
+  gint i;
+
+  for (i = start; i < count; ++i) {
+    x = CLAMP (in[i], EXP_LO, EXP_HI);
+
+    n = floorf (x * EXP_LOG2E + 0.5f);
+    x = x - n * EXP_LN2_HI;
+    x = x - n * EXP_LN2_LO;
+
+    z = x * x;
+    y = EXP_P0;
+    y = y * x + EXP_P1;
+    y = y * x + EXP_P2;
+    y = y * x + EXP_P3;
+    y = y * x + EXP_P4;
+    y = y * x + EXP_P5;
+    y = y * z + x + 1.0f;
+
+    pow2n.i = ((gint32) n + 127) << 23;
+    out[i] = y * pow2n.f;
+  }
+}
+
+static void
+gst_inference_exp_c (const gfloat * in, gfloat * out, gint count)
+{
+  gst_inference_exp_tail (in, out, 0, count);
+}
+
+#if defined(GST_INFERENCE_HAVE_X86)
+
+static gint gst_inference_find_above_sse41 (const gfloat * values,
+    gint start, gint count, gfloat threshold);
+static gint gst_inference_find_above_avx2 (const gfloat * values,
+    gint start, gint count, gfloat threshold);
+static gint gst_inference_compact_above_sse41 (const gfloat * values,
+    gint stride, gint count, gfloat threshold, guint * indices);
+static gint gst_inference_compact_above_avx2 (const gfloat * values,
+    gint stride, gint count, gfloat threshold, guint * indices);
+static gint gst_inference_argmax_sse41 (const gfloat * values, gint count,
+    gfloat * max);
+static gint gst_inference_argmax_avx2 (const gfloat * values, gint count,
+    gfloat * max);
+static void gst_inference_exp_sse41 (const gfloat * in, gfloat * out,
+    gint count);
+static void gst_inference_exp_avx2 (const gfloat * in, gfloat * out,
+    gint count);
+
+GST_INFERENCE_TARGET ("sse4.1")
+static gint
+gst_inference_find_above_sse41 (const gfloat * values, gint start,
+    gint count, gfloat threshold)
+{
+  const __m128 limit = _mm_set1_ps (threshold);
+  gint i, mask;
+
+  for (i = start; i + 4 <= count; i += 4) {
+    mask = _mm_movemask_ps (_mm_cmpgt_ps (_mm_loadu_ps (values + i), limit));
+    if (mask) {
+      return i + g_bit_nth_lsf (mask, -1);
+    }
+  }
+
+  return gst_inference_find_above_c (values, i, count, threshold);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static gint
+gst_inference_find_above_avx2 (const gfloat * values, gint start,
+    gint count, gfloat threshold)
+{
+  const __m256 limit = _mm256_set1_ps (threshold);
+  __m256 lo, hi;
+  gint i, mask;
+
+  /* 16 values per iteration, most blocks have nothing above */
+  for (i = start; i + 16 <= count; i += 16) {
+    lo = _mm256_cmp_ps (_mm256_loadu_ps (values + i), limit, _CMP_GT_OQ);
+    hi = _mm256_cmp_ps (_mm256_loadu_ps (values + i + 8), limit, _CMP_GT_OQ);
+    if (!_mm256_testz_ps (_mm256_or_ps (lo, hi), _mm256_or_ps (lo, hi))) {
+      mask = _mm256_movemask_ps (lo) | (_mm256_movemask_ps (hi) << 8);
+      return i + g_bit_nth_lsf (mask, -1);
+    }
+  }
+
+  return gst_inference_find_above_sse41 (values, i, count, threshold);
+}
+
+GST_INFERENCE_TARGET ("sse4.1")
+static gint
+gst_inference_compact_above_sse41 (const gfloat * values, gint stride,
+    gint count, gfloat threshold, guint * indices)
+{
+  const __m128 limit = _mm_set1_ps (threshold);
+  const gfloat *v = NULL;
+  __m128 block;
+  gint i, mask, found = 0;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    v = values + i * stride;
+    block = _mm_setr_ps (v[0], v[stride], v[2 * stride], v[3 * stride]);
+    mask = _mm_movemask_ps (_mm_cmpgt_ps (block, limit));
+    /* Append the set lanes in order */
+    while (mask) {
+      indices[found++] = i + g_bit_nth_lsf (mask, -1);
+      mask &= mask - 1;
+    }
+  }
+
+  return gst_inference_compact_above_tail (values, stride, i, count,
+      threshold, indices, found);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static gint
+gst_inference_compact_above_avx2 (const gfloat * values, gint stride,
+    gint count, gfloat threshold, guint * indices)
+{
+  const __m256 limit = _mm256_set1_ps (threshold);
+  const __m256i offsets = _mm256_mullo_epi32 (_mm256_setr_epi32 (0, 1, 2, 3,
+          4, 5, 6, 7), _mm256_set1_epi32 (stride));
+  __m256 block;
+  gint i, mask, found = 0;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    block = _mm256_i32gather_ps (values + i * stride, offsets, 4);
+    mask = _mm256_movemask_ps (_mm256_cmp_ps (block, limit, _CMP_GT_OQ));
+    /* Append the set lanes in order */
+    while (mask) {
+      indices[found++] = i + g_bit_nth_lsf (mask, -1);
+      mask &= mask - 1;
+    }
+  }
+
+  return gst_inference_compact_above_tail (values, stride, i, count,
+      threshold, indices, found);
+}
+
+GST_INFERENCE_TARGET ("sse4.1")
+static gint
+gst_inference_argmax_sse41 (const gfloat * values, gint count, gfloat * max)
+{
+  __m128 acc = _mm_set1_ps (-INFINITY);
+  gint i;
+
+  /* A NaN in the first operand leaves the accumulator as it is */
+  for (i = 0; i + 4 <= count; i += 4) {
+    acc = _mm_max_ps (_mm_loadu_ps (values + i), acc);
+  }
+  acc = _mm_max_ps (acc, _mm_movehl_ps (acc, acc));
+  acc = _mm_max_ss (acc, _mm_shuffle_ps (acc, acc, 1));
+
+  return gst_inference_argmax_locate (values, i, count, _mm_cvtss_f32 (acc),
+      max);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static gint
+gst_inference_argmax_avx2 (const gfloat * values, gint count, gfloat * max)
+{
+  __m256 acc = _mm256_set1_ps (-INFINITY);
+  __m128 half;
+  gint i;
+
+  /* A NaN in the first operand leaves the accumulator as it is */
+  for (i = 0; i + 8 <= count; i += 8) {
+    acc = _mm256_max_ps (_mm256_loadu_ps (values + i), acc);
+  }
+  half = _mm_max_ps (_mm256_castps256_ps128 (acc),
+      _mm256_extractf128_ps (acc, 1));
+  half = _mm_max_ps (half, _mm_movehl_ps (half, half));
+  half = _mm_max_ss (half, _mm_shuffle_ps (half, half, 1));
+
+  return gst_inference_argmax_locate (values, i, count, _mm_cvtss_f32 (half),
+      max);
+}
+
+GST_INFERENCE_TARGET ("sse4.1")
+static void
+gst_inference_exp_sse41 (const gfloat * in, gfloat * out, gint count)
+{
+  __m128 x, n, z, y;
+  __m128i pow2n;
+  gint i;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = _mm_loadu_ps (in + i);
+    x = _mm_min_ps (_mm_max_ps (x, _mm_set1_ps (EXP_LO)),
+        _mm_set1_ps (EXP_HI));
+
+    n = _mm_mul_ps (x, _mm_set1_ps (EXP_LOG2E));
+    n = _mm_floor_ps (_mm_add_ps (n, _mm_set1_ps (0.5f)));
+    x = _mm_sub_ps (x, _mm_mul_ps (n, _mm_set1_ps (EXP_LN2_HI)));
+    x = _mm_sub_ps (x, _mm_mul_ps (n, _mm_set1_ps (EXP_LN2_LO)));
+
+    z = _mm_mul_ps (x, x);
+    y = _mm_set1_ps (EXP_P0);
+    y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (EXP_P1));
+    y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (EXP_P2));
+    y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (EXP_P3));
+    y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (EXP_P4));
+    y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (EXP_P5));
+    y = _mm_add_ps (_mm_add_ps (_mm_mul_ps (y, z), x), _mm_set1_ps (1.0f));
+
+    pow2n = _mm_add_epi32 (_mm_cvttps_epi32 (n), _mm_set1_epi32 (127));
+    pow2n = _mm_slli_epi32 (pow2n, 23);
+    _mm_storeu_ps (out + i, _mm_mul_ps (y, _mm_castsi128_ps (pow2n)));
+  }
+
+  gst_inference_exp_tail (in, out, i, count);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static void
+gst_inference_exp_avx2 (const gfloat * in, gfloat * out, gint count)
+{
+  __m256 x, n, z, y;
+  __m256i pow2n;
+  gint i;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    x = _mm256_loadu_ps (in + i);
+    x = _mm256_min_ps (_mm256_max_ps (x, _mm256_set1_ps (EXP_LO)),
+        _mm256_set1_ps (EXP_HI));
+
+    n = _mm256_mul_ps (x, _mm256_set1_ps (EXP_LOG2E));
+    n = _mm256_floor_ps (_mm256_add_ps (n, _mm256_set1_ps (0.5f)));
+    x = _mm256_sub_ps (x, _mm256_mul_ps (n, _mm256_set1_ps (EXP_LN2_HI)));
+    x = _mm256_sub_ps (x, _mm256_mul_ps (n, _mm256_set1_ps (EXP_LN2_LO)));
+
+    z = _mm256_mul_ps (x, x);
+    y = _mm256_set1_ps (EXP_P0);
+    y = _mm256_add_ps (_mm256_mul_ps (y, x), _mm256_set1_ps (EXP_P1));
+    y = _mm256_add_ps (_mm256_mul_ps (y, x), _mm256_set1_ps (EXP_P2));
+    y = _mm256_add_ps (_mm256_mul_ps (y, x), _mm256_set1_ps (EXP_P3));
+    y = _mm256_add_ps (_mm256_mul_ps (y, x), _mm256_set1_ps (EXP_P4));
+    y = _mm256_add_ps (_mm256_mul_ps (y, x), _mm256_set1_ps (EXP_P5));
+    y = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (y, z), x),
+        _mm256_set1_ps (1.0f));
+
+    pow2n = _mm256_add_epi32 (_mm256_cvttps_epi32 (n),
+        _mm256_set1_epi32 (127));
+    pow2n = _mm256_slli_epi32 (pow2n, 23);
+    _mm256_storeu_ps (out + i, _mm256_mul_ps (y,
+            _mm256_castsi256_ps (pow2n)));
+  }
+
+  gst_inference_exp_tail (in, out, i, count);
+}
+
+#elif defined(GST_INFERENCE_HAVE_NEON)
+
+static gint gst_inference_find_above_neon (const gfloat * values,
+    gint start, gint count, gfloat threshold);
+static gint gst_inference_compact_above_neon (const gfloat * values,
+    gint stride, gint count, gfloat threshold, guint * indices);
+static gint gst_inference_argmax_neon (const gfloat * values, gint count,
+    gfloat * max);
+static void gst_inference_exp_neon (const gfloat * in, gfloat * out,
+    gint count);
+
+static gint
+gst_inference_find_above_neon (const gfloat * values, gint start,
+    gint count, gfloat threshold)
+{
+  const float32x4_t limit = vdupq_n_f32 (threshold);
+  uint32x4_t lo, hi;
+  gint i;
+
+  for (i = start; i + 8 <= count; i += 8) {
+    lo = vcgtq_f32 (vld1q_f32 (values + i), limit);
+    hi = vcgtq_f32 (vld1q_f32 (values + i + 4), limit);
+    if (vmaxvq_u32 (vorrq_u32 (lo, hi))) {
+      break;
+    }
+  }
+
+  return gst_inference_find_above_c (values, i, count, threshold);
+}
+
+static gint
+gst_inference_compact_above_neon (const gfloat * values, gint stride,
+    gint count, gfloat threshold, guint * indices)
+{
+  static const guint32 lanes[4] = { 1, 2, 4, 8 };
+  const float32x4_t limit = vdupq_n_f32 (threshold);
+  const uint32x4_t bits = vld1q_u32 (lanes);
+  const gfloat *v = NULL;
+  float32x4_t block;
+  gint i, mask, found = 0;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    v = values + i * stride;
+    block = vdupq_n_f32 (v[0]);
+    block = vsetq_lane_f32 (v[stride], block, 1);
+    block = vsetq_lane_f32 (v[2 * stride], block, 2);
+    block = vsetq_lane_f32 (v[3 * stride], block, 3);
+    mask = vaddvq_u32 (vandq_u32 (vcgtq_f32 (block, limit), bits));
+    /* Append the set lanes in order */
+    while (mask) {
+      indices[found++] = i + g_bit_nth_lsf (mask, -1);
+      mask &= mask - 1;
+    }
+  }
+
+  return gst_inference_compact_above_tail (values, stride, i, count,
+      threshold, indices, found);
+}
+
+static gint
+gst_inference_argmax_neon (const gfloat * values, gint count, gfloat * max)
+{
+  float32x4_t acc = vdupq_n_f32 (-INFINITY);
+  gint i;
+
+  /* maxNum semantics, NaN values are dropped */
+  for (i = 0; i + 4 <= count; i += 4) {
+    acc = vmaxnmq_f32 (acc, vld1q_f32 (values + i));
+  }
+
+  return gst_inference_argmax_locate (values, i, count, vmaxnmvq_f32 (acc),
+      max);
+}
+
+static void
+gst_inference_exp_neon (const gfloat * in, gfloat * out, gint count)
+{
+  float32x4_t x, n, z, y;
+  int32x4_t pow2n;
+  gint i;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = vld1q_f32 (in + i);
+    x = vminq_f32 (vmaxq_f32 (x, vdupq_n_f32 (EXP_LO)),
+        vdupq_n_f32 (EXP_HI));
+
+    n = vmulq_f32 (x, vdupq_n_f32 (EXP_LOG2E));
+    n = vrndmq_f32 (vaddq_f32 (n, vdupq_n_f32 (0.5f)));
+    x = vsubq_f32 (x, vmulq_f32 (n, vdupq_n_f32 (EXP_LN2_HI)));
+    x = vsubq_f32 (x, vmulq_f32 (n, vdupq_n_f32 (EXP_LN2_LO)));
+
+    z = vmulq_f32 (x, x);
+    y = vdupq_n_f32 (EXP_P0);
+    y = vaddq_f32 (vmulq_f32 (y, x), vdupq_n_f32 (EXP_P1));
+    y = vaddq_f32 (vmulq_f32 (y, x), vdupq_n_f32 (EXP_P2));
+    y = vaddq_f32 (vmulq_f32 (y, x), vdupq_n_f32 (EXP_P3));
+    y = vaddq_f32 (vmulq_f32 (y, x), vdupq_n_f32 (EXP_P4));
+    y = vaddq_f32 (vmulq_f32 (y, x), vdupq_n_f32 (EXP_P5));
+    y = vaddq_f32 (vaddq_f32 (vmulq_f32 (y, z), x), vdupq_n_f32 (1.0f));
+
+    pow2n = vaddq_s32 (vcvtq_s32_f32 (n), vdupq_n_s32 (127));
+    pow2n = vshlq_n_s32 (pow2n, 23);
+    vst1q_f32 (out + i, vmulq_f32 (y, vreinterpretq_f32_s32 (pow2n)));
+  }
+
+  gst_inference_exp_tail (in, out, i, count);
+}
+
+#endif
+
+static GstInferenceFindAboveFunc
+gst_inference_find_above_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceFindAboveFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_find_above_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_find_above_c;
+}
+
+GstInferenceFindAboveFunc
+gst_inference_find_above_get_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceFindAboveFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_find_above_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceFindAboveFunc
+gst_inference_find_above_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  /* The scan is bound by the loads, AVX-512 would not help */
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_find_above_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_find_above_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_find_above_avx2;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_find_above_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+static GstInferenceCompactAboveFunc
+gst_inference_compact_above_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceCompactAboveFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_compact_above_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_compact_above_c;
+}
+
+GstInferenceCompactAboveFunc
+gst_inference_compact_above_get_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceCompactAboveFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_compact_above_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceCompactAboveFunc
+gst_inference_compact_above_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  /* The strided loads limit the scan, wider gathers would not help */
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_compact_above_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_compact_above_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_compact_above_avx2;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_compact_above_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+static GstInferenceArgmaxFunc
+gst_inference_argmax_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceArgmaxFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_argmax_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_argmax_c;
+}
+
+GstInferenceArgmaxFunc
+gst_inference_argmax_get_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceArgmaxFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_argmax_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceArgmaxFunc
+gst_inference_argmax_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  /* Class rows are a few dozen values, AVX-512 would not pay off */
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_argmax_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_argmax_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_argmax_avx2;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_argmax_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+static GstInferenceExpFunc
+gst_inference_exp_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceExpFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_exp_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_exp_c;
+}
+
+GstInferenceExpFunc
+gst_inference_exp_get_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceExpFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_exp_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceExpFunc
+gst_inference_exp_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  /* Only a few boxes per frame get here, AVX-512 would not pay off */
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_exp_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_exp_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_exp_avx2;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_exp_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_POSTPROCESS_KERNELS_H__
+#define __GST_INFERENCE_POSTPROCESS_KERNELS_H__
+
+#include "gstinferencepreprocesskernels.h"
+
+G_BEGIN_DECLS
+
+/* Returns the index of the first value strictly above the threshold in
+ * [start, count), or count if there is none. NaN values never match. */
+typedef gint (*GstInferenceFindAboveFunc) (const gfloat * values,
+    gint start, gint count, gfloat threshold);
+
+/* Stores the index i of every values[i * stride] strictly above the
+ * threshold in [0, count), in increasing order, and returns how many
+ * there are. Indices must have room for count entries. */
+typedef gint (*GstInferenceCompactAboveFunc) (const gfloat * values,
+    gint stride, gint count, gfloat threshold, guint * indices);
+
+/* Returns the index of the first largest value and stores it in max, or
+ * -1 if no value is above -inf. NaN values are skipped. */
+typedef gint (*GstInferenceArgmaxFunc) (const gfloat * values, gint count,
+    gfloat * max);
+
+/* Computes the exponential of every value. It is a polynomial
+ * approximation within a few float ulps of expf (), and saturates to 0
+ * and to about 2^127 outside of +-88. In and out may be the same array. */
+typedef void (*GstInferenceExpFunc) (const gfloat * in, gfloat * out,
+    gint count);
+
+/**
+ * \brief Get the fastest threshold scan supported by the running CPU.
+ * The choice is made once per process.
+ */
+GstInferenceFindAboveFunc gst_inference_find_above_get_func (void);
+
+/**
+ * \brief Get a specific threshold scan
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceFindAboveFunc gst_inference_find_above_get_impl (GstInferenceKernelImpl impl);
+
+/**
+ * \brief Get the fastest strided threshold compaction supported by the
+ * running CPU. The choice is made once per process.
+ */
+GstInferenceCompactAboveFunc gst_inference_compact_above_get_func (void);
+
+/**
+ * \brief Get a specific strided threshold compaction
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceCompactAboveFunc gst_inference_compact_above_get_impl (GstInferenceKernelImpl impl);
+
+/**
+ * \brief Get the fastest arg max supported by the running CPU.
+ * The choice is made once per process.
+ */
+GstInferenceArgmaxFunc gst_inference_argmax_get_func (void);
+
+/**
+ * \brief Get a specific arg max kernel
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceArgmaxFunc gst_inference_argmax_get_impl (GstInferenceKernelImpl impl);
+
+/**
+ * \brief Get the fastest exponential supported by the running CPU.
+ * The choice is made once per process.
+ */
+GstInferenceExpFunc gst_inference_exp_get_func (void);
+
+/**
+ * \brief Get a specific exponential kernel
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceExpFunc gst_inference_exp_get_impl (GstInferenceKernelImpl impl);
+
+G_END_DECLS
+
+#endif //__GST_INFERENCE_POSTPROCESS_KERNELS_H__
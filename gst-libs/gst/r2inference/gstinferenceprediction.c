@@ -31,27 +31,25 @@ struct _PredictionScaleData
   GstVideoInfo *to;
 };
 
-typedef struct _PredictionFindData PredictionFindData;
-struct _PredictionFindData
-{
-  GstInferencePrediction *prediction;
-  guint64 prediction_id;
-};
-
 static void gst_inference_prediction_free (GstInferencePrediction * self);
 static GstInferencePrediction *prediction_copy (const GstInferencePrediction *
     self);
 static void prediction_free (GstInferencePrediction * obj);
-static gboolean prediction_find (GstInferencePrediction * obj,
-    PredictionFindData * found);
 static GstInferencePrediction *prediction_find_unlocked (GstInferencePrediction
     * self, guint64 id);
+static GstInferencePrediction *prediction_get_root (GstInferencePrediction *
+    self);
+static GstInferencePrediction *prediction_index_lookup (GstInferencePrediction
+    * self, guint64 id);
+static void prediction_append_unlocked (GstInferencePrediction * self,
+    GstInferencePrediction * child);
 static void prediction_reset (GstInferencePrediction * self);
-static gchar *prediction_to_string (GstInferencePrediction * self, gint level);
-static gchar *prediction_children_to_string (GstInferencePrediction * self,
-    gint level);
-static gchar *prediction_classes_to_string (GstInferencePrediction * self,
-    gint level);
+static void prediction_serialize (GstInferencePrediction * self, gint level,
+    GString * string);
+static void prediction_children_serialize (GstInferencePrediction * self,
+    gint level, GString * string);
+static void prediction_classes_serialize (GstInferencePrediction * self,
+    gint level, GString * string);
 static GstInferencePrediction *prediction_scale (const GstInferencePrediction *
     self, GstVideoInfo * to, GstVideoInfo * from);
 static void prediction_scale_ip (GstInferencePrediction * self,
@@ -65,17 +63,18 @@ static void prediction_get_enabled (GstInferencePrediction * self,
 static GstInferenceClassification
     * classification_copy (GstInferenceClassification * from, gpointer data);
 static void classification_merge (GList * src, GList ** dst);
-static gint classification_compare (gconstpointer a, gconstpointer b);
 
 static void bounding_box_reset (BoundingBox * bbox);
-static gchar *bounding_box_to_string (BoundingBox * bbox, gint level);
+static void bounding_box_serialize (BoundingBox * bbox, gint level,
+    GString * string);
 
 static void node_get_children (GNode * node, gpointer data);
 static gpointer node_copy (gconstpointer node, gpointer data);
 static gboolean node_scale_ip (GNode * node, gpointer data);
 static gpointer node_scale (gconstpointer, gpointer data);
-static gboolean node_assign (GNode * node, gpointer data);
-static gboolean node_find (GNode * node, gpointer data);
+static GstInferencePrediction *node_copy_tree (GNode * node, GCopyFunc func,
+    gpointer data);
+static gboolean node_index (GNode * node, gpointer data);
 static gboolean node_get_enabled (GNode * node, gpointer data);
 
 static void compute_factors (GstVideoInfo * from, GstVideoInfo * to,
@@ -87,7 +86,7 @@ get_new_id (void)
 {
   static guint64 _id = G_GUINT64_CONSTANT (0);
   static GMutex _id_mutex;
-  static guint64 ret = 0;
+  guint64 ret = 0;
 
   g_mutex_lock (&_id_mutex);
   ret = _id++;
@@ -107,9 +106,11 @@ gst_inference_prediction_new (void)
       (GstMiniObjectFreeFunction) gst_inference_prediction_free);
 
   g_mutex_init (&self->mutex);
+  g_mutex_init (&self->index_mutex);
 
   self->predictions = NULL;
   self->classifications = NULL;
+  self->index = NULL;
 
   prediction_reset (self);
 
@@ -157,10 +158,41 @@ gst_inference_prediction_append (GstInferencePrediction * self,
   g_return_if_fail (child);
 
   GST_INFERENCE_PREDICTION_LOCK (self);
+  prediction_append_unlocked (self, child);
+  GST_INFERENCE_PREDICTION_UNLOCK (self);
+}
+
+static void
+prediction_append_unlocked (GstInferencePrediction * self,
+    GstInferencePrediction * child)
+{
+  GstInferencePrediction *root = NULL;
+
+  g_return_if_fail (self);
+  g_return_if_fail (child);
+
   GST_INFERENCE_PREDICTION_LOCK (child);
+
   g_node_append (self->predictions, child->predictions);
+
+  /* Keep the index of the tree up to date, the child is not a root
+   * anymore */
+  root = prediction_get_root (self);
+  g_mutex_lock (&root->index_mutex);
+  if (root->index) {
+    g_node_traverse (child->predictions, G_IN_ORDER, G_TRAVERSE_ALL, -1,
+        node_index, root->index);
+  }
+  g_mutex_unlock (&root->index_mutex);
+
+  g_mutex_lock (&child->index_mutex);
+  if (child->index) {
+    g_hash_table_destroy (child->index);
+    child->index = NULL;
+  }
+  g_mutex_unlock (&child->index_mutex);
+
   GST_INFERENCE_PREDICTION_UNLOCK (child);
-  GST_INFERENCE_PREDICTION_UNLOCK (self);
 }
 
 static GstInferenceClassification *
@@ -199,46 +231,54 @@ node_copy (gconstpointer node, gpointer data)
   return prediction_copy (self);
 }
 
-static gboolean
-node_assign (GNode * node, gpointer data)
+/* Copies the tree in a single pass, linking the node every new
+ * prediction already owns instead of allocating a second one */
+static GstInferencePrediction *
+node_copy_tree (GNode * node, GCopyFunc func, gpointer data)
 {
-  GstInferencePrediction *pred = (GstInferencePrediction *) node->data;
+  GstInferencePrediction *other = NULL;
+  GstInferencePrediction *child = NULL;
+  GNode *iter = NULL;
+  GNode *last = NULL;
 
-  g_return_val_if_fail (node, FALSE);
+  g_return_val_if_fail (node, NULL);
+  g_return_val_if_fail (func, NULL);
 
-  pred->predictions = node;
+  other = (GstInferencePrediction *) func (node->data, data);
 
-  return FALSE;
+  for (iter = node->children; iter; iter = iter->next) {
+    child = node_copy_tree (iter, func, data);
+    last = g_node_insert_after (other->predictions, last, child->predictions);
+  }
+
+  return other;
 }
 
 GstInferencePrediction *
 gst_inference_prediction_copy (const GstInferencePrediction * self)
 {
-  GNode *other = NULL;
+  GstInferencePrediction *other = NULL;
 
   g_return_val_if_fail (self, NULL);
 
   GST_INFERENCE_PREDICTION_LOCK ((GstInferencePrediction *) self);
 
-  /* Copy the binary tree */
-  other = g_node_copy_deep (self->predictions, node_copy, NULL);
-
-  /* Now finish assigning the nodes to the predictions */
-  g_node_traverse (other, G_IN_ORDER, G_TRAVERSE_ALL, -1, node_assign, NULL);
+  other = node_copy_tree (self->predictions, node_copy, NULL);
 
   GST_INFERENCE_PREDICTION_UNLOCK ((GstInferencePrediction *) self);
 
-  return (GstInferencePrediction *) other->data;
+  return other;
 }
 
-static gchar *
-bounding_box_to_string (BoundingBox * bbox, gint level)
+static void
+bounding_box_serialize (BoundingBox * bbox, gint level, GString * string)
 {
   gint indent = level * 2;
 
-  g_return_val_if_fail (bbox, NULL);
+  g_return_if_fail (bbox);
+  g_return_if_fail (string);
 
-  return g_strdup_printf ("{\n"
+  g_string_append_printf (string, "{\n"
       "%*s  \"x\" : %d,\n"
       "%*s  \"y\" : %d,\n"
       "%*s  \"width\" : %u,\n"
@@ -249,113 +289,105 @@ bounding_box_to_string (BoundingBox * bbox, gint level)
       indent, "", bbox->width, indent, "", bbox->height, indent, "");
 }
 
-static gchar *
-prediction_children_to_string (GstInferencePrediction * self, gint level)
+static void
+prediction_children_serialize (GstInferencePrediction * self, gint level,
+    GString * string)
 {
-  GSList *subpreds = NULL;
-  GSList *iter = NULL;
-  GString *string = NULL;
-
-  g_return_val_if_fail (self, NULL);
-
-  /* Build the child predictions using a GString */
-  string = g_string_new (NULL);
+  GNode *node = NULL;
 
-  subpreds = prediction_get_children_unlocked (self);
+  g_return_if_fail (self);
+  g_return_if_fail (string);
 
-  for (iter = subpreds; iter != NULL; iter = g_slist_next (iter)) {
-    GstInferencePrediction *pred = (GstInferencePrediction *) iter->data;
-    gchar *child = prediction_to_string (pred, level + 1);
+  if (NULL == self->predictions) {
+    return;
+  }
 
-    if (iter == subpreds) {
-      /* The first element does not need a comma prepended */
-      g_string_append_printf (string, "%s", child);
-    } else {
-      /* Check if more than one element to add list separator */
-      g_string_append_printf (string, ",%s", child);
+  for (node = g_node_first_child (self->predictions); node != NULL;
+      node = g_node_next_sibling (node)) {
+    /* The first element does not need a comma prepended */
+    if (node != g_node_first_child (self->predictions)) {
+      g_string_append_c (string, ',');
     }
 
-    g_free (child);
+    prediction_serialize ((GstInferencePrediction *) node->data, level + 1,
+        string);
   }
-
-  g_slist_free (subpreds);
-
-  return g_string_free (string, FALSE);
 }
 
-static gchar *
-prediction_classes_to_string (GstInferencePrediction * self, gint level)
+static void
+prediction_classes_serialize (GstInferencePrediction * self, gint level,
+    GString * string)
 {
   GList *iter = NULL;
-  GString *string = NULL;
 
-  g_return_val_if_fail (self, NULL);
-
-  /* Build the classes for this predictions using a GString */
-  string = g_string_new (NULL);
+  g_return_if_fail (self);
+  g_return_if_fail (string);
 
   for (iter = self->classifications; iter != NULL; iter = g_list_next (iter)) {
     GstInferenceClassification *c = (GstInferenceClassification *) iter->data;
-    gchar *sclass = gst_inference_classification_to_string (c, level + 1);
 
-    g_string_append_printf (string, "%s ", sclass);
-    g_free (sclass);
+    gst_inference_classification_serialize (c, level + 1, string);
+    g_string_append_c (string, ' ');
   }
-
-  return g_string_free (string, FALSE);
 }
 
-static gchar *
-prediction_to_string (GstInferencePrediction * self, gint level)
+static void
+prediction_serialize (GstInferencePrediction * self, gint level,
+    GString * string)
 {
   gint indent = level * 2;
-  gchar *bbox = NULL;
-  gchar *children = NULL;
-  gchar *classes = NULL;
-  gchar *prediction = NULL;
 
-  g_return_val_if_fail (self, NULL);
-
-  bbox = bounding_box_to_string (&self->bbox, level + 1);
-  classes = prediction_classes_to_string (self, level + 1);
-  children = prediction_children_to_string (self, level + 1);
+  g_return_if_fail (self);
+  g_return_if_fail (string);
 
-  prediction = g_strdup_printf ("{\n"
+  /* Append every piece in place, no intermediate strings are built */
+  g_string_append_printf (string, "{\n"
       "%*s  \"id\" : %" G_GUINT64_FORMAT ",\n"
       "%*s  \"enabled\" : \"%s\",\n"
-      "%*s  \"bbox\" : %s,\n"
+      "%*s  \"bbox\" : ",
+      indent, "", self->prediction_id,
+      indent, "", self->enabled ? "True" : "False", indent, "");
+  bounding_box_serialize (&self->bbox, level + 1, string);
+
+  g_string_append_printf (string, ",\n"
       "%*s  \"classes\" : [\n"
-      "%*s    %s\n"
+      "%*s    ", indent, "", indent, "");
+  prediction_classes_serialize (self, level + 1, string);
+
+  g_string_append_printf (string, "\n"
       "%*s  ],\n"
       "%*s  \"predictions\" : [\n"
-      "%*s    %s\n"
-      "%*s  ]\n"
-      "%*s}",
-      indent, "", self->prediction_id,
-      indent, "", self->enabled ? "True" : "False",
-      indent, "", bbox,
-      indent, "", indent, "", classes, indent, "",
-      indent, "", indent, "", children, indent, "", indent, "");
-
-  g_free (bbox);
-  g_free (children);
-  g_free (classes);
+      "%*s    ", indent, "", indent, "", indent, "");
+  prediction_children_serialize (self, level + 1, string);
 
-  return prediction;
+  g_string_append_printf (string, "\n"
+      "%*s  ]\n"
+      "%*s}", indent, "", indent, "");
 }
 
 gchar *
 gst_inference_prediction_to_string (GstInferencePrediction * self)
 {
-  gchar *serial = NULL;
+  GString *string = NULL;
 
   g_return_val_if_fail (self, NULL);
 
+  string = g_string_new (NULL);
+  gst_inference_prediction_serialize (self, string);
+
+  return g_string_free (string, FALSE);
+}
+
+void
+gst_inference_prediction_serialize (GstInferencePrediction * self,
+    GString * string)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (string);
+
   GST_INFERENCE_PREDICTION_LOCK (self);
-  serial = prediction_to_string (self, 0);
+  prediction_serialize (self, 0, string);
   GST_INFERENCE_PREDICTION_UNLOCK (self);
-
-  return serial;
 }
 
 static void
@@ -443,6 +475,11 @@ prediction_free (GstInferencePrediction * self)
     g_node_destroy (self->predictions);
     self->predictions = NULL;
   }
+
+  if (self->index) {
+    g_hash_table_destroy (self->index);
+    self->index = NULL;
+  }
 }
 
 static void
@@ -453,6 +490,7 @@ gst_inference_prediction_free (GstInferencePrediction * self)
   prediction_free (self);
 
   g_mutex_clear (&self->mutex);
+  g_mutex_clear (&self->index_mutex);
 }
 
 void
@@ -581,7 +619,7 @@ GstInferencePrediction *
 gst_inference_prediction_scale (GstInferencePrediction * self,
     GstVideoInfo * to, GstVideoInfo * from)
 {
-  GNode *other = NULL;
+  GstInferencePrediction *other = NULL;
   PredictionScaleData data = {.from = from,.to = to };
 
   g_return_val_if_fail (self, NULL);
@@ -590,54 +628,77 @@ gst_inference_prediction_scale (GstInferencePrediction * self,
 
   GST_INFERENCE_PREDICTION_LOCK (self);
 
-  other = g_node_copy_deep (self->predictions, node_scale, &data);
-
-  /* Now finish assigning the nodes to the predictions */
-  g_node_traverse (other, G_IN_ORDER, G_TRAVERSE_ALL, -1, node_assign, NULL);
+  other = node_copy_tree (self->predictions, node_scale, &data);
 
   GST_INFERENCE_PREDICTION_UNLOCK (self);
 
-  return (GstInferencePrediction *) other->data;
+  return other;
 }
 
 static gboolean
-prediction_find (GstInferencePrediction * obj, PredictionFindData * found)
+node_index (GNode * node, gpointer data)
 {
-  gboolean ret = FALSE;
+  GstInferencePrediction *current = (GstInferencePrediction *) node->data;
+  GHashTable *index = (GHashTable *) data;
 
-  g_return_val_if_fail (obj, TRUE);
-  g_return_val_if_fail (found, TRUE);
+  g_return_val_if_fail (index, TRUE);
 
-  if (obj->prediction_id == found->prediction_id) {
-    found->prediction = gst_inference_prediction_ref (obj);
-    ret = TRUE;
-  }
+  /* The key lives in the prediction, which the tree keeps alive */
+  g_hash_table_replace (index, &current->prediction_id, current);
 
-  return ret;
+  return FALSE;
 }
 
-static gboolean
-node_find (GNode * node, gpointer data)
+static GstInferencePrediction *
+prediction_get_root (GstInferencePrediction * self)
 {
-  PredictionFindData *found = (PredictionFindData *) data;
-  GstInferencePrediction *current = (GstInferencePrediction *) node->data;
+  g_return_val_if_fail (self, NULL);
 
-  g_return_val_if_fail (found, TRUE);
+  return (GstInferencePrediction *) g_node_get_root (self->predictions)->data;
+}
+
+static GstInferencePrediction *
+prediction_index_lookup (GstInferencePrediction * self, guint64 id)
+{
+  GstInferencePrediction *root = NULL;
+  GstInferencePrediction *found = NULL;
+
+  g_return_val_if_fail (self, NULL);
+
+  root = prediction_get_root (self);
+
+  g_mutex_lock (&root->index_mutex);
+
+  /* Appends keep it up to date from now on */
+  if (NULL == root->index) {
+    root->index = g_hash_table_new (g_int64_hash, g_int64_equal);
+    g_node_traverse (root->predictions, G_IN_ORDER, G_TRAVERSE_ALL, -1,
+        node_index, root->index);
+  }
+
+  found = g_hash_table_lookup (root->index, &id);
 
-  return prediction_find (current, found);
+  g_mutex_unlock (&root->index_mutex);
+
+  return found;
 }
 
 static GstInferencePrediction *
 prediction_find_unlocked (GstInferencePrediction * self, guint64 id)
 {
-  PredictionFindData found = { 0, id };
+  GstInferencePrediction *found = NULL;
 
   g_return_val_if_fail (self, NULL);
 
-  g_node_traverse (self->predictions, G_IN_ORDER, G_TRAVERSE_ALL, -1, node_find,
-      &found);
+  found = prediction_index_lookup (self, id);
+
+  /* The index covers the whole tree, not only the part under self */
+  if (found && found != self
+      && !g_node_is_ancestor (self->predictions, found->predictions)) {
+    found = NULL;
+  }
 
-  return found.prediction;
+  return found ? gst_inference_prediction_ref (found) : NULL;
 }
 
 GstInferencePrediction *
@@ -656,34 +717,37 @@ gst_inference_prediction_find (GstInferencePrediction * self, guint64 id)
   return found;
 }
 
-static gint
-classification_compare (gconstpointer a, gconstpointer b)
-{
-  GstInferenceClassification *ca = (GstInferenceClassification *) a;
-  GstInferenceClassification *cb = (GstInferenceClassification *) b;
-
-  return ca->classification_id == cb->classification_id ? 0 : 1;
-}
-
 static void
 classification_merge (GList * src, GList ** dst)
 {
+  GHashTable *existing = NULL;
+  GList *added = NULL;
   GList *iter = NULL;
+  GstInferenceClassification *c = NULL;
 
   g_return_if_fail (dst);
 
-  /* For each classification in the src, see if it exists in the dst */
+  if (NULL == src) {
+    return;
+  }
+
+  existing = g_hash_table_new (g_int64_hash, g_int64_equal);
+  for (iter = *dst; iter; iter = g_list_next (iter)) {
+    c = (GstInferenceClassification *) iter->data;
+    g_hash_table_add (existing, &c->classification_id);
+  }
+
+  /* Copy every classification of src that is not in dst yet */
   for (iter = src; iter; iter = g_list_next (iter)) {
-    GList *exists =
-        g_list_find_custom (*dst, iter->data, classification_compare);
-
-    /* Copy and append it to the dst if it doesn't exist */
-    if (!exists) {
-      GstInferenceClassification *child =
-          gst_inference_classification_copy (iter->data);
-      *dst = g_list_append (*dst, child);
+    c = (GstInferenceClassification *) iter->data;
+    if (!g_hash_table_contains (existing, &c->classification_id)) {
+      added = g_list_prepend (added, gst_inference_classification_copy (c));
     }
   }
+
+  *dst = g_list_concat (*dst, g_list_reverse (added));
+
+  g_hash_table_destroy (existing);
 }
 
 static gboolean
@@ -706,39 +770,37 @@ prediction_merge (GstInferencePrediction * src, GstInferencePrediction * dst)
   /* Handle 1) here */
   classification_merge (src->classifications, &dst->classifications);
 
-  /* Handle 2) here */
+  /* Handle 2) here, only the immediate children of dst may match */
   for (iter = src_children; iter; iter = g_slist_next (iter)) {
     GstInferencePrediction *current = (GstInferencePrediction *) iter->data;
-
-    /* TODO: Optimize this by only searching the immediate children */
     GstInferencePrediction *found =
-        prediction_find_unlocked (dst, current->prediction_id);
+        prediction_index_lookup (dst, current->prediction_id);
 
     /* No matching prediction, save it to append it later */
-    if (!found) {
-      new_children = g_slist_append (new_children, current);
+    if (!found || found->predictions->parent != dst->predictions) {
+      new_children = g_slist_prepend (new_children, current);
       continue;
     }
 
     /* Recurse into the children */
     new_added = prediction_merge (current, found);
-
-    gst_inference_prediction_unref (found);
   }
+  new_children = g_slist_reverse (new_children);
 
   /* Finally append all the new children to dst. Do it after all
      children have been processed */
   for (iter = new_children; iter; iter = g_slist_next (iter)) {
     GstInferencePrediction *prediction =
         gst_inference_prediction_copy ((GstInferencePrediction *) iter->data);
-    gst_inference_prediction_append (dst, prediction);
+    /* dst is already locked */
+    prediction_append_unlocked (dst, prediction);
   }
 
   new_added |= new_children ? TRUE : FALSE;
 
+  /* Both lists borrow the predictions, the trees keep the references */
   g_slist_free (src_children);
-  g_slist_free_full (new_children,
-      (GDestroyNotify) gst_inference_prediction_unref);
+  g_slist_free (new_children);
 
   return new_added;
 }
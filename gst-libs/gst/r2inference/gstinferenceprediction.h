@@ -51,7 +51,8 @@ struct _BoundingBox
 
 /**
  * GstInferencePrediction:
- * @prediction_id: unique id for this specific prediction
+ * @prediction_id: unique id for this specific prediction. It must not
+ * change once the prediction is part of a tree that has been searched.
  * @enabled: flag indicating wether or not this prediction should be
  * used for further inference
  * @bbox: the BoundingBox for this specific prediction
@@ -76,6 +77,13 @@ struct _GstInferencePrediction
   BoundingBox bbox;
   GList * classifications;
   GNode * predictions;
+
+  /*<private>*/
+  /* Id to prediction of the whole tree, only kept by the root and
+   * built on the first lookup. Predictions anywhere in the tree use
+   * it, so it has its own lock, never held while taking another */
+  GHashTable * index;
+  GMutex index_mutex;
 };
 
 /**
@@ -153,6 +161,17 @@ void gst_inference_prediction_unref (GstInferencePrediction * self);
  */
 gchar * gst_inference_prediction_to_string (GstInferencePrediction * self);
 
+/**
+ * gst_inference_prediction_serialize:
+ * @self: the prediction to serialize
+ * @string: the string to append the serialization to
+ *
+ * Appends the same serialization as gst_inference_prediction_to_string()
+ * to @string. Reusing the string for every frame avoids growing a new
+ * one each time.
+ */
+void gst_inference_prediction_serialize (GstInferencePrediction * self, GString * string);
+
 /**
  * gst_inference_prediction_append:
  * @self: the parent prediction
@@ -222,8 +241,9 @@ void gst_inference_prediction_scale_ip (GstInferencePrediction * self,
  * @self: the root prediction
  * @id: the prediction_id of the prediction to return
  *
- * Traverses the prediction tree looking for a child with the given
- * id.
+ * Looks for a prediction with the given id in the tree under @self,
+ * @self included. The first lookup indexes the whole tree, the next
+ * ones take constant time.
  *
  * Returns: a reference to the prediction with id or NULL if not
  * found. Unref after usage.
@@ -21,36 +21,422 @@
 
 #define _USE_MATH_DEFINES
 #include "gstinferencepreprocess.h"
+#include "gstinferencepreprocesskernels.h"
 #include <math.h>
 
+/* Downscales of at least this factor average whole source areas instead
+ * of interpolating between the 2 nearest pixels, to avoid aliasing */
+#define AREA_DOWNSCALE_FACTOR 2
+
+/* Source sampling of one output coordinate along one axis. For bilinear
+ * sampling first and last are the 2 nearest source offsets and weight
+ * the contribution of last. For area sampling they delimit the averaged
+ * range [first, last) and weight is unused.
+ */
+typedef struct _FusedTap FusedTap;
+struct _FusedTap
+{
+  gint first;
+  gint last;
+  gfloat weight;
+};
+
+/* Rows of one plane of the sampled region. For bilinear sampling the 2
+ * source rows of every output row are blended once into blended, which
+ * then serves all the components stored in the plane.
+ */
+typedef struct _FusedPlane FusedPlane;
+struct _FusedPlane
+{
+  const guint8 *data;
+  gint stride;
+  gint span;
+  FusedTap *rows;
+  gfloat *blended;
+};
+
+/* One color component of the input frame */
+typedef struct _FusedComponent FusedComponent;
+struct _FusedComponent
+{
+  FusedPlane *plane;
+  gint index;
+  gint offset;
+  gint pstride;
+  gint width;
+  gint height;
+  FusedTap *columns;
+};
+
+/* Sampling state shared by every region of an input frame */
+typedef struct _FusedSampler FusedSampler;
+struct _FusedSampler
+{
+  GstVideoFrame *frame;
+  FusedPlane planes[GST_VIDEO_MAX_PLANES];
+  FusedComponent comps[3];
+  FusedTap *taps;
+  gfloat *blended;
+  gint out_width;
+  gint out_height;
+  GstInferenceBlendRowFunc blend_row;
+  /* YUV to RGB conversion */
+  gboolean yuv;
+  gfloat yoff, yscale, rv, gu, gv, bu;
+};
+
 static gboolean gst_configure_format_values (GstVideoFrame * inframe,
     gint * first_index, gint * last_index, gint * offset, gint * channels);
-static void gst_apply_means_std (GstVideoFrame * inframe,
+static gboolean gst_apply_means_std (GstVideoFrame * inframe,
     GstVideoFrame * outframe, gint first_index, gint last_index,
     gint offset, gint channels, const gdouble mean_red,
     const gdouble mean_green, const gdouble mean_blue,
     const gdouble std_r, const gdouble std_g, const gdouble std_b,
     const gint model_channels);
+static gboolean gst_needs_fused_preprocess (GstVideoFrame * inframe,
+    GstVideoFrame * outframe);
+static gboolean gst_apply_fused_means_std (GstVideoFrame * inframe,
+    GstVideoFrame * outframe, const gdouble mean[3], const gdouble std[3],
+    const gint model_channels);
+static void gst_fused_compute_taps (FusedTap * taps, gint in_size,
+    gint out_size, gint pstride, gboolean area);
+static void gst_fused_sampler_init (FusedSampler * sampler,
+    GstVideoFrame * inframe, gint out_width, gint out_height);
+static void gst_fused_sampler_clear (FusedSampler * sampler);
+static void gst_fused_sample_region (FusedSampler * sampler,
+    const BoundingBox * region, const gdouble mean[3], const gdouble std[3],
+    gfloat * out);
 
 static void gst_apply_gray_normalization (GstVideoFrame * inframe,
     GstVideoFrame * outframe, gdouble std, gdouble offset);
 
+static gboolean
+gst_needs_fused_preprocess (GstVideoFrame * inframe, GstVideoFrame * outframe)
+{
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (outframe != NULL, FALSE);
+
+  return GST_VIDEO_INFO_IS_YUV (&inframe->info)
+      || GST_VIDEO_FRAME_WIDTH (inframe) != GST_VIDEO_FRAME_WIDTH (outframe)
+      || GST_VIDEO_FRAME_HEIGHT (inframe) != GST_VIDEO_FRAME_HEIGHT (outframe);
+}
+
+static void
+gst_fused_compute_taps (FusedTap * taps, gint in_size, gint out_size,
+    gint pstride, gboolean area)
+{
+  gint i;
+  gdouble scale, center;
+
+  g_return_if_fail (taps != NULL);
+  g_return_if_fail (in_size > 0);
+  g_return_if_fail (out_size > 0);
+
+  scale = (gdouble) in_size / out_size;
+
+  for (i = 0; i < out_size; ++i) {
+    if (area) {
+      taps[i].first = (gint) (i * scale);
+      taps[i].last = MAX ((gint) ((i + 1) * scale), taps[i].first + 1);
+      taps[i].last = MIN (taps[i].last, in_size);
+      taps[i].weight = 0;
+    } else {
+      /* Align pixel centers */
+      center = (i + 0.5) * scale - 0.5;
+      center = CLAMP (center, 0, in_size - 1);
+      taps[i].first = (gint) center;
+      taps[i].last = MIN (taps[i].first + 1, in_size - 1);
+      taps[i].weight = (gfloat) (center - taps[i].first);
+    }
+    taps[i].first *= pstride;
+    taps[i].last *= pstride;
+  }
+}
+
 static void
+gst_fused_sampler_init (FusedSampler * sampler, GstVideoFrame * inframe,
+    gint out_width, gint out_height)
+{
+  const GstVideoFormatInfo *finfo;
+  gdouble kr = 0.299, kb = 0.114, kg, cscale = 1;
+  gint n_comps, n_planes, max_stride, c, k, p;
+
+  g_return_if_fail (sampler != NULL);
+  g_return_if_fail (inframe != NULL);
+
+  finfo = inframe->info.finfo;
+  n_comps = MIN (GST_VIDEO_FRAME_N_COMPONENTS (inframe), 3);
+  n_planes = GST_VIDEO_FRAME_N_PLANES (inframe);
+
+  sampler->frame = inframe;
+  sampler->out_width = out_width;
+  sampler->out_height = out_height;
+  sampler->blend_row = gst_inference_blend_get_row_func ();
+
+  max_stride = 0;
+  for (p = 0; p < n_planes; ++p) {
+    max_stride = MAX (max_stride, GST_VIDEO_FRAME_PLANE_STRIDE (inframe, p));
+  }
+
+  sampler->taps = g_new (FusedTap, 3 * out_width + n_planes * out_height);
+  sampler->blended = g_new (gfloat, n_planes * max_stride);
+
+  for (p = 0; p < n_planes; ++p) {
+    sampler->planes[p].stride = GST_VIDEO_FRAME_PLANE_STRIDE (inframe, p);
+    sampler->planes[p].rows = sampler->taps + 3 * out_width + p * out_height;
+    sampler->planes[p].blended = sampler->blended + p * max_stride;
+  }
+
+  for (c = 0; c < 3; ++c) {
+    /* Gray frames replicate their only component */
+    k = c < n_comps ? c : 0;
+    sampler->comps[c].index = k;
+    sampler->comps[c].plane =
+        &sampler->planes[GST_VIDEO_FORMAT_INFO_PLANE (finfo, k)];
+    sampler->comps[c].offset = GST_VIDEO_FORMAT_INFO_POFFSET (finfo, k);
+    sampler->comps[c].pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (inframe, k);
+    sampler->comps[c].columns = sampler->taps + c * out_width;
+  }
+
+  sampler->yuv = GST_VIDEO_INFO_IS_YUV (&inframe->info);
+  sampler->yoff = 0;
+  sampler->yscale = 1;
+
+  if (sampler->yuv) {
+    /* Falls back to BT.601 for unknown matrices */
+    gst_video_color_matrix_get_Kr_Kb (inframe->info.colorimetry.matrix, &kr,
+        &kb);
+    kg = 1.0 - kr - kb;
+
+    if (GST_VIDEO_COLOR_RANGE_16_235 == inframe->info.colorimetry.range) {
+      sampler->yoff = 16;
+      sampler->yscale = (gfloat) (255.0 / 219.0);
+      cscale = 255.0 / 224.0;
+    }
+
+    sampler->rv = (gfloat) (2 * (1 - kr) * cscale);
+    sampler->gu = (gfloat) (-2 * kb * (1 - kb) / kg * cscale);
+    sampler->gv = (gfloat) (-2 * kr * (1 - kr) / kg * cscale);
+    sampler->bu = (gfloat) (2 * (1 - kb) * cscale);
+  }
+}
+
+static void
+gst_fused_sampler_clear (FusedSampler * sampler)
+{
+  g_return_if_fail (sampler != NULL);
+
+  g_free (sampler->taps);
+  g_free (sampler->blended);
+  sampler->taps = NULL;
+  sampler->blended = NULL;
+}
+
+/* Converts, resizes and normalizes a region of the input in a single
+ * pass, so YUV frames at their native resolution can be fed to the
+ * model without an intermediate RGB frame.
+ */
+static void
+gst_fused_sample_region (FusedSampler * sampler, const BoundingBox * region,
+    const gdouble mean[3], const gdouble std[3], gfloat * out)
+{
+  GstVideoFrame *frame;
+  const GstVideoFormatInfo *finfo;
+  FusedComponent *comp;
+  FusedPlane *plane;
+  const FusedTap *col, *rowtap;
+  const guint8 *row;
+  const gfloat *blended;
+  gfloat values[3], sum, y, u, v;
+  gint out_width, out_height, n_planes, xalign, yalign;
+  gint x0, y0, x1, y1, width, height, wsub, hsub, c, i, j, k, l;
+  gboolean area;
+
+  g_return_if_fail (sampler != NULL);
+  g_return_if_fail (region != NULL);
+  g_return_if_fail (out != NULL);
+
+  frame = sampler->frame;
+  finfo = frame->info.finfo;
+  out_width = sampler->out_width;
+  out_height = sampler->out_height;
+  n_planes = GST_VIDEO_FRAME_N_PLANES (frame);
+
+  /* Clamp the region to the frame and align it to the chroma
+   * subsampling, every plane must start on a whole sample
+   */
+  xalign = yalign = 1;
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (frame); ++c) {
+    xalign = MAX (xalign, 1 << GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c));
+    yalign = MAX (yalign, 1 << GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c));
+  }
+
+  x0 = CLAMP (region->x, 0, GST_VIDEO_FRAME_WIDTH (frame) - 1);
+  y0 = CLAMP (region->y, 0, GST_VIDEO_FRAME_HEIGHT (frame) - 1);
+  x1 = CLAMP (region->x + (gint) region->width, x0 + 1,
+      GST_VIDEO_FRAME_WIDTH (frame));
+  y1 = CLAMP (region->y + (gint) region->height, y0 + 1,
+      GST_VIDEO_FRAME_HEIGHT (frame));
+  x0 -= x0 % xalign;
+  y0 -= y0 % yalign;
+  width = x1 - x0;
+  height = y1 - y0;
+
+  area = width >= AREA_DOWNSCALE_FACTOR * out_width
+      && height >= AREA_DOWNSCALE_FACTOR * out_height;
+
+  for (k = 0; k < n_planes; ++k) {
+    sampler->planes[k].data = NULL;
+    sampler->planes[k].span = 0;
+  }
+
+  for (c = 0; c < 3; ++c) {
+    comp = &sampler->comps[c];
+    plane = comp->plane;
+    wsub = GST_VIDEO_FORMAT_INFO_W_SUB (finfo, comp->index);
+    hsub = GST_VIDEO_FORMAT_INFO_H_SUB (finfo, comp->index);
+
+    comp->width = GST_VIDEO_SUB_SCALE (wsub, width);
+    comp->height = GST_VIDEO_SUB_SCALE (hsub, height);
+    gst_fused_compute_taps (comp->columns, comp->width, out_width,
+        comp->pstride, area);
+
+    /* The first component found places the plane on the region, the
+     * components sharing a plane share the subsampling of its rows
+     */
+    if (NULL == plane->data) {
+      k = plane - sampler->planes;
+      plane->data = (const guint8 *) frame->data[k] +
+          GST_VIDEO_SUB_SCALE (hsub, y0) * plane->stride +
+          GST_VIDEO_SUB_SCALE (wsub, x0) * comp->pstride;
+      gst_fused_compute_taps (plane->rows, comp->height, out_height, 1,
+          area);
+    }
+    plane->span = MAX (plane->span,
+        comp->offset + (comp->width - 1) * comp->pstride + 1);
+  }
+
+  for (i = 0; i < out_height; ++i) {
+    if (!area) {
+      for (k = 0; k < n_planes; ++k) {
+        plane = &sampler->planes[k];
+        if (NULL == plane->data) {
+          continue;
+        }
+        rowtap = &plane->rows[i];
+        sampler->blend_row (plane->data + rowtap->first * plane->stride,
+            plane->data + rowtap->last * plane->stride, rowtap->weight,
+            plane->blended, plane->span);
+      }
+    }
+
+    for (j = 0; j < out_width; ++j) {
+      for (c = 0; c < 3; ++c) {
+        comp = &sampler->comps[c];
+        col = &comp->columns[j];
+
+        if (area) {
+          rowtap = &comp->plane->rows[i];
+          sum = 0;
+          for (k = rowtap->first; k < rowtap->last; ++k) {
+            row = comp->plane->data + k * comp->plane->stride + comp->offset;
+            for (l = col->first; l < col->last; l += comp->pstride) {
+              sum += row[l];
+            }
+          }
+          values[c] = sum / ((rowtap->last - rowtap->first) *
+              ((col->last - col->first) / comp->pstride));
+        } else {
+          blended = comp->plane->blended + comp->offset;
+          values[c] = blended[col->first] +
+              (blended[col->last] - blended[col->first]) * col->weight;
+        }
+      }
+
+      if (sampler->yuv) {
+        y = (values[0] - sampler->yoff) * sampler->yscale;
+        u = values[1] - 128;
+        v = values[2] - 128;
+        values[0] = CLAMP (y + sampler->rv * v, 0, 255);
+        values[1] = CLAMP (y + sampler->gu * u + sampler->gv * v, 0, 255);
+        values[2] = CLAMP (y + sampler->bu * u, 0, 255);
+      }
+
+      out[j * 3 + 0] = (values[0] - mean[0]) * std[0];
+      out[j * 3 + 1] = (values[1] - mean[1]) * std[1];
+      out[j * 3 + 2] = (values[2] - mean[2]) * std[2];
+    }
+
+    out += out_width * 3;
+  }
+}
+
+static gboolean
+gst_apply_fused_means_std (GstVideoFrame * inframe, GstVideoFrame * outframe,
+    const gdouble mean[3], const gdouble std[3], const gint model_channels)
+{
+  FusedSampler sampler;
+  BoundingBox region = { 0, 0, 0, 0 };
+
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (outframe != NULL, FALSE);
+
+  if (3 != model_channels) {
+    GST_ERROR ("Fused preprocess only supports 3 channel models");
+    return FALSE;
+  }
+
+  region.width = GST_VIDEO_FRAME_WIDTH (inframe);
+  region.height = GST_VIDEO_FRAME_HEIGHT (inframe);
+
+  gst_fused_sampler_init (&sampler, inframe,
+      GST_VIDEO_FRAME_WIDTH (outframe), GST_VIDEO_FRAME_HEIGHT (outframe));
+  gst_fused_sample_region (&sampler, &region, mean, std,
+      (gfloat *) outframe->data[0]);
+  gst_fused_sampler_clear (&sampler);
+
+  return TRUE;
+}
+
+static gboolean
 gst_apply_means_std (GstVideoFrame * inframe, GstVideoFrame * outframe,
     gint first_index, gint last_index, gint offset, gint channels,
     const gdouble mean_red, const gdouble mean_green,
     const gdouble mean_blue, const gdouble std_r, const gdouble std_g,
     const gdouble std_b, const gint model_channels)
 {
-  gint i, j, pixel_stride, width, height;
+  gint i, j, pixel_stride, width, height, stride;
+  GstInferenceNormalizeParams params;
+  GstInferenceNormalizeRowFunc normalize_row;
+  const gdouble mean[3] = { mean_red, mean_green, mean_blue };
+  const gdouble std[3] = { std_r, std_g, std_b };
 
-  g_return_if_fail (inframe != NULL);
-  g_return_if_fail (outframe != NULL);
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (outframe != NULL, FALSE);
+
+  if (gst_needs_fused_preprocess (inframe, outframe)) {
+    return gst_apply_fused_means_std (inframe, outframe, mean, std,
+        model_channels);
+  }
 
   pixel_stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0) / channels;
   width = GST_VIDEO_FRAME_WIDTH (inframe);
   height = GST_VIDEO_FRAME_HEIGHT (inframe);
 
+  /* Packed 3 channel tensors go through the SIMD row kernels */
+  if (3 == model_channels) {
+    stride = GST_VIDEO_FRAME_COMP_STRIDE (inframe, 0);
+    gst_inference_normalize_params_init (&params, channels, offset,
+        first_index, last_index, mean, std);
+    normalize_row = gst_inference_normalize_get_row_func ();
+
+    for (i = 0; i < height; ++i) {
+      normalize_row (&params, (guchar *) inframe->data[0] + i * stride,
+          (gfloat *) outframe->data[0] + i * width * 3, width);
+    }
+    return TRUE;
+  }
+
   for (i = 0; i < height; ++i) {
     for (j = 0; j < width; ++j) {
       ((gfloat *) outframe->data[0])[(i * width + j) * model_channels +
@@ -66,6 +452,8 @@ gst_apply_means_std (GstVideoFrame * inframe, GstVideoFrame * outframe,
               2 + offset] - mean_blue) * std_b;
     }
   }
+
+  return TRUE;
 }
 
 static gboolean
@@ -111,6 +499,14 @@ gst_configure_format_values (GstVideoFrame * inframe, gint * first_index,
       *last_index = 0;
       *offset = 0;
       break;
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YUY2:
+      /* Converted to RGB by the fused preprocess */
+      *first_index = 0;
+      *last_index = 2;
+      *offset = 0;
+      break;
     default:
       return FALSE;
       break;
@@ -130,10 +526,8 @@ gst_normalize (GstVideoFrame * inframe, GstVideoFrame * outframe, gdouble mean,
     return FALSE;
   }
 
-  gst_apply_means_std (inframe, outframe, first_index, last_index, offset,
-      channels, mean, mean, mean, std, std, std, model_channels);
-
-  return TRUE;
+  return gst_apply_means_std (inframe, outframe, first_index, last_index,
+      offset, channels, mean, mean, mean, std, std, std, model_channels);
 }
 
 gboolean
@@ -150,9 +544,9 @@ gst_subtract_mean (GstVideoFrame * inframe, GstVideoFrame * outframe,
     return FALSE;
   }
 
-  gst_apply_means_std (inframe, outframe, first_index, last_index, offset,
-      channels, mean_red, mean_green, mean_blue, std, std, std, model_channels);
-  return TRUE;
+  return gst_apply_means_std (inframe, outframe, first_index, last_index,
+      offset, channels, mean_red, mean_green, mean_blue, std, std, std,
+      model_channels);
 }
 
 gboolean
@@ -168,8 +562,40 @@ gst_pixel_to_float (GstVideoFrame * inframe, GstVideoFrame * outframe,
     return FALSE;
   }
 
-  gst_apply_means_std (inframe, outframe, first_index, last_index, offset,
-      channels, mean, mean, mean, std, std, std, model_channels);
+  return gst_apply_means_std (inframe, outframe, first_index, last_index,
+      offset, channels, mean, mean, mean, std, std, std, model_channels);
+}
+
+gboolean
+gst_normalize_rois (GstVideoFrame * inframe, const BoundingBox * rois,
+    guint num_rois, gfloat * tensors, gint width, gint height,
+    const gdouble mean[3], const gdouble std[3])
+{
+  FusedSampler sampler;
+  gint first_index = 0, last_index = 0, offset = 0, channels = 0;
+  guint i;
+
+  g_return_val_if_fail (inframe != NULL, FALSE);
+  g_return_val_if_fail (rois != NULL || 0 == num_rois, FALSE);
+  g_return_val_if_fail (tensors != NULL || 0 == num_rois, FALSE);
+  g_return_val_if_fail (width > 0, FALSE);
+  g_return_val_if_fail (height > 0, FALSE);
+  g_return_val_if_fail (mean != NULL, FALSE);
+  g_return_val_if_fail (std != NULL, FALSE);
+
+  if (gst_configure_format_values (inframe, &first_index, &last_index, &offset,
+          &channels) == FALSE) {
+    return FALSE;
+  }
+
+  /* Taps and blended rows are allocated once for all the regions */
+  gst_fused_sampler_init (&sampler, inframe, width, height);
+  for (i = 0; i < num_rois; ++i) {
+    gst_fused_sample_region (&sampler, &rois[i], mean, std,
+        tensors + (gsize) i * width * height * 3);
+  }
+  gst_fused_sampler_clear (&sampler);
+
   return TRUE;
 }
 
@@ -23,9 +23,17 @@
 #define __GST_INFERENCE_PREPROCESS_H__
 
 #include <gst/video/video.h>
+#include <gst/r2inference/gstinferenceprediction.h>
 
 G_BEGIN_DECLS
 
+/*
+ * The functions below accept NV12, I420 and YUY2 input, as well as
+ * input whose size differs from the output frame. In that case color
+ * conversion, resizing and normalization are done in a single pass
+ * straight into the RGB float output.
+ */
+
 /**
  * \brief Normalization with values between 0 and 1
  *
@@ -73,6 +81,25 @@ gboolean gst_pixel_to_float(GstVideoFrame * inframe, GstVideoFrame * outframe, g
 gboolean
 gst_normalize_gray_image (GstVideoFrame * inframe, GstVideoFrame * outframe,
     gdouble mean, gint offset, gint model_channels);
+
+/**
+ * \brief Crop, resize and normalize several regions of a frame in one
+ * pass, without intermediate RGB crops. Every region produces a packed
+ * RGB float tensor, laid out one after the other.
+ *
+ * \param inframe The input frame
+ * \param rois The regions to process, clamped to the input frame
+ * \param num_rois The number of regions
+ * \param tensors The output, room for num_rois * width * height * 3 floats
+ * \param width The width of every output tensor
+ * \param height The height of every output tensor
+ * \param mean The mean of the red, green and blue channels
+ * \param std The scale of the red, green and blue channels
+ */
+gboolean
+gst_normalize_rois (GstVideoFrame * inframe, const BoundingBox * rois,
+    guint num_rois, gfloat * tensors, gint width, gint height,
+    const gdouble mean[3], const gdouble std[3]);
 G_END_DECLS
 
 #endif
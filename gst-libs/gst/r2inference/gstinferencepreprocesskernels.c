@@ -0,0 +1,625 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencepreprocesskernels.h"
+
+#if defined(GST_INFERENCE_HAVE_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(GST_INFERENCE_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/* All the kernels below compute (pixel - mean) * std in double precision
+ * and round the result to float once, exactly like the scalar reference,
+ * so every implementation produces bit-identical tensors.
+ */
+
+static void gst_inference_normalize_row_c (const GstInferenceNormalizeParams *
+    params, const guint8 * in, gfloat * out, gint width);
+static void gst_inference_normalize_row_tail (const GstInferenceNormalizeParams
+    * params, const guint8 * in, gfloat * out, gint start, gint width);
+static GstInferenceNormalizeRowFunc gst_inference_normalize_select (void);
+static void gst_inference_blend_row_c (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint width);
+static void gst_inference_blend_row_tail (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint start,
+    gint width);
+static GstInferenceBlendRowFunc gst_inference_blend_select (void);
+
+static void
+gst_inference_normalize_row_tail (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint start, gint width)
+{
+  gint j;
+  const gint channels = params->channels;
+  const guint8 *src;
+  gfloat *dst;
+
+  for (j = start; j < width; ++j) {
+    src = in + j * channels + params->offset;
+    dst = out + j * 3;
+
+    dst[0] = (src[params->map[0]] - params->mean[0]) * params->std[0];
+    dst[1] = (src[params->map[1]] - params->mean[1]) * params->std[1];
+    dst[2] = (src[params->map[2]] - params->mean[2]) * params->std[2];
+  }
+}
+
+static void
+gst_inference_normalize_row_c (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint width)
+{
+  gst_inference_normalize_row_tail (params, in, out, 0, width);
+}
+
+static void
+gst_inference_blend_row_tail (const guint8 * top, const guint8 * bottom,
+    gfloat weight, gfloat * out, gint start, gint width)
+{
+  gint j;
+
+  for (j = start; j < width; ++j) {
+    out[j] = top[j] + (gfloat) (bottom[j] - top[j]) * weight;
+  }
+}
+
+static void
+gst_inference_blend_row_c (const guint8 * top, const guint8 * bottom,
+    gfloat weight, gfloat * out, gint width)
+{
+  gst_inference_blend_row_tail (top, bottom, weight, out, 0, width);
+}
+
+#if defined(GST_INFERENCE_HAVE_X86)
+
+static gboolean gst_inference_cpu_supports (GstInferenceKernelImpl impl);
+static void gst_inference_normalize_row_sse41 (const GstInferenceNormalizeParams
+    * params, const guint8 * in, gfloat * out, gint width);
+static void gst_inference_normalize_row_avx2 (const GstInferenceNormalizeParams
+    * params, const guint8 * in, gfloat * out, gint width);
+static void gst_inference_normalize_row_avx512 (const
+    GstInferenceNormalizeParams * params, const guint8 * in, gfloat * out,
+    gint width);
+static void gst_inference_blend_row_sse41 (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint width);
+static void gst_inference_blend_row_avx2 (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint width);
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static gboolean
+gst_inference_cpu_supports (GstInferenceKernelImpl impl)
+{
+  int info[4];
+  int max_leaf;
+  gboolean osxsave, avx_os, avx512_os;
+  guint64 xcr0 = 0;
+
+  __cpuid (info, 0);
+  max_leaf = info[0];
+
+  __cpuid (info, 1);
+  if (GST_INFERENCE_KERNEL_SSE41 == impl) {
+    return (info[2] & (1 << 19)) != 0;
+  }
+
+  if (max_leaf < 7) {
+    return FALSE;
+  }
+
+  osxsave = (info[2] & (1 << 27)) != 0;
+  if (osxsave) {
+    xcr0 = _xgetbv (0);
+  }
+  /* The OS must save the YMM (and ZMM) state on context switches */
+  avx_os = osxsave && (xcr0 & 0x6) == 0x6;
+  avx512_os = osxsave && (xcr0 & 0xe6) == 0xe6;
+
+  __cpuidex (info, 7, 0);
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_AVX2:
+      return avx_os && (info[1] & (1 << 5)) != 0;
+    case GST_INFERENCE_KERNEL_AVX512:
+      return avx512_os && (info[1] & (1 << 5)) != 0
+          && (info[1] & (1 << 16)) != 0;
+    default:
+      return FALSE;
+  }
+}
+#else
+static gboolean
+gst_inference_cpu_supports (GstInferenceKernelImpl impl)
+{
+  __builtin_cpu_init ();
+
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_SSE41:
+      return __builtin_cpu_supports ("sse4.1");
+    case GST_INFERENCE_KERNEL_AVX2:
+      return __builtin_cpu_supports ("avx2");
+    case GST_INFERENCE_KERNEL_AVX512:
+      return __builtin_cpu_supports ("avx2")
+          && __builtin_cpu_supports ("avx512f");
+    default:
+      return FALSE;
+  }
+}
+#endif
+
+GST_INFERENCE_TARGET ("sse4.1")
+static void
+gst_inference_normalize_row_sse41 (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint width)
+{
+  const gint channels = params->channels;
+  const gint last = width * channels - 16;
+  __m128i shuffle, px, ints;
+  __m128d mean[6], std[6], lo, hi;
+  gint i, j;
+
+  shuffle = _mm_loadu_si128 ((const __m128i *) params->shuffle);
+  for (i = 0; i < 6; ++i) {
+    mean[i] = _mm_loadu_pd (params->mean + 2 * i);
+    std[i] = _mm_loadu_pd (params->std + 2 * i);
+  }
+
+  /* 4 pixels per iteration, 12 output elements */
+  for (j = 0; j * channels <= last; j += 4) {
+    px = _mm_loadu_si128 ((const __m128i *) (in + j * channels));
+    px = _mm_shuffle_epi8 (px, shuffle);
+
+    for (i = 0; i < 3; ++i) {
+      ints = _mm_cvtepu8_epi32 (px);
+      lo = _mm_cvtepi32_pd (ints);
+      hi = _mm_cvtepi32_pd (_mm_unpackhi_epi64 (ints, ints));
+      lo = _mm_mul_pd (_mm_sub_pd (lo, mean[2 * i]), std[2 * i]);
+      hi = _mm_mul_pd (_mm_sub_pd (hi, mean[2 * i + 1]), std[2 * i + 1]);
+      _mm_storeu_ps (out + j * 3 + 4 * i, _mm_movelh_ps (_mm_cvtpd_ps (lo),
+              _mm_cvtpd_ps (hi)));
+      px = _mm_srli_si128 (px, 4);
+    }
+  }
+
+  gst_inference_normalize_row_tail (params, in, out, j, width);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static void
+gst_inference_normalize_row_avx2 (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint width)
+{
+  const gint channels = params->channels;
+  const gint last = width * channels - 16;
+  __m128i shuffle, px;
+  __m256d mean[3], std[3], values;
+  gint i, j;
+
+  shuffle = _mm_loadu_si128 ((const __m128i *) params->shuffle);
+  for (i = 0; i < 3; ++i) {
+    mean[i] = _mm256_loadu_pd (params->mean + 4 * i);
+    std[i] = _mm256_loadu_pd (params->std + 4 * i);
+  }
+
+  /* 4 pixels per iteration, 12 output elements */
+  for (j = 0; j * channels <= last; j += 4) {
+    px = _mm_loadu_si128 ((const __m128i *) (in + j * channels));
+    px = _mm_shuffle_epi8 (px, shuffle);
+
+    for (i = 0; i < 3; ++i) {
+      values = _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (px));
+      values = _mm256_mul_pd (_mm256_sub_pd (values, mean[i]), std[i]);
+      _mm_storeu_ps (out + j * 3 + 4 * i, _mm256_cvtpd_ps (values));
+      px = _mm_srli_si128 (px, 4);
+    }
+  }
+
+  gst_inference_normalize_row_tail (params, in, out, j, width);
+}
+
+GST_INFERENCE_TARGET ("avx512f,avx2")
+static void
+gst_inference_normalize_row_avx512 (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint width)
+{
+  const gint channels = params->channels;
+  const gint last = width * channels - 16 - 4 * channels;
+  __m128i shuffle, px0, px1, groups[3];
+  __m512d mean[3], std[3], values;
+  gint i, j;
+
+  shuffle = _mm_loadu_si128 ((const __m128i *) params->shuffle);
+  for (i = 0; i < 3; ++i) {
+    mean[i] = _mm512_loadu_pd (params->mean + 8 * i);
+    std[i] = _mm512_loadu_pd (params->std + 8 * i);
+  }
+
+  /* 8 pixels per iteration, 24 output elements */
+  for (j = 0; j * channels <= last; j += 8) {
+    px0 = _mm_loadu_si128 ((const __m128i *) (in + j * channels));
+    px1 = _mm_loadu_si128 ((const __m128i *) (in + (j + 4) * channels));
+    px0 = _mm_shuffle_epi8 (px0, shuffle);
+    px1 = _mm_shuffle_epi8 (px1, shuffle);
+
+    /* Regroup the 2 x 12 gathered bytes into 3 x 8 */
+    groups[0] = px0;
+    groups[1] = _mm_unpacklo_epi32 (_mm_srli_si128 (px0, 8), px1);
+    groups[2] = _mm_srli_si128 (px1, 4);
+
+    for (i = 0; i < 3; ++i) {
+      values = _mm512_cvtepi32_pd (_mm256_cvtepu8_epi32 (groups[i]));
+      values = _mm512_mul_pd (_mm512_sub_pd (values, mean[i]), std[i]);
+      _mm256_storeu_ps (out + j * 3 + 8 * i, _mm512_cvtpd_ps (values));
+    }
+  }
+
+  gst_inference_normalize_row_tail (params, in, out, j, width);
+}
+
+GST_INFERENCE_TARGET ("sse4.1")
+static void
+gst_inference_blend_row_sse41 (const guint8 * top, const guint8 * bottom,
+    gfloat weight, gfloat * out, gint width)
+{
+  const __m128 w = _mm_set1_ps (weight);
+  __m128i t, b;
+  __m128 ft, fb;
+  gint i, j;
+
+  /* 16 bytes per iteration, 4 at a time */
+  for (j = 0; j + 16 <= width; j += 16) {
+    t = _mm_loadu_si128 ((const __m128i *) (top + j));
+    b = _mm_loadu_si128 ((const __m128i *) (bottom + j));
+
+    for (i = 0; i < 4; ++i) {
+      ft = _mm_cvtepi32_ps (_mm_cvtepu8_epi32 (t));
+      fb = _mm_cvtepi32_ps (_mm_cvtepu8_epi32 (b));
+      _mm_storeu_ps (out + j + 4 * i, _mm_add_ps (ft,
+              _mm_mul_ps (_mm_sub_ps (fb, ft), w)));
+      t = _mm_srli_si128 (t, 4);
+      b = _mm_srli_si128 (b, 4);
+    }
+  }
+
+  gst_inference_blend_row_tail (top, bottom, weight, out, j, width);
+}
+
+GST_INFERENCE_TARGET ("avx2")
+static void
+gst_inference_blend_row_avx2 (const guint8 * top, const guint8 * bottom,
+    gfloat weight, gfloat * out, gint width)
+{
+  const __m256 w = _mm256_set1_ps (weight);
+  __m128i t, b;
+  __m256 ft, fb;
+  gint i, j;
+
+  /* 16 bytes per iteration, 8 at a time */
+  for (j = 0; j + 16 <= width; j += 16) {
+    t = _mm_loadu_si128 ((const __m128i *) (top + j));
+    b = _mm_loadu_si128 ((const __m128i *) (bottom + j));
+
+    for (i = 0; i < 2; ++i) {
+      ft = _mm256_cvtepi32_ps (_mm256_cvtepu8_epi32 (t));
+      fb = _mm256_cvtepi32_ps (_mm256_cvtepu8_epi32 (b));
+      _mm256_storeu_ps (out + j + 8 * i, _mm256_add_ps (ft,
+              _mm256_mul_ps (_mm256_sub_ps (fb, ft), w)));
+      t = _mm_srli_si128 (t, 8);
+      b = _mm_srli_si128 (b, 8);
+    }
+  }
+
+  gst_inference_blend_row_tail (top, bottom, weight, out, j, width);
+}
+
+#elif defined(GST_INFERENCE_HAVE_NEON)
+
+static void gst_inference_normalize_row_neon (const GstInferenceNormalizeParams
+    * params, const guint8 * in, gfloat * out, gint width);
+static float32x4_t gst_inference_normalize_quad_neon (uint16x4_t values,
+    float64x2_t mean, float64x2_t std);
+static void gst_inference_blend_row_neon (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint width);
+
+static float32x4_t
+gst_inference_normalize_quad_neon (uint16x4_t values, float64x2_t mean,
+    float64x2_t std)
+{
+  uint32x4_t wide = vmovl_u16 (values);
+  float64x2_t lo = vcvtq_f64_u64 (vmovl_u32 (vget_low_u32 (wide)));
+  float64x2_t hi = vcvtq_f64_u64 (vmovl_u32 (vget_high_u32 (wide)));
+
+  lo = vmulq_f64 (vsubq_f64 (lo, mean), std);
+  hi = vmulq_f64 (vsubq_f64 (hi, mean), std);
+
+  return vcombine_f32 (vcvt_f32_f64 (lo), vcvt_f32_f64 (hi));
+}
+
+static void
+gst_inference_normalize_row_neon (const GstInferenceNormalizeParams * params,
+    const guint8 * in, gfloat * out, gint width)
+{
+  const gint channels = params->channels;
+  float64x2_t mean[3], std[3];
+  uint8x8_t planes[4];
+  uint8x8x3_t rgb;
+  uint8x8x4_t rgba;
+  uint16x8_t wide;
+  float32x4x3_t lo, hi;
+  gint c, j;
+
+  for (c = 0; c < 3; ++c) {
+    mean[c] = vdupq_n_f64 (params->mean[c]);
+    std[c] = vdupq_n_f64 (params->std[c]);
+  }
+
+  /* 8 pixels per iteration, deinterleaved by the structured loads */
+  for (j = 0; j + 8 <= width; j += 8) {
+    if (4 == channels) {
+      rgba = vld4_u8 (in + j * 4);
+      planes[0] = rgba.val[0];
+      planes[1] = rgba.val[1];
+      planes[2] = rgba.val[2];
+      planes[3] = rgba.val[3];
+    } else if (3 == channels) {
+      rgb = vld3_u8 (in + j * 3);
+      planes[0] = rgb.val[0];
+      planes[1] = rgb.val[1];
+      planes[2] = rgb.val[2];
+      planes[3] = rgb.val[2];
+    } else {
+      planes[0] = vld1_u8 (in + j);
+      planes[1] = planes[2] = planes[3] = planes[0];
+    }
+
+    for (c = 0; c < 3; ++c) {
+      wide = vmovl_u8 (planes[params->offset + params->map[c]]);
+      lo.val[c] = gst_inference_normalize_quad_neon (vget_low_u16 (wide),
+          mean[c], std[c]);
+      hi.val[c] = gst_inference_normalize_quad_neon (vget_high_u16 (wide),
+          mean[c], std[c]);
+    }
+
+    vst3q_f32 (out + j * 3, lo);
+    vst3q_f32 (out + j * 3 + 12, hi);
+  }
+
+  gst_inference_normalize_row_tail (params, in, out, j, width);
+}
+
+static void
+gst_inference_blend_row_neon (const guint8 * top, const guint8 * bottom,
+    gfloat weight, gfloat * out, gint width)
+{
+  const float32x4_t w = vdupq_n_f32 (weight);
+  uint16x8_t t, b;
+  float32x4_t ft, fb;
+  gint i, j;
+
+  /* 8 bytes per iteration, 4 at a time */
+  for (j = 0; j + 8 <= width; j += 8) {
+    t = vmovl_u8 (vld1_u8 (top + j));
+    b = vmovl_u8 (vld1_u8 (bottom + j));
+
+    for (i = 0; i < 2; ++i) {
+      ft = vcvtq_f32_u32 (vmovl_u16 (0 == i ? vget_low_u16 (t) :
+              vget_high_u16 (t)));
+      fb = vcvtq_f32_u32 (vmovl_u16 (0 == i ? vget_low_u16 (b) :
+              vget_high_u16 (b)));
+      vst1q_f32 (out + j + 4 * i, vaddq_f32 (ft, vmulq_f32 (vsubq_f32 (fb,
+                      ft), w)));
+    }
+  }
+
+  gst_inference_blend_row_tail (top, bottom, weight, out, j, width);
+}
+
+#endif
+
+gboolean
+gst_inference_kernel_supported (GstInferenceKernelImpl impl)
+{
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return TRUE;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+    case GST_INFERENCE_KERNEL_AVX2:
+    case GST_INFERENCE_KERNEL_AVX512:
+      return gst_inference_cpu_supports (impl);
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return TRUE;
+#endif
+    default:
+      return FALSE;
+  }
+}
+
+void
+gst_inference_normalize_params_init (GstInferenceNormalizeParams * params,
+    gint channels, gint offset, gint first_index, gint last_index,
+    const gdouble mean[3], const gdouble std[3])
+{
+  gint i, k, p;
+  gdouble pos_mean[3], pos_std[3];
+
+  g_return_if_fail (params != NULL);
+  g_return_if_fail (mean != NULL);
+  g_return_if_fail (std != NULL);
+  g_return_if_fail (channels >= 1 && channels <= 4);
+
+  params->channels = channels;
+  params->offset = offset;
+
+  if (1 == channels) {
+    /* Replicate the single gray component into every output channel */
+    for (p = 0; p < 3; ++p) {
+      params->map[p] = 0;
+      pos_mean[p] = mean[p];
+      pos_std[p] = std[p];
+    }
+  } else {
+    params->map[first_index] = 0;
+    params->map[1] = 1;
+    params->map[last_index] = 2;
+    for (p = 0; p < 3; ++p) {
+      pos_mean[p] = mean[params->map[p]];
+      pos_std[p] = std[params->map[p]];
+    }
+  }
+
+  for (i = 0; i < GST_INFERENCE_NORMALIZE_PERIOD; ++i) {
+    params->mean[i] = pos_mean[i % 3];
+    params->std[i] = pos_std[i % 3];
+  }
+
+  for (i = 0; i < 16; ++i) {
+    k = i / 3;
+    p = i % 3;
+    /* Zero the unused lanes */
+    params->shuffle[i] = i < 12 ?
+        (guint8) (k * channels + offset + params->map[p]) : 0x80;
+  }
+}
+
+static GstInferenceNormalizeRowFunc
+gst_inference_normalize_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX512,
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceNormalizeRowFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_normalize_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_normalize_row_c;
+}
+
+GstInferenceNormalizeRowFunc
+gst_inference_normalize_get_row_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceNormalizeRowFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_normalize_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceNormalizeRowFunc
+gst_inference_normalize_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_normalize_row_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_normalize_row_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_normalize_row_avx2;
+    case GST_INFERENCE_KERNEL_AVX512:
+      return gst_inference_normalize_row_avx512;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_normalize_row_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
+
+static GstInferenceBlendRowFunc
+gst_inference_blend_select (void)
+{
+  static const GstInferenceKernelImpl preference[] = {
+    GST_INFERENCE_KERNEL_AVX2,
+    GST_INFERENCE_KERNEL_SSE41,
+    GST_INFERENCE_KERNEL_NEON,
+  };
+  GstInferenceBlendRowFunc func = NULL;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (preference); ++i) {
+    func = gst_inference_blend_get_impl (preference[i]);
+    if (func) {
+      return func;
+    }
+  }
+
+  return gst_inference_blend_row_c;
+}
+
+GstInferenceBlendRowFunc
+gst_inference_blend_get_row_func (void)
+{
+  static gsize selected = 0;
+  static GstInferenceBlendRowFunc func = NULL;
+
+  if (g_once_init_enter (&selected)) {
+    func = gst_inference_blend_select ();
+    g_once_init_leave (&selected, 1);
+  }
+
+  return func;
+}
+
+GstInferenceBlendRowFunc
+gst_inference_blend_get_impl (GstInferenceKernelImpl impl)
+{
+  if (!gst_inference_kernel_supported (impl)) {
+    return NULL;
+  }
+
+  /* AVX-512 would not help a kernel bound by the byte loads */
+  switch (impl) {
+    case GST_INFERENCE_KERNEL_C:
+      return gst_inference_blend_row_c;
+#if defined(GST_INFERENCE_HAVE_X86)
+    case GST_INFERENCE_KERNEL_SSE41:
+      return gst_inference_blend_row_sse41;
+    case GST_INFERENCE_KERNEL_AVX2:
+      return gst_inference_blend_row_avx2;
+#elif defined(GST_INFERENCE_HAVE_NEON)
+    case GST_INFERENCE_KERNEL_NEON:
+      return gst_inference_blend_row_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
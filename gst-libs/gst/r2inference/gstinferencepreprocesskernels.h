@@ -0,0 +1,134 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_PREPROCESS_KERNELS_H__
+#define __GST_INFERENCE_PREPROCESS_KERNELS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GST_INFERENCE_HAVE_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GST_INFERENCE_HAVE_NEON 1
+#endif
+
+/* MSVC exposes every intrinsic unconditionally, GCC and Clang need the
+ * instruction set enabled per function */
+#if defined(__GNUC__) || defined(__clang__)
+#define GST_INFERENCE_TARGET(isa) __attribute__ ((target (isa)))
+#else
+#define GST_INFERENCE_TARGET(isa)
+#endif
+
+/* Output elements covered by one period of the per-channel mean/std
+ * pattern: 8 pixels of 3 channels each, the widest SIMD step */
+#define GST_INFERENCE_NORMALIZE_PERIOD 24
+
+typedef enum
+{
+  GST_INFERENCE_KERNEL_C,
+  GST_INFERENCE_KERNEL_SSE41,
+  GST_INFERENCE_KERNEL_AVX2,
+  GST_INFERENCE_KERNEL_AVX512,
+  GST_INFERENCE_KERNEL_NEON,
+  GST_INFERENCE_KERNEL_COUNT
+} GstInferenceKernelImpl;
+
+typedef struct _GstInferenceNormalizeParams GstInferenceNormalizeParams;
+struct _GstInferenceNormalizeParams
+{
+  /* Bytes per input pixel and offset of the first color component */
+  gint channels;
+  gint offset;
+  /* Input component read for each of the 3 output channels */
+  gint map[3];
+  /* Mean and scale of every output element within a period */
+  gdouble mean[GST_INFERENCE_NORMALIZE_PERIOD];
+  gdouble std[GST_INFERENCE_NORMALIZE_PERIOD];
+  /* Byte shuffle gathering 4 input pixels into 12 output elements */
+  guint8 shuffle[16];
+};
+
+typedef void (*GstInferenceNormalizeRowFunc) (const GstInferenceNormalizeParams *
+    params, const guint8 * in, gfloat * out, gint width);
+
+/* Blends 2 rows of bytes as top + (bottom - top) * weight */
+typedef void (*GstInferenceBlendRowFunc) (const guint8 * top,
+    const guint8 * bottom, gfloat weight, gfloat * out, gint width);
+
+/**
+ * \brief Check whether a kernel implementation can run on this CPU
+ *
+ * \param impl The kernel implementation to check
+ */
+gboolean gst_inference_kernel_supported (GstInferenceKernelImpl impl);
+
+/**
+ * \brief Fill the kernel parameters for a given input layout
+ *
+ * \param params The parameters to initialize
+ * \param channels The number of bytes per input pixel
+ * \param offset The offset of the first color component in a pixel
+ * \param first_index The output channel of the first color component
+ * \param last_index The output channel of the third color component
+ * \param mean The mean of each input color component
+ * \param std The scale of each input color component
+ */
+void gst_inference_normalize_params_init (GstInferenceNormalizeParams * params,
+    gint channels, gint offset, gint first_index, gint last_index,
+    const gdouble mean[3], const gdouble std[3]);
+
+/**
+ * \brief Get the fastest row kernel supported by the running CPU.
+ * The choice is made once per process.
+ */
+GstInferenceNormalizeRowFunc gst_inference_normalize_get_row_func (void);
+
+/**
+ * \brief Get a specific row kernel
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceNormalizeRowFunc gst_inference_normalize_get_impl (GstInferenceKernelImpl impl);
+
+/**
+ * \brief Get the fastest row blending kernel supported by the running
+ * CPU, used for the vertical pass of bilinear sampling. The choice is
+ * made once per process.
+ */
+GstInferenceBlendRowFunc gst_inference_blend_get_row_func (void);
+
+/**
+ * \brief Get a specific row blending kernel
+ *
+ * \param impl The kernel implementation to look up
+ *
+ * \return The kernel, or NULL if it is not available on this build or CPU
+ */
+GstInferenceBlendRowFunc gst_inference_blend_get_impl (GstInferenceKernelImpl impl);
+
+G_END_DECLS
+
+#endif //__GST_INFERENCE_PREPROCESS_KERNELS_H__
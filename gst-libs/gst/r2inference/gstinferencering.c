@@ -0,0 +1,168 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencering.h"
+
+/* Both counters only ever grow, wrapping around at G_MAXUINT. The slot
+ * of a counter is given by masking it with the power-of-two capacity,
+ * so the wrap-around does not need any special handling. The producer
+ * is the only writer of head and the consumer the only writer of tail;
+ * the GLib atomics are full barriers, which publishes the item before
+ * the new head and releases the slot before the new tail. */
+struct _GstInferenceRing
+{
+  gpointer *items;
+  guint depth;
+  guint mask;
+  gint head;
+  gint tail;
+};
+
+static guint gst_inference_ring_get_head (GstInferenceRing * ring);
+static guint gst_inference_ring_get_tail (GstInferenceRing * ring);
+
+static guint
+gst_inference_ring_get_head (GstInferenceRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->head);
+}
+
+static guint
+gst_inference_ring_get_tail (GstInferenceRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->tail);
+}
+
+GstInferenceRing *
+gst_inference_ring_new (guint depth)
+{
+  GstInferenceRing *ring = NULL;
+  guint capacity = 1;
+
+  g_return_val_if_fail (depth > 0, NULL);
+  g_return_val_if_fail (depth <= G_MAXINT / 2, NULL);
+
+  while (capacity < depth) {
+    capacity <<= 1;
+  }
+
+  ring = g_slice_new0 (GstInferenceRing);
+  ring->items = g_new0 (gpointer, capacity);
+  ring->depth = depth;
+  ring->mask = capacity - 1;
+
+  return ring;
+}
+
+void
+gst_inference_ring_free (GstInferenceRing * ring, GDestroyNotify free_func)
+{
+  gpointer item = NULL;
+
+  g_return_if_fail (ring);
+
+  while ((item = gst_inference_ring_pop (ring))) {
+    if (free_func) {
+      free_func (item);
+    }
+  }
+
+  g_free (ring->items);
+  g_slice_free (GstInferenceRing, ring);
+}
+
+gboolean
+gst_inference_ring_push (GstInferenceRing * ring, gpointer item)
+{
+  guint head = 0;
+
+  g_return_val_if_fail (ring, FALSE);
+  g_return_val_if_fail (item, FALSE);
+
+  head = (guint) ring->head;
+  if (head - gst_inference_ring_get_tail (ring) >= ring->depth) {
+    return FALSE;
+  }
+
+  ring->items[head & ring->mask] = item;
+  g_atomic_int_set (&ring->head, (gint) (head + 1));
+
+  return TRUE;
+}
+
+gpointer
+gst_inference_ring_peek (GstInferenceRing * ring)
+{
+  guint tail = 0;
+
+  g_return_val_if_fail (ring, NULL);
+
+  tail = (guint) ring->tail;
+  if (tail == gst_inference_ring_get_head (ring)) {
+    return NULL;
+  }
+
+  return ring->items[tail & ring->mask];
+}
+
+gpointer
+gst_inference_ring_pop (GstInferenceRing * ring)
+{
+  gpointer item = NULL;
+  guint tail = 0;
+
+  g_return_val_if_fail (ring, NULL);
+
+  tail = (guint) ring->tail;
+  if (tail == gst_inference_ring_get_head (ring)) {
+    return NULL;
+  }
+
+  item = ring->items[tail & ring->mask];
+  ring->items[tail & ring->mask] = NULL;
+  g_atomic_int_set (&ring->tail, (gint) (tail + 1));
+
+  return item;
+}
+
+guint
+gst_inference_ring_get_occupancy (GstInferenceRing * ring)
+{
+  guint tail = 0;
+  guint head = 0;
+
+  g_return_val_if_fail (ring, 0);
+
+  /* Read tail first so a concurrent pop can only make the result
+   * larger than the truth, never wrap it below zero */
+  tail = gst_inference_ring_get_tail (ring);
+  head = gst_inference_ring_get_head (ring);
+
+  return MIN (head - tail, ring->depth);
+}
+
+guint
+gst_inference_ring_get_depth (GstInferenceRing * ring)
+{
+  g_return_val_if_fail (ring, 0);
+
+  return ring->depth;
+}
@@ -0,0 +1,95 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_RING_H__
+#define __GST_INFERENCE_RING_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Bounded single-producer single-consumer FIFO. Push may run
+ * concurrently with peek and pop without any lock, as long as there is
+ * only one thread pushing and one thread consuming at a time. */
+typedef struct _GstInferenceRing GstInferenceRing;
+
+/**
+ * \brief Create a new ring
+ *
+ * \param depth The maximum number of items the ring can hold
+ */
+GstInferenceRing *gst_inference_ring_new (guint depth);
+
+/**
+ * \brief Free a ring and the items still in it
+ *
+ * \param ring The ring to free
+ * \param free_func Function called on every remaining item, or NULL
+ */
+void gst_inference_ring_free (GstInferenceRing * ring,
+    GDestroyNotify free_func);
+
+/**
+ * \brief Append an item at the end of the ring. Producer side.
+ *
+ * \param ring The ring to push to
+ * \param item The item to push, must not be NULL
+ *
+ * \return FALSE if the ring is full, the item is not stored then
+ */
+gboolean gst_inference_ring_push (GstInferenceRing * ring, gpointer item);
+
+/**
+ * \brief Get the oldest item without removing it. Consumer side.
+ *
+ * \param ring The ring to look at
+ *
+ * \return The oldest item, or NULL if the ring is empty
+ */
+gpointer gst_inference_ring_peek (GstInferenceRing * ring);
+
+/**
+ * \brief Remove and return the oldest item. Consumer side.
+ *
+ * \param ring The ring to pop from
+ *
+ * \return The oldest item, or NULL if the ring is empty
+ */
+gpointer gst_inference_ring_pop (GstInferenceRing * ring);
+
+/**
+ * \brief Get the number of items currently stored. Safe from any thread,
+ * the value may be outdated as soon as it is returned.
+ *
+ * \param ring The ring to query
+ */
+guint gst_inference_ring_get_occupancy (GstInferenceRing * ring);
+
+/**
+ * \brief Get the maximum number of items the ring can hold
+ *
+ * \param ring The ring to query
+ */
+guint gst_inference_ring_get_depth (GstInferenceRing * ring);
+
+G_END_DECLS
+
+#endif //__GST_INFERENCE_RING_H__
@@ -0,0 +1,88 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "gstinferencetensor.h"
+
+#include <string.h>
+
+GstInferenceTensorList *
+gst_inference_tensor_list_new (guint num_tensors, gpointer owner,
+    GDestroyNotify owner_free)
+{
+  GstInferenceTensorList *list = g_slice_new0 (GstInferenceTensorList);
+
+  list->tensors = g_new0 (GstInferenceTensor, num_tensors);
+  list->num_tensors = num_tensors;
+  list->owner = owner;
+  list->owner_free = owner_free;
+
+  return list;
+}
+
+void
+gst_inference_tensor_list_free (GstInferenceTensorList * list)
+{
+  g_return_if_fail (list);
+
+  if (list->owner_free) {
+    list->owner_free (list->owner);
+  }
+
+  g_free (list->tensors);
+  g_slice_free (GstInferenceTensorList, list);
+}
+
+gsize
+gst_inference_tensor_list_get_size (const GstInferenceTensorList * list)
+{
+  gsize size = 0;
+  guint i = 0;
+
+  g_return_val_if_fail (list, 0);
+
+  for (i = 0; i < list->num_tensors; i++) {
+    size += list->tensors[i].size;
+  }
+
+  return size;
+}
+
+gpointer
+gst_inference_tensor_list_concat (const GstInferenceTensorList * list,
+    gsize * size)
+{
+  guint8 *data = NULL;
+  gsize offset = 0;
+  guint i = 0;
+
+  g_return_val_if_fail (list, NULL);
+  g_return_val_if_fail (size, NULL);
+
+  *size = gst_inference_tensor_list_get_size (list);
+  data = g_malloc (*size);
+
+  for (i = 0; i < list->num_tensors; i++) {
+    memcpy (data + offset, list->tensors[i].data, list->tensors[i].size);
+    offset += list->tensors[i].size;
+  }
+
+  return data;
+}
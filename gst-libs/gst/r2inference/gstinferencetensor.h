@@ -0,0 +1,109 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef __GST_INFERENCE_TENSOR_H__
+#define __GST_INFERENCE_TENSOR_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_INFERENCE_TENSOR_TYPE_FLOAT,
+} GstInferenceTensorType;
+
+/**
+ * GstInferenceTensor:
+ * @data: The tensor contents, borrowed from the backend
+ * @size: The size of the contents in bytes
+ * @num_elements: The number of elements in the tensor
+ * @type: The type of every element
+ *
+ * A read-only view of one output tensor of a prediction.
+ */
+typedef struct _GstInferenceTensor GstInferenceTensor;
+struct _GstInferenceTensor
+{
+  gconstpointer data;
+  gsize size;
+  gsize num_elements;
+  GstInferenceTensorType type;
+};
+
+/**
+ * GstInferenceTensorList:
+ * @tensors: The output tensors in the order the model produces them
+ * @num_tensors: The number of tensors
+ *
+ * The outputs of a prediction. The tensors are views on memory owned by
+ * the backend and stay valid until the list is freed.
+ */
+typedef struct _GstInferenceTensorList GstInferenceTensorList;
+struct _GstInferenceTensorList
+{
+  GstInferenceTensor *tensors;
+  guint num_tensors;
+
+  /*< private > */
+  gpointer owner;
+  GDestroyNotify owner_free;
+};
+
+/**
+ * \brief Create a new tensor list with all the views zeroed
+ *
+ * \param num_tensors The number of tensors in the list
+ * \param owner The object holding the memory the views point to
+ * \param owner_free Function to release the owner when the list is freed
+ */
+GstInferenceTensorList *gst_inference_tensor_list_new (guint num_tensors,
+    gpointer owner, GDestroyNotify owner_free);
+
+/**
+ * \brief Free a tensor list and release the memory of its tensors
+ *
+ * \param list The list to free
+ */
+void gst_inference_tensor_list_free (GstInferenceTensorList * list);
+
+/**
+ * \brief Get the added size in bytes of all the tensors
+ *
+ * \param list The list to query
+ */
+gsize gst_inference_tensor_list_get_size (const GstInferenceTensorList * list);
+
+/**
+ * \brief Copy all the tensors one after the other in a newly allocated
+ * array. Only meant for consumers that expect a single flat buffer.
+ *
+ * \param list The list to copy
+ * \param size Return location for the size of the array in bytes
+ *
+ * \return The array, free it with g_free
+ */
+gpointer gst_inference_tensor_list_concat (const GstInferenceTensorList * list,
+    gsize * size);
+
+G_END_DECLS
+
+#endif //__GST_INFERENCE_TENSOR_H__
@@ -23,6 +23,7 @@
 #include "gstinferencebackends.h"
 #include "gstinferencemeta.h"
 #include "gstbasebackend.h"
+#include "gstinferencering.h"
 
 #include <gst/base/gstcollectpads.h>
 
@@ -46,7 +47,41 @@ GST_DEBUG_CATEGORY_STATIC (gst_video_inference_debug_category);
 
 #define DEFAULT_MODEL_LOCATION   NULL
 #define DEFAULT_LABELS NULL
-#define DEFAULT_NUM_LABELS 0
+#define DEFAULT_POOL_SIZE 4
+#define MIN_POOL_SIZE 1
+#define MAX_POOL_SIZE 64
+#define DEFAULT_BATCH_SIZE 1
+#define MIN_BATCH_SIZE 1
+#define MAX_BATCH_SIZE 64
+#define DEFAULT_BATCH_TIMEOUT 0
+#define DEFAULT_ASYNC FALSE
+#define DEFAULT_MAX_INFLIGHT 4
+#define MIN_MAX_INFLIGHT 1
+#define MAX_MAX_INFLIGHT 64
+#define DEFAULT_NUM_ENGINES 1
+#define DEFAULT_ASYNC_LOAD FALSE
+#define DEFAULT_WARMUP_ITERATIONS 0
+#define MAX_WARMUP_ITERATIONS 1000
+#define MIN_NUM_ENGINES 1
+#define MAX_NUM_ENGINES 16
+#define DEFAULT_INFERENCE_INTERVAL 1
+#define MIN_INFERENCE_INTERVAL 1
+#define MAX_INFERENCE_INTERVAL 1000
+#define DEFAULT_QOS FALSE
+#define DEFAULT_QUEUE_DEPTH 32
+#define MIN_QUEUE_DEPTH 1
+#define MAX_QUEUE_DEPTH 4096
+#define DEFAULT_QUEUE_OVERFLOW GST_VIDEO_INFERENCE_OVERFLOW_FORWARD_OLDEST
+#define DEFAULT_CASCADE FALSE
+#define DEFAULT_TOP_K 5
+#define MIN_TOP_K 1
+#define DEFAULT_FULL_PROBABILITIES FALSE
+#define DEFAULT_MODEL_SHARING GST_BASE_BACKEND_SHARING_NONE
+/* Initial room of the serialized predictions, enough for a few boxes */
+#define SERIAL_SIZE 4096
+/* Entries the worker takes at once, enough for a full batch of tensors
+ * with the frames skipped in between */
+#define MAX_INFLIGHT_ENTRIES (MAX_BATCH_SIZE * 4)
 enum
 {
   NEW_INFERENCE_SIGNAL,
@@ -60,6 +95,27 @@ enum
   PROP_BACKEND,
   PROP_MODEL_LOCATION,
   PROP_LABELS,
+  PROP_POOL_SIZE,
+  PROP_POOL_HITS,
+  PROP_POOL_MISSES,
+  PROP_BATCH_SIZE,
+  PROP_BATCH_TIMEOUT,
+  PROP_ASYNC,
+  PROP_MAX_INFLIGHT,
+  PROP_INFERENCE_INTERVAL,
+  PROP_QOS,
+  PROP_QUEUE_DEPTH,
+  PROP_QUEUE_OVERFLOW,
+  PROP_MODEL_QUEUE_LEVEL,
+  PROP_BYPASS_QUEUE_LEVEL,
+  PROP_QUEUE_OVERFLOWS,
+  PROP_CASCADE,
+  PROP_TOP_K,
+  PROP_FULL_PROBABILITIES,
+  PROP_MODEL_SHARING,
+  PROP_NUM_ENGINES,
+  PROP_ASYNC_LOAD,
+  PROP_WARMUP_ITERATIONS,
 };
 
 GQuark _size_quark;
@@ -75,6 +131,15 @@ struct _GstVideoInferencePad
   GstVideoInfo info;
 };
 
+typedef struct _VideoInferenceBatchEntry VideoInferenceBatchEntry;
+struct _VideoInferenceBatchEntry
+{
+  GstBuffer *buffer;
+  GstVideoFrame tensor;
+  /* Skipped frames carry no tensor and reuse the last prediction */
+  gboolean skip;
+};
+
 typedef struct _GstVideoInferencePrivate GstVideoInferencePrivate;
 struct _GstVideoInferencePrivate
 {
@@ -92,15 +157,109 @@ struct _GstVideoInferencePrivate
 
   gchar *model_location;
 
-  GMutex mtx_model_queue;
-  GMutex mtx_bypass_queue;
-
-  GQueue *model_queue;
-  GQueue *bypass_queue;
-
+  /* Buffers waiting for their pair. Each ring has a single producer and
+   * a single consumer: the consumers are serialized by the collect pads
+   * stream lock or by mtx_output, and a producer evicting an old buffer
+   * takes mtx_output too. The settings and the ring pointers are
+   * protected by the object lock */
+  GstInferenceRing *model_queue;
+  GstInferenceRing *bypass_queue;
+  guint queue_depth;
+  GstVideoInferenceOverflow queue_overflow;
+  guint64 queue_overflows;
+
+  /* Labels and the table built from them, protected by the object lock */
   gchar *labels;
-  gchar **labels_list;
-  gint num_labels;
+  GstInferenceLabels *label_table;
+
+  /* Pool of pre-processed tensors, protected by the object lock */
+  GstBufferPool *pool;
+  gsize pool_buffer_size;
+  guint pool_size;
+  guint64 pool_hits;
+  guint64 pool_misses;
+
+  /* Tensor layout when the model pad is converted and scaled by the
+   * fused preprocess instead of matching the model caps exactly */
+  GstVideoInfo model_info;
+  gboolean fused;
+
+  /* Model buffers waiting for a batched prediction. The settings are
+   * protected by the object lock, the entries by the stream lock. The
+   * timer runs an incomplete batch once its deadline passes, the
+   * deadline is protected by mtx_batch and is 0 while there is none */
+  guint batch_size;
+  guint64 batch_timeout;
+  GArray *batch;
+  gint64 batch_start;
+  GThread *batch_timer;
+  GMutex mtx_batch;
+  GCond cond_batch;
+  gboolean batch_timer_running;
+  gint64 batch_deadline;
+  GstFlowReturn batch_timer_ret;
+
+  /* Asynchronous inference. The settings are protected by the object
+   * lock, the in-flight queue and worker state by mtx_inflight */
+  gboolean async;
+  guint max_inflight;
+  guint num_engines;
+  GPtrArray *workers;
+  GMutex mtx_inflight;
+  GCond cond_inflight;
+  GQueue *inflight;
+  guint inflight_tensors;
+  gboolean worker_running;
+  guint workers_busy;
+  gboolean flushing;
+  GstFlowReturn worker_ret;
+  /* Tickets of the batches taken by the workers and of the next one to
+   * finish, so results leave in queue order whatever engine ran them */
+  guint64 dispatch_seq;
+  guint64 finish_seq;
+
+  /* Model loading. The settings are protected by the object lock, the
+   * loader state by mtx_load. Loaded is set once the backend and the
+   * subclass started, the streaming threads wait for it while loading */
+  gboolean async_load;
+  guint warmup_iterations;
+  GThread *loader;
+  GMutex mtx_load;
+  GCond cond_load;
+  gboolean loading;
+  gboolean loaded;
+  gboolean load_cancelled;
+
+  /* Serializes the PTS matching and pushes of both source pads */
+  GMutex mtx_output;
+
+  /* Rate control. The settings, QoS state and last prediction are
+   * protected by the object lock, the skip count by the stream lock */
+  guint inference_interval;
+  gboolean qos;
+  GstClockTime earliest_time;
+  GstInferencePrediction *last_prediction;
+  guint frames_skipped;
+
+  /* Second stage inference on the upstream predictions. The setting is
+   * protected by the object lock, the tensor layout is only used from
+   * the streaming thread. The tensor of the regions is kept across
+   * frames, as large as the most regions seen so far */
+  gboolean cascade;
+  GstVideoInfo roi_info;
+  GstBuffer *cascade_tensor;
+
+  /* What classifications keep, protected by the object lock */
+  guint top_k;
+  gboolean full_probabilities;
+
+  /* How the backend shares its model with other elements, applied on
+   * the next start. Protected by the object lock */
+  GstBaseBackendSharing model_sharing;
+
+  /* Serialization reused by every new-inference-string emission, it only
+   * grows. Notifications are serialized like the ring consumers */
+  GString *serial;
 };
 
 /* GObject methods */
@@ -130,6 +289,12 @@ static guint gst_video_inference_get_children_count (GstChildProxy * parent);
 /* GstVideoInference methods */
 static gboolean gst_video_inference_start (GstVideoInference * self);
 static gboolean gst_video_inference_stop (GstVideoInference * self);
+static gboolean video_inference_load (GstVideoInference * self);
+static gpointer video_inference_load_thread (gpointer data);
+static gboolean video_inference_warmup (GstVideoInference * self,
+    guint iterations);
+static GstFlowReturn video_inference_wait_loaded (GstVideoInference * self);
+static gboolean video_inference_cancel_load (GstVideoInference * self);
 static GstPad *gst_video_inference_create_pad (GstVideoInference * self,
     GstPadTemplate * templ, const gchar * name, GstVideoInferencePad ** data);
 static GstFlowReturn gst_video_inference_process_bypass (GstVideoInference *
@@ -142,14 +307,14 @@ static GstFlowReturn gst_video_inference_forward_buffer (GstVideoInference *
     self, GstBuffer * buffer, GstPad * pad);
 static gboolean gst_video_inference_model_run_prediction (GstVideoInference *
     self, GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
-    GstBuffer * buffer, gpointer * prediction_data, gsize * prediction_size);
+    GstBuffer * buffer, GstInferenceTensorList ** prediction);
 
 static gboolean gst_video_inference_preprocess (GstVideoInference * self,
     GstVideoInferenceClass * klass, GstVideoFrame * inframe,
     GstVideoFrame * outframe);
 static gboolean gst_video_inference_predict (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gpointer * pred,
-    gsize * pred_size);
+    GstVideoInferencePrivate * priv, GstVideoFrame * frame,
+    GstInferenceTensorList ** pred);
 
 static GstIterator *gst_video_inference_iterate_internal_links (GstPad * pad,
     GstObject * parent);
@@ -167,17 +332,119 @@ static guint gst_video_inference_get_backend_type (GstVideoInference * self);
 static void gst_video_inference_set_caps (GstVideoInference * self,
     GstVideoInferencePrivate * priv, GstCollectData * pad, GstEvent * event);
 
-static void video_inference_map_buffers (GstVideoInferencePad * data,
-    GstBuffer * inbuf, GstVideoFrame * inframe, GstVideoFrame * outframe);
+static void video_inference_map_buffers (GstVideoInference * self,
+    GstVideoInferencePad * data, GstBuffer * inbuf, GstVideoFrame * inframe,
+    GstVideoFrame * outframe);
+static GstBufferPool *video_inference_create_pool (GstVideoInference * self,
+    gsize size, guint depth);
+static GstBuffer *video_inference_acquire_tensor (GstVideoInference * self,
+    GstVideoInfo * info, gsize size);
+static void video_inference_clear_pool (GstVideoInference * self);
+static gboolean video_inference_get_model_size (GstVideoInference * self,
+    gint * width, gint * height);
+static void video_inference_configure_tensor (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInfo * info);
+static gboolean video_inference_fused_postprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstInferenceTensorList * prediction, GstMeta * meta_model,
+    GstVideoInfo * info_model, gboolean * pred_valid);
 static gboolean video_inference_prepare_postprocess (GstBuffer * buffer,
     GstVideoInfo * video_info, GstMeta ** out_meta);
 static GstMeta *video_inference_transform_meta (GstBuffer * buffer_model,
     GstVideoInfo * info_model, GstMeta * meta_model, GstBuffer * buffer_bypass,
     GstVideoInfo * info_bypass);
-static void video_inference_flush_queue (GQueue * queue, GMutex * mutex);
+static void video_inference_flush_queue (GstInferenceRing * queue);
+static GstFlowReturn video_inference_queue_push (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceRing * queue,
+    GstBuffer * buffer, GstPad * pad);
+static guint video_inference_get_queue_level (GstVideoInference * self,
+    GstInferenceRing ** queue);
+static GstFlowReturn video_inference_finish_model (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad,
+    GstInferenceTensorList * prediction);
+static gboolean video_inference_postprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstInferenceTensorList * prediction, GstMeta * meta_model,
+    GstVideoInfo * info_model, gboolean * pred_valid);
+static GstFlowReturn video_inference_batch_push (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad, gboolean skip);
+static GstFlowReturn video_inference_batch_flush (GstVideoInference * self);
+static void video_inference_batch_clear (GstVideoInference * self);
+static void video_inference_batch_set_deadline (GstVideoInference * self,
+    gint64 deadline);
+static gpointer video_inference_batch_timer (gpointer data);
+static void video_inference_batch_timer_start (GstVideoInference * self);
+static void video_inference_batch_timer_stop (GstVideoInference * self);
+static gboolean video_inference_predict_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries,
+    GstInferenceTensorList ** predictions);
+static GstFlowReturn video_inference_finish_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries,
+    GstInferenceTensorList ** predictions, gboolean predicted);
+static GstFlowReturn video_inference_run_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries);
+static gboolean video_inference_prepare_entry (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad, VideoInferenceBatchEntry * entry);
+static void video_inference_clear_entry (VideoInferenceBatchEntry * entry);
+static GstFlowReturn video_inference_async_push (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad, gboolean skip);
+static gpointer video_inference_async_worker (gpointer data);
+static void video_inference_async_start (GstVideoInference * self);
+static void video_inference_async_stop (GstVideoInference * self);
+static void video_inference_async_drain (GstVideoInference * self);
+static void video_inference_async_set_flushing (GstVideoInference * self,
+    gboolean flushing);
+static GstFlowReturn video_inference_match_pts (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean drain);
+static gboolean video_inference_should_skip (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad);
+static GstFlowReturn video_inference_skip_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad);
+static GstFlowReturn video_inference_output_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstMeta * meta_model, GstVideoInferencePad * pad);
+static void video_inference_store_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferencePrediction * prediction);
+static void video_inference_reset_qos (GstVideoInference * self);
+static void video_inference_notify (GstVideoInference * self,
+    GstBuffer * model_buffer, GstMeta * meta_model, GstBuffer * bypass_buffer,
+    GstMeta * meta_bypass);
+static void video_inference_crop_frame (GstVideoFrame * frame,
+    BoundingBox * bbox, GstVideoFrame * roi);
+static GstBuffer *video_inference_acquire_cascade_tensor (GstVideoInference *
+    self, GstVideoInferencePrivate * priv, gsize size);
+static void video_inference_clear_cascade_tensor (GstVideoInference * self);
+static GstFlowReturn video_inference_cascade_model (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad);
 
 static guint gst_video_inference_signals[LAST_SIGNAL] = { 0 };
 
+GType
+gst_video_inference_overflow_get_type (void)
+{
+  static GType type = G_TYPE_INVALID;
+  if (G_UNLIKELY (type == G_TYPE_INVALID)) {
+    static const GEnumValue values[] = {
+      {GST_VIDEO_INFERENCE_OVERFLOW_FORWARD_OLDEST,
+          "GST_VIDEO_INFERENCE_OVERFLOW_FORWARD_OLDEST", "forward-oldest",},
+      {GST_VIDEO_INFERENCE_OVERFLOW_DROP_OLDEST,
+          "GST_VIDEO_INFERENCE_OVERFLOW_DROP_OLDEST", "drop-oldest",},
+      {GST_VIDEO_INFERENCE_OVERFLOW_DROP_NEWEST,
+          "GST_VIDEO_INFERENCE_OVERFLOW_DROP_NEWEST", "drop-newest",},
+      {0, NULL, NULL,},
+    };
+    type = g_enum_register_static ("GstVideoInferenceOverflow", values);
+  }
+  return type;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GstVideoInference, gst_video_inference,
     GST_TYPE_ELEMENT,
     GST_DEBUG_CATEGORY_INIT (gst_video_inference_debug_category,
@@ -231,6 +498,121 @@ gst_video_inference_class_init (GstVideoInferenceClass * klass)
       g_param_spec_string ("labels", "labels",
           "Semicolon separated string containing inference labels",
           DEFAULT_LABELS, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_POOL_SIZE,
+      g_param_spec_uint ("pool-size", "Pool Size",
+          "Number of pre-processed tensors kept in the internal buffer pool. "
+          "Frames that find the pool empty fall back to a fresh allocation",
+          MIN_POOL_SIZE, MAX_POOL_SIZE, DEFAULT_POOL_SIZE, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_POOL_HITS,
+      g_param_spec_uint64 ("pool-hits", "Pool Hits",
+          "Number of tensors served from the internal buffer pool", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_POOL_MISSES,
+      g_param_spec_uint64 ("pool-misses", "Pool Misses",
+          "Number of tensors allocated because the internal buffer pool "
+          "was empty or not yet configured", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Number of model buffers gathered before running the prediction "
+          "on all of them at once. The backends still predict them one at a "
+          "time, so this only groups the frames and adds latency, it brings "
+          "no speed-up", MIN_BATCH_SIZE, MAX_BATCH_SIZE,
+          DEFAULT_BATCH_SIZE, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_BATCH_TIMEOUT,
+      g_param_spec_uint64 ("batch-timeout", "Batch Timeout",
+          "Maximum time in nanoseconds the oldest buffer of an incomplete "
+          "batch waits, the batch runs then even if no new buffer arrives. "
+          "0 waits until the batch is full",
+          0, G_MAXUINT64, DEFAULT_BATCH_TIMEOUT, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_ASYNC,
+      g_param_spec_boolean ("async", "Asynchronous",
+          "Run the predictions in a dedicated thread so the streaming "
+          "thread only pre-processes. Predictions are matched back to the "
+          "bypass buffers by PTS. Takes effect when the element starts",
+          DEFAULT_ASYNC, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_MAX_INFLIGHT,
+      g_param_spec_uint ("max-inflight", "Maximum In-flight Buffers",
+          "Number of pre-processed buffers that may wait for the "
+          "asynchronous prediction before the streaming thread blocks",
+          MIN_MAX_INFLIGHT, MAX_MAX_INFLIGHT, DEFAULT_MAX_INFLIGHT,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_NUM_ENGINES,
+      g_param_spec_uint ("num-engines", "Number of Engines",
+          "Number of backend engines over the model. With more than one, "
+          "predictions run asynchronously on one thread per engine and "
+          "consecutive frames go to whichever engine is idle, results are "
+          "still output in order. Trades memory for throughput. Takes "
+          "effect when the element starts",
+          MIN_NUM_ENGINES, MAX_NUM_ENGINES, DEFAULT_NUM_ENGINES,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_ASYNC_LOAD,
+      g_param_spec_boolean ("async-load", "Asynchronous Load",
+          "Load the model and warm it up in a background thread. The change "
+          "to PAUSED completes asynchronously once it is done, buffers wait "
+          "for it meanwhile",
+          DEFAULT_ASYNC_LOAD, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_WARMUP_ITERATIONS,
+      g_param_spec_uint ("warmup-iterations", "Warm-up Iterations",
+          "Predictions run on every engine over a blank tensor after loading "
+          "the model, so the first frames do not pay for the lazy "
+          "initialization of the backend. Needs a fixed model input size. "
+          "The load and warm-up times are posted in an \"inference-load\" "
+          "element message",
+          0, MAX_WARMUP_ITERATIONS, DEFAULT_WARMUP_ITERATIONS,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_INFERENCE_INTERVAL,
+      g_param_spec_uint ("inference-interval", "Inference Interval",
+          "Run the model on one out of every N frames. The frames in "
+          "between carry the last prediction", MIN_INFERENCE_INTERVAL,
+          MAX_INFERENCE_INTERVAL, DEFAULT_INFERENCE_INTERVAL,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_QOS,
+      g_param_spec_boolean ("qos", "QoS",
+          "Skip the inference on frames that downstream reports as late, "
+          "or that find the asynchronous queue full, and give them the "
+          "last prediction instead", DEFAULT_QOS, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_QUEUE_DEPTH,
+      g_param_spec_uint ("queue-depth", "Queue Depth",
+          "Maximum number of model and of bypass buffers waiting for their "
+          "pair. Raised to batch-size * max-inflight + 1 if smaller, so the "
+          "frames held for a prediction never overflow it. Applied on the "
+          "next start", MIN_QUEUE_DEPTH, MAX_QUEUE_DEPTH,
+          DEFAULT_QUEUE_DEPTH, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_QUEUE_OVERFLOW,
+      g_param_spec_enum ("queue-overflow", "Queue Overflow",
+          "What to do with a buffer that finds its queue full",
+          GST_TYPE_VIDEO_INFERENCE_OVERFLOW, DEFAULT_QUEUE_OVERFLOW,
+          G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_MODEL_QUEUE_LEVEL,
+      g_param_spec_uint ("model-queue-level", "Model Queue Level",
+          "Number of model buffers currently waiting for their bypass pair",
+          0, G_MAXUINT, 0, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_BYPASS_QUEUE_LEVEL,
+      g_param_spec_uint ("bypass-queue-level", "Bypass Queue Level",
+          "Number of bypass buffers currently waiting for their prediction",
+          0, G_MAXUINT, 0, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_QUEUE_OVERFLOWS,
+      g_param_spec_uint64 ("queue-overflows", "Queue Overflows",
+          "Number of buffers that found their queue full since the last start",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE));
+  g_object_class_install_property (oclass, PROP_CASCADE,
+      g_param_spec_boolean ("cascade", "Cascade",
+          "Run the model on every enabled prediction of the upstream "
+          "inference meta instead of the whole frame, all of them in a "
+          "single batch, and attach the results to each prediction. Meant "
+          "for classification models",
+          DEFAULT_CASCADE, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_MODEL_SHARING,
+      g_param_spec_enum ("model-sharing", "Model Sharing",
+          "Share the loaded model with the elements of the process using the "
+          "same backend, model and load parameters. Either each one runs its "
+          "own engine over the shared weights, or they take turns on a "
+          "single engine. With a single engine, setting a backend property "
+          "while running changes it for every element sharing it. Applied on "
+          "the next start",
+          GST_TYPE_BASE_BACKEND_SHARING, DEFAULT_MODEL_SHARING,
+          G_PARAM_READWRITE));
 
   gst_video_inference_signals[NEW_INFERENCE_SIGNAL] =
       g_signal_new ("new-inference", G_TYPE_FROM_CLASS (klass),
@@ -245,6 +627,7 @@ gst_video_inference_class_init (GstVideoInferenceClass * klass)
   klass->stop = NULL;
   klass->preprocess = NULL;
   klass->postprocess = NULL;
+  klass->postprocess_tensors = NULL;
 
   _size_quark = g_quark_from_static_string (GST_META_TAG_VIDEO_SIZE_STR);
   _orientation_quark =
@@ -259,8 +642,7 @@ gst_video_inference_init (GstVideoInference * self)
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
 
   priv->labels = DEFAULT_LABELS;
-  priv->labels_list = DEFAULT_LABELS;
-  priv->num_labels = DEFAULT_NUM_LABELS;
+  priv->label_table = NULL;
 
   priv->sink_bypass_data = NULL;
   priv->sink_model_data = NULL;
@@ -271,13 +653,71 @@ gst_video_inference_init (GstVideoInference * self)
   priv->src_model = NULL;
   priv->inference_meta_info = gst_inference_meta_get_info ();
 
-  priv->cpads = gst_collect_pads_new ();
+  priv->pool = NULL;
+  priv->pool_buffer_size = 0;
+  priv->pool_size = DEFAULT_POOL_SIZE;
+  priv->pool_hits = 0;
+  priv->pool_misses = 0;
+
+  priv->batch_size = DEFAULT_BATCH_SIZE;
+  priv->batch_timeout = DEFAULT_BATCH_TIMEOUT;
+  priv->batch = g_array_new (FALSE, FALSE, sizeof (VideoInferenceBatchEntry));
+  priv->batch_start = 0;
+  priv->batch_timer = NULL;
+  priv->batch_timer_running = FALSE;
+  priv->batch_deadline = 0;
+  priv->batch_timer_ret = GST_FLOW_OK;
+  g_mutex_init (&priv->mtx_batch);
+  g_cond_init (&priv->cond_batch);
+
+  priv->async = DEFAULT_ASYNC;
+  priv->max_inflight = DEFAULT_MAX_INFLIGHT;
+  priv->num_engines = DEFAULT_NUM_ENGINES;
+  priv->workers = g_ptr_array_new ();
+  priv->inflight = g_queue_new ();
+  priv->worker_running = FALSE;
+  priv->workers_busy = 0;
+  priv->dispatch_seq = 0;
+  priv->finish_seq = 0;
+  priv->flushing = FALSE;
+  priv->worker_ret = GST_FLOW_OK;
+  priv->inflight_tensors = 0;
+  g_mutex_init (&priv->mtx_inflight);
+  g_cond_init (&priv->cond_inflight);
+  g_mutex_init (&priv->mtx_output);
+
+  priv->async_load = DEFAULT_ASYNC_LOAD;
+  priv->warmup_iterations = DEFAULT_WARMUP_ITERATIONS;
+  priv->loader = NULL;
+  priv->loading = FALSE;
+  priv->loaded = FALSE;
+  priv->load_cancelled = FALSE;
+  g_mutex_init (&priv->mtx_load);
+  g_cond_init (&priv->cond_load);
+
+  priv->inference_interval = DEFAULT_INFERENCE_INTERVAL;
+  priv->qos = DEFAULT_QOS;
+  priv->earliest_time = GST_CLOCK_TIME_NONE;
+  priv->last_prediction = NULL;
+  priv->frames_skipped = MAX_INFERENCE_INTERVAL;
+
+  priv->cascade = DEFAULT_CASCADE;
+  gst_video_info_init (&priv->roi_info);
+  priv->cascade_tensor = NULL;
+
+  priv->top_k = DEFAULT_TOP_K;
+  priv->full_probabilities = DEFAULT_FULL_PROBABILITIES;
+  priv->model_sharing = DEFAULT_MODEL_SHARING;
+
+  priv->serial = g_string_sized_new (SERIAL_SIZE);
 
-  g_mutex_init (&priv->mtx_model_queue);
-  g_mutex_init (&priv->mtx_bypass_queue);
+  priv->cpads = gst_collect_pads_new ();
 
-  priv->model_queue = g_queue_new ();
-  priv->bypass_queue = g_queue_new ();
+  priv->queue_depth = DEFAULT_QUEUE_DEPTH;
+  priv->queue_overflow = DEFAULT_QUEUE_OVERFLOW;
+  priv->queue_overflows = 0;
+  priv->model_queue = gst_inference_ring_new (priv->queue_depth);
+  priv->bypass_queue = gst_inference_ring_new (priv->queue_depth);
 
   /* Use buffer function to handle each pad buffer independently */
   gst_collect_pads_set_buffer_function (priv->cpads,
@@ -322,16 +762,104 @@ gst_video_inference_set_property (GObject * object,
       GST_OBJECT_UNLOCK (self);
       break;
     case PROP_LABELS:
-      if (priv->labels != NULL) {
-        g_free (priv->labels);
-      }
-      if (priv->labels_list != NULL) {
-        g_strfreev (priv->labels_list);
+      GST_OBJECT_LOCK (self);
+      g_free (priv->labels);
+      if (priv->label_table != NULL) {
+        gst_inference_labels_unref (priv->label_table);
       }
       priv->labels = g_value_dup_string (value);
-      priv->labels_list = g_strsplit (g_value_get_string (value), ";", 0);
-      priv->num_labels = g_strv_length (priv->labels_list);
+      /* Predictions already out keep their own reference to the old one */
+      priv->label_table = gst_inference_labels_new (priv->labels);
       GST_DEBUG_OBJECT (self, "Changed inference labels %s", priv->labels);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_POOL_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->pool_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      /* The pool is recreated with the new depth on the next frame */
+      video_inference_clear_pool (self);
+      break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (self);
+      priv->batch_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      /* The pool must hold a whole batch of tensors */
+      video_inference_clear_pool (self);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      priv->batch_timeout = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC:
+      GST_OBJECT_LOCK (self);
+      priv->async = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_NUM_ENGINES:
+      GST_OBJECT_LOCK (self);
+      priv->num_engines = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_LOAD:
+      GST_OBJECT_LOCK (self);
+      priv->async_load = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_WARMUP_ITERATIONS:
+      GST_OBJECT_LOCK (self);
+      priv->warmup_iterations = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_INFLIGHT:
+      GST_OBJECT_LOCK (self);
+      priv->max_inflight = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      /* Wake a streaming thread waiting for room in the queue */
+      g_mutex_lock (&priv->mtx_inflight);
+      g_cond_broadcast (&priv->cond_inflight);
+      g_mutex_unlock (&priv->mtx_inflight);
+      break;
+    case PROP_INFERENCE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      priv->inference_interval = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QOS:
+      GST_OBJECT_LOCK (self);
+      priv->qos = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QUEUE_DEPTH:
+      GST_OBJECT_LOCK (self);
+      priv->queue_depth = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QUEUE_OVERFLOW:
+      GST_OBJECT_LOCK (self);
+      priv->queue_overflow = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CASCADE:
+      GST_OBJECT_LOCK (self);
+      priv->cascade = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TOP_K:
+      GST_OBJECT_LOCK (self);
+      priv->top_k = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FULL_PROBABILITIES:
+      GST_OBJECT_LOCK (self);
+      priv->full_probabilities = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MODEL_SHARING:
+      GST_OBJECT_LOCK (self);
+      priv->model_sharing = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -356,7 +884,112 @@ gst_video_inference_get_property (GObject * object,
       g_value_set_string (value, priv->model_location);
       break;
     case PROP_LABELS:
+      GST_OBJECT_LOCK (self);
       g_value_set_string (value, priv->labels);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_POOL_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->pool_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_POOL_HITS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, priv->pool_hits);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_POOL_MISSES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, priv->pool_misses);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->batch_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, priv->batch_timeout);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->async);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_INFLIGHT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->max_inflight);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_NUM_ENGINES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->num_engines);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_ASYNC_LOAD:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->async_load);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_WARMUP_ITERATIONS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->warmup_iterations);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_INFERENCE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->inference_interval);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QOS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->qos);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QUEUE_DEPTH:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->queue_depth);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_QUEUE_OVERFLOW:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->queue_overflow);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MODEL_QUEUE_LEVEL:
+      g_value_set_uint (value,
+          video_inference_get_queue_level (self, &priv->model_queue));
+      break;
+    case PROP_BYPASS_QUEUE_LEVEL:
+      g_value_set_uint (value,
+          video_inference_get_queue_level (self, &priv->bypass_queue));
+      break;
+    case PROP_QUEUE_OVERFLOWS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, priv->queue_overflows);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CASCADE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->cascade);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_TOP_K:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->top_k);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FULL_PROBABILITIES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->full_probabilities);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MODEL_SHARING:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, priv->model_sharing);
+      GST_OBJECT_UNLOCK (self);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -414,12 +1047,40 @@ gst_video_inference_get_children_count (GstChildProxy * parent)
 static gboolean
 gst_video_inference_start (GstVideoInference * self)
 {
-  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean async_load;
   gboolean ret = TRUE;
-  GError *err = NULL;
+  guint queue_depth;
+  guint min_depth;
 
   GST_INFO_OBJECT (self, "Starting video inference");
+
+  GST_OBJECT_LOCK (self);
+  priv->pool_hits = 0;
+  priv->pool_misses = 0;
+  priv->queue_overflows = 0;
+
+  /* Every buffer held by a batch or in flight has its partner waiting
+   * in the other queue, they must not overflow meanwhile */
+  min_depth = priv->batch_size * priv->max_inflight + 1;
+  queue_depth = MAX (priv->queue_depth, min_depth);
+  if (queue_depth != priv->queue_depth) {
+    GST_WARNING_OBJECT (self, "A queue depth of %u is too small for a batch "
+        "size of %u and %u frames in flight, using %u instead",
+        priv->queue_depth, priv->batch_size, priv->max_inflight, queue_depth);
+  }
+
+  /* The queues are empty while stopped, resize them if needed */
+  if (gst_inference_ring_get_depth (priv->model_queue) != queue_depth) {
+    gst_inference_ring_free (priv->model_queue, NULL);
+    gst_inference_ring_free (priv->bypass_queue, NULL);
+    priv->model_queue = gst_inference_ring_new (queue_depth);
+    priv->bypass_queue = gst_inference_ring_new (queue_depth);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  video_inference_reset_qos (self);
+
   if (NULL == priv->model_location) {
     GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND,
         ("Model Location has not been set"), (NULL));
@@ -427,22 +1088,257 @@ gst_video_inference_start (GstVideoInference * self)
     goto out;
   }
 
+  GST_OBJECT_LOCK (self);
+  gst_base_backend_set_sharing (priv->backend, priv->model_sharing);
+  gst_base_backend_set_num_engines (priv->backend, priv->num_engines);
+  async_load = priv->async_load;
+  GST_OBJECT_UNLOCK (self);
+
+  /* A previous load that failed was never joined */
+  if (priv->loader) {
+    g_thread_join (priv->loader);
+    priv->loader = NULL;
+  }
+
+  g_mutex_lock (&priv->mtx_load);
+  priv->loading = async_load;
+  priv->loaded = FALSE;
+  priv->load_cancelled = FALSE;
+  g_mutex_unlock (&priv->mtx_load);
+
+  /* The loader is started once the state change returned ASYNC */
+  if (async_load) {
+    goto out;
+  }
+
+  ret = video_inference_load (self);
+
+  g_mutex_lock (&priv->mtx_load);
+  priv->loaded = ret;
+  g_mutex_unlock (&priv->mtx_load);
+
+out:
+  return ret;
+}
+
+static gboolean
+video_inference_load (GstVideoInference * self)
+{
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstStructure *times;
+  GError *err = NULL;
+  gboolean ret = TRUE;
+  guint iterations;
+  gint64 start;
+  GstClockTime load_time;
+  GstClockTime warmup_time;
+  gboolean started = FALSE;
+
+  GST_OBJECT_LOCK (self);
+  iterations = priv->warmup_iterations;
+  GST_OBJECT_UNLOCK (self);
+
+  start = g_get_monotonic_time ();
+
   if (!gst_base_backend_start (priv->backend, priv->model_location, &err)) {
     GST_ELEMENT_ERROR (self, LIBRARY, INIT,
         ("Could not start the selected backend: (%s)", err->message), (NULL));
-    ret = FALSE;
+    g_error_free (err);
+    return FALSE;
   }
 
   if (klass->start != NULL) {
     ret = klass->start (self);
   }
+  started = ret;
 
-out:
-  if (err)
+  load_time = (g_get_monotonic_time () - start) * GST_USECOND;
+  start = g_get_monotonic_time ();
+
+  if (ret) {
+    ret = video_inference_warmup (self, iterations);
+  }
+
+  warmup_time = (g_get_monotonic_time () - start) * GST_USECOND;
+
+  if (!ret) {
+    goto stop;
+  }
+
+  GST_INFO_OBJECT (self, "Model loaded in %" GST_TIME_FORMAT
+      ", warmed up in %" GST_TIME_FORMAT, GST_TIME_ARGS (load_time),
+      GST_TIME_ARGS (warmup_time));
+
+  times = gst_structure_new ("inference-load",
+      "load-time", GST_TYPE_CLOCK_TIME, load_time,
+      "warmup-time", GST_TYPE_CLOCK_TIME, warmup_time,
+      "warmup-iterations", G_TYPE_UINT, iterations, NULL);
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self), times));
+
+  video_inference_batch_timer_start (self);
+  video_inference_async_start (self);
+
+  return TRUE;
+
+stop:
+  /* Nothing stops the element when it failed to load */
+  if (started && klass->stop != NULL) {
+    klass->stop (self);
+  }
+
+  if (!gst_base_backend_stop (priv->backend, &err)) {
+    GST_WARNING_OBJECT (self, "Could not stop the selected backend: (%s)",
+        err->message);
     g_error_free (err);
+  }
+
+  return FALSE;
+}
+
+static gpointer
+video_inference_load_thread (gpointer data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean loaded;
+
+  GST_DEBUG_OBJECT (self, "Loading the model in the background");
+
+  loaded = video_inference_load (self);
+
+  g_mutex_lock (&priv->mtx_load);
+  priv->loading = FALSE;
+  priv->loaded = loaded;
+  g_cond_broadcast (&priv->cond_load);
+
+  /* Going back to READY takes over a load it interrupted */
+  if (!priv->load_cancelled) {
+    if (loaded) {
+      gst_element_continue_state (GST_ELEMENT (self),
+          GST_STATE_CHANGE_SUCCESS);
+      gst_element_post_message (GST_ELEMENT (self),
+          gst_message_new_async_done (GST_OBJECT (self),
+              GST_CLOCK_TIME_NONE));
+    } else {
+      gst_element_abort_state (GST_ELEMENT (self));
+    }
+  }
+  g_mutex_unlock (&priv->mtx_load);
+
+  return NULL;
+}
+
+static gboolean
+video_inference_warmup (GstVideoInference * self, guint iterations)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstInferenceTensorList *tensors = NULL;
+  GstVideoFrame frame;
+  GstVideoInfo info;
+  GstBuffer *buffer;
+  GError *err = NULL;
+  gboolean ret = TRUE;
+  guint num_engines;
+  gint width = 0;
+  gint height = 0;
+  guint i;
+
+  if (0 == iterations) {
+    return TRUE;
+  }
+
+  if (!video_inference_get_model_size (self, &width, &height)) {
+    GST_WARNING_OBJECT (self, "The model input size is not fixed, skipping "
+        "the warm-up");
+    return TRUE;
+  }
+
+  GST_OBJECT_LOCK (self);
+  num_engines = priv->num_engines;
+  GST_OBJECT_UNLOCK (self);
+
+  /* A blank tensor of the model size, laid out as the pre-processing
+   * leaves them */
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_RGB, width, height);
+  buffer = gst_buffer_new_allocate (NULL,
+      GST_VIDEO_INFO_SIZE (&info) * sizeof (gfloat), NULL);
+  gst_buffer_memset (buffer, 0, 0, gst_buffer_get_size (buffer));
+  gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ);
+
+  GST_DEBUG_OBJECT (self, "Running %u warm-up predictions on %u engines",
+      iterations, num_engines);
+
+  /* Idle engines are taken in turns, so this reaches all of them */
+  for (i = 0; i < iterations * num_engines; i++) {
+    if (!gst_base_backend_process_frame_tensors (priv->backend, &frame,
+            &tensors, &err)) {
+      GST_ELEMENT_ERROR (self, LIBRARY, INIT,
+          ("Could not warm up the selected backend: (%s)", err->message),
+          (NULL));
+      g_error_free (err);
+      ret = FALSE;
+      break;
+    }
+    gst_inference_tensor_list_free (tensors);
+  }
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_wait_loaded (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstFlowReturn ret;
+
+  g_mutex_lock (&priv->mtx_load);
+  while (priv->loading && !priv->load_cancelled) {
+    g_cond_wait (&priv->cond_load, &priv->mtx_load);
+  }
+
+  if (priv->loaded) {
+    ret = GST_FLOW_OK;
+  } else if (priv->load_cancelled) {
+    ret = GST_FLOW_FLUSHING;
+  } else {
+    ret = GST_FLOW_ERROR;
+  }
+  g_mutex_unlock (&priv->mtx_load);
+
   return ret;
 }
 
+/* Releases the streaming threads waiting for the model and waits for a
+ * background load to finish. Returns whether the model was loaded */
+static gboolean
+video_inference_cancel_load (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean loaded;
+
+  g_mutex_lock (&priv->mtx_load);
+  priv->load_cancelled = TRUE;
+  g_cond_broadcast (&priv->cond_load);
+  g_mutex_unlock (&priv->mtx_load);
+
+  if (priv->loader) {
+    g_thread_join (priv->loader);
+    priv->loader = NULL;
+  }
+
+  g_mutex_lock (&priv->mtx_load);
+  loaded = priv->loaded;
+  priv->loaded = FALSE;
+  g_mutex_unlock (&priv->mtx_load);
+
+  return loaded;
+}
+
 static gboolean
 gst_video_inference_stop (GstVideoInference * self)
 {
@@ -453,8 +1349,13 @@ gst_video_inference_stop (GstVideoInference * self)
 
   GST_INFO_OBJECT (self, "Stopping video inference");
 
-  video_inference_flush_queue (priv->model_queue, &priv->mtx_model_queue);
-  video_inference_flush_queue (priv->bypass_queue, &priv->mtx_bypass_queue);
+  video_inference_batch_timer_stop (self);
+  video_inference_async_stop (self);
+  video_inference_flush_queue (priv->model_queue);
+  video_inference_flush_queue (priv->bypass_queue);
+  video_inference_batch_clear (self);
+  video_inference_clear_pool (self);
+  video_inference_clear_cascade_tensor (self);
 
   if (!gst_base_backend_stop (priv->backend, &err)) {
     GST_ELEMENT_ERROR (self, LIBRARY, INIT,
@@ -476,6 +1377,8 @@ gst_video_inference_change_state (GstElement * element,
   GstStateChangeReturn ret;
   GstVideoInference *self = GST_VIDEO_INFERENCE (element);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean loaded = FALSE;
+  gboolean async_load;
 
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
@@ -488,8 +1391,20 @@ gst_video_inference_change_state (GstElement * element,
       gst_collect_pads_start (priv->cpads);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+#if GST_VERSION_MINOR >= 14
+      /* What an asynchronous load that failed or was interrupted leads to */
+    case GST_STATE_CHANGE_READY_TO_READY:
+#endif
+      /* Release a streaming thread waiting for the model or for the
+       * inference worker */
+      loaded = video_inference_cancel_load (self);
+      video_inference_async_set_flushing (self, TRUE);
       gst_collect_pads_stop (priv->cpads);
       break;
+    case GST_STATE_CHANGE_READY_TO_NULL:
+      /* The loader of a failed load, left over without READY_TO_READY */
+      loaded = video_inference_cancel_load (self);
+      break;
     default:
       break;
   }
@@ -503,8 +1418,27 @@ gst_video_inference_change_state (GstElement * element,
   }
 
   switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      /* Started only once the parent changed state, so the loader
+       * commits or aborts a transition that is already under way */
+      g_mutex_lock (&priv->mtx_load);
+      async_load = priv->loading;
+      g_mutex_unlock (&priv->mtx_load);
+
+      if (async_load) {
+        gst_element_post_message (element,
+            gst_message_new_async_start (GST_OBJECT (self)));
+        priv->loader = g_thread_new ("inference-loader",
+            video_inference_load_thread, self);
+        ret = GST_STATE_CHANGE_ASYNC;
+      }
+      break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      if (FALSE == gst_video_inference_stop (self)) {
+#if GST_VERSION_MINOR >= 14
+    case GST_STATE_CHANGE_READY_TO_READY:
+#endif
+    case GST_STATE_CHANGE_READY_TO_NULL:
+      if (loaded && FALSE == gst_video_inference_stop (self)) {
         GST_ERROR_OBJECT (self, "Subclass failed to stop");
         ret = GST_STATE_CHANGE_FAILURE;
         goto out;
@@ -695,37 +1629,247 @@ gst_video_inference_forward_buffer (GstVideoInference * self,
   return ret;
 }
 
-static void
-video_inference_map_buffers (GstVideoInferencePad * cpad, GstBuffer * inbuf,
-    GstVideoFrame * inframe, GstVideoFrame * outframe)
+static GstBufferPool *
+video_inference_create_pool (GstVideoInference * self, gsize size,
+    guint depth)
 {
-  GstVideoInfo *info;
+  GstBufferPool *pool;
+  GstStructure *config;
   GstAllocationParams params;
-  GstBuffer *outbuf;
-  gsize size;
-  GstMapFlags inflags;
-  GstMapFlags outflags;
 
-  g_return_if_fail (cpad);
-  g_return_if_fail (inbuf);
-  g_return_if_fail (inframe);
-  g_return_if_fail (outframe);
+  g_return_val_if_fail (self, NULL);
 
-  info = &(cpad->info);
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
 
-  /* Allocate an output buffer for the pre-processed data */
   gst_allocation_params_init (&params);
-  size = gst_buffer_get_size (inbuf);
-  outbuf = gst_buffer_new_allocate (NULL, size * sizeof (float), &params);
+  gst_buffer_pool_config_set_params (config, NULL, size, depth, depth);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
 
-  /* Map buffers into their respective output frames but dont increase
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    GST_WARNING_OBJECT (self, "Unable to configure the tensor pool");
+    goto free_pool;
+  }
+
+  if (!gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_WARNING_OBJECT (self, "Unable to activate the tensor pool");
+    goto free_pool;
+  }
+
+  GST_INFO_OBJECT (self, "Created tensor pool of %u buffers of %"
+      G_GSIZE_FORMAT " bytes", depth, size);
+
+  return pool;
+
+free_pool:
+  gst_object_unref (pool);
+  return NULL;
+}
+
+static void
+video_inference_clear_pool (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstBufferPool *pool;
+
+  GST_OBJECT_LOCK (self);
+  pool = priv->pool;
+  priv->pool = NULL;
+  priv->pool_buffer_size = 0;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Outstanding buffers keep a reference to the pool, it will be
+   * released once they are all returned
+   */
+  if (pool) {
+    gst_buffer_pool_set_active (pool, FALSE);
+    gst_object_unref (pool);
+  }
+}
+
+static GstBuffer *
+video_inference_acquire_tensor (GstVideoInference * self, GstVideoInfo * info,
+    gsize size)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstBufferPool *pool = NULL;
+  GstBuffer *outbuf = NULL;
+  GstBufferPoolAcquireParams acquire_params = { 0, };
+  GstAllocationParams params;
+  gsize pool_buffer_size;
+  guint depth;
+
+  g_return_val_if_fail (info, NULL);
+
+  GST_OBJECT_LOCK (self);
+  depth = MAX (priv->pool_size, priv->batch_size);
+  if (priv->pool) {
+    pool = (GstBufferPool *) gst_object_ref (priv->pool);
+  }
+  pool_buffer_size = priv->pool_buffer_size;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Lazily size the pool from the negotiated model caps */
+  if (NULL == pool && GST_VIDEO_INFO_FORMAT (info) != GST_VIDEO_FORMAT_UNKNOWN) {
+    pool_buffer_size = GST_VIDEO_INFO_SIZE (info) * sizeof (float);
+    pool = video_inference_create_pool (self, pool_buffer_size, depth);
+
+    if (pool) {
+      GST_OBJECT_LOCK (self);
+      if (NULL == priv->pool) {
+        priv->pool = (GstBufferPool *) gst_object_ref (pool);
+        priv->pool_buffer_size = pool_buffer_size;
+      }
+      GST_OBJECT_UNLOCK (self);
+    }
+  }
+
+  if (pool && size <= pool_buffer_size) {
+    acquire_params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    if (GST_FLOW_OK != gst_buffer_pool_acquire_buffer (pool, &outbuf,
+            &acquire_params)) {
+      outbuf = NULL;
+    }
+  }
+
+  if (pool) {
+    gst_object_unref (pool);
+  }
+
+  if (outbuf) {
+    GST_OBJECT_LOCK (self);
+    priv->pool_hits++;
+    GST_OBJECT_UNLOCK (self);
+    return outbuf;
+  }
+
+  GST_LOG_OBJECT (self, "Tensor pool exhausted, allocating a new buffer");
+
+  GST_OBJECT_LOCK (self);
+  priv->pool_misses++;
+  GST_OBJECT_UNLOCK (self);
+
+  gst_allocation_params_init (&params);
+  return gst_buffer_new_allocate (NULL, size, &params);
+}
+
+static void
+video_inference_map_buffers (GstVideoInference * self,
+    GstVideoInferencePad * cpad, GstBuffer * inbuf, GstVideoFrame * inframe,
+    GstVideoFrame * outframe)
+{
+  GstVideoInferencePrivate *priv;
+  GstVideoInfo *info;
+  GstVideoInfo *outinfo;
+  GstBuffer *outbuf;
+  gsize size;
+  GstMapFlags inflags;
+  GstMapFlags outflags;
+
+  g_return_if_fail (self);
+  g_return_if_fail (cpad);
+  g_return_if_fail (inbuf);
+  g_return_if_fail (inframe);
+  g_return_if_fail (outframe);
+
+  priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  info = &(cpad->info);
+
+  /* The fused preprocess writes a tensor of the model size and format,
+   * otherwise the tensor mirrors the input frame
+   */
+  if (priv->fused) {
+    outinfo = &(priv->model_info);
+    size = GST_VIDEO_INFO_SIZE (outinfo);
+  } else {
+    outinfo = info;
+    size = gst_buffer_get_size (inbuf);
+  }
+
+  /* Get an output buffer for the pre-processed data, reusing pooled
+   * tensors whenever possible
+   */
+  outbuf =
+      video_inference_acquire_tensor (self, outinfo, size * sizeof (float));
+
+  /* Map buffers into their respective output frames but dont increase
    * the refcount so we can add metas later on.
    */
   inflags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
   gst_video_frame_map (inframe, info, inbuf, inflags);
 
   outflags = (GstMapFlags) (GST_MAP_WRITE | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
-  gst_video_frame_map (outframe, info, outbuf, outflags);
+  gst_video_frame_map (outframe, outinfo, outbuf, outflags);
+}
+
+static gboolean
+video_inference_get_model_size (GstVideoInference * self, gint * width,
+    gint * height)
+{
+  GstPadTemplate *templ;
+  GstCaps *caps;
+  gboolean found = FALSE;
+  guint i;
+
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (width, FALSE);
+  g_return_val_if_fail (height, FALSE);
+
+  templ =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self),
+      "sink_model");
+  if (NULL == templ) {
+    return FALSE;
+  }
+
+  /* The model input size is the first fixed size in the template */
+  caps = gst_pad_template_get_caps (templ);
+  for (i = 0; i < gst_caps_get_size (caps) && !found; i++) {
+    GstStructure *st = gst_caps_get_structure (caps, i);
+
+    found = gst_structure_get_int (st, "width", width)
+        && gst_structure_get_int (st, "height", height);
+  }
+  gst_caps_unref (caps);
+
+  return found;
+}
+
+static void
+video_inference_configure_tensor (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstVideoInfo * info)
+{
+  gint width = 0;
+  gint height = 0;
+
+  g_return_if_fail (self);
+  g_return_if_fail (priv);
+  g_return_if_fail (info);
+
+  priv->fused = FALSE;
+
+  if (!video_inference_get_model_size (self, &width, &height)) {
+    width = GST_VIDEO_INFO_WIDTH (info);
+    height = GST_VIDEO_INFO_HEIGHT (info);
+  }
+
+  /* Cascaded regions are always converted and scaled to the model */
+  gst_video_info_set_format (&priv->roi_info, GST_VIDEO_FORMAT_RGB, width,
+      height);
+
+  /* RGB frames are given to the model at their negotiated size, so a
+   * template with size ranges lets the model run at other resolutions */
+  if (!GST_VIDEO_INFO_IS_YUV (info)) {
+    return;
+  }
+
+  GST_INFO_OBJECT (self, "Converting %s %dx%d input to a RGB %dx%d tensor",
+      GST_VIDEO_INFO_NAME (info), GST_VIDEO_INFO_WIDTH (info),
+      GST_VIDEO_INFO_HEIGHT (info), width, height);
+
+  gst_video_info_set_format (&priv->model_info, GST_VIDEO_FORMAT_RGB, width,
+      height);
+  priv->fused = TRUE;
 }
 
 static gboolean
@@ -757,8 +1901,8 @@ gst_video_inference_preprocess (GstVideoInference * self,
 
 static gboolean
 gst_video_inference_predict (GstVideoInference * self,
-    GstVideoInferencePrivate * priv, GstVideoFrame * frame, gpointer * pred,
-    gsize * pred_size)
+    GstVideoInferencePrivate * priv, GstVideoFrame * frame,
+    GstInferenceTensorList ** pred)
 {
   GError *error = NULL;
 
@@ -766,11 +1910,10 @@ gst_video_inference_predict (GstVideoInference * self,
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (frame, FALSE);
   g_return_val_if_fail (pred, FALSE);
-  g_return_val_if_fail (pred_size, FALSE);
 
   GST_LOG_OBJECT (self, "Running prediction on frame");
 
-  if (!gst_base_backend_process_frame (priv->backend, frame, pred, pred_size,
+  if (!gst_base_backend_process_frame_tensors (priv->backend, frame, pred,
           &error)) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED,
         ("Could not process using the selected backend: (%s)", error->message),
@@ -785,7 +1928,7 @@ gst_video_inference_predict (GstVideoInference * self,
 static gboolean
 gst_video_inference_model_run_prediction (GstVideoInference * self,
     GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
-    GstBuffer * buffer, gpointer * prediction_data, gsize * prediction_size)
+    GstBuffer * buffer, GstInferenceTensorList ** prediction)
 {
   GstVideoFrame inframe, outframe;
   GstBuffer *outbuf;
@@ -795,10 +1938,9 @@ gst_video_inference_model_run_prediction (GstVideoInference * self,
   g_return_val_if_fail (klass, FALSE);
   g_return_val_if_fail (priv, FALSE);
   g_return_val_if_fail (buffer, FALSE);
-  g_return_val_if_fail (prediction_data, FALSE);
-  g_return_val_if_fail (prediction_size, FALSE);
+  g_return_val_if_fail (prediction, FALSE);
 
-  video_inference_map_buffers (priv->sink_model_data, buffer, &inframe,
+  video_inference_map_buffers (self, priv->sink_model_data, buffer, &inframe,
       &outframe);
   outbuf = outframe.buffer;
 
@@ -807,8 +1949,7 @@ gst_video_inference_model_run_prediction (GstVideoInference * self,
     goto free_frames;
   }
 
-  if (!gst_video_inference_predict (self, priv, &outframe, prediction_data,
-          prediction_size)) {
+  if (!gst_video_inference_predict (self, priv, &outframe, prediction)) {
     ret = FALSE;
     goto free_frames;
   }
@@ -828,6 +1969,7 @@ video_inference_prepare_postprocess (GstBuffer * buffer,
     GstVideoInfo * video_info, GstMeta ** out_meta)
 {
   GstInferenceMeta *imeta = NULL;
+  GstInferencePrediction *root = NULL;
 
   g_return_val_if_fail (buffer, FALSE);
   g_return_val_if_fail (video_info, FALSE);
@@ -841,13 +1983,134 @@ video_inference_prepare_postprocess (GstBuffer * buffer,
         gst_buffer_add_meta (buffer, gst_inference_meta_get_info (), NULL);
 
     imeta = (GstInferenceMeta *) *out_meta;
-    imeta->prediction->bbox.width = video_info->width;
-    imeta->prediction->bbox.height = video_info->height;
+    root = gst_inference_meta_get_prediction (imeta);
+    root->bbox.width = video_info->width;
+    root->bbox.height = video_info->height;
   }
 
   return TRUE;
 }
 
+/* Hands a tree to the meta and returns the one it had. The meta takes
+ * the only reference to the new tree, so the subclass writes to it in
+ * place rather than to a copy */
+static GstInferencePrediction *
+video_inference_swap_prediction (GstInferenceMeta * imeta,
+    GstInferencePrediction * prediction)
+{
+  GstInferencePrediction *previous;
+
+  previous =
+      gst_inference_prediction_ref (gst_inference_meta_get_prediction (imeta));
+  gst_inference_meta_set_prediction (imeta, prediction);
+
+  return previous;
+}
+
+static gboolean
+video_inference_fused_postprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstInferenceTensorList * prediction, GstMeta * meta_model,
+    GstVideoInfo * info_model, gboolean * pred_valid)
+{
+  GstInferenceMeta *imeta = (GstInferenceMeta *) meta_model;
+  GstInferencePrediction *root;
+  GstInferencePrediction *scratch;
+  gboolean ret;
+
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (klass, FALSE);
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (meta_model, FALSE);
+  g_return_val_if_fail (info_model, FALSE);
+  g_return_val_if_fail (pred_valid, FALSE);
+
+  /* The subclass decodes in tensor coordinates, so let it fill a scratch
+   * root of the tensor size and bring the results back to the input
+   * frame afterwards
+   */
+  root = gst_inference_meta_get_prediction (imeta);
+  scratch = gst_inference_prediction_new ();
+  scratch->prediction_id = root->prediction_id;
+  scratch->bbox.width = GST_VIDEO_INFO_WIDTH (&priv->model_info);
+  scratch->bbox.height = GST_VIDEO_INFO_HEIGHT (&priv->model_info);
+
+  root = video_inference_swap_prediction (imeta, scratch);
+  ret = video_inference_postprocess (self, klass, priv, prediction,
+      meta_model, &priv->model_info, pred_valid);
+  scratch = video_inference_swap_prediction (imeta, root);
+
+  if (ret) {
+    gst_inference_prediction_scale_ip (scratch, info_model, &priv->model_info);
+    gst_inference_prediction_merge (scratch, root);
+  }
+
+  gst_inference_prediction_unref (scratch);
+
+  return ret;
+}
+
+static gboolean
+video_inference_postprocess (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstInferenceTensorList * prediction, GstMeta * meta_model,
+    GstVideoInfo * info_model, gboolean * pred_valid)
+{
+  GstInferenceLabels *labels = NULL;
+  gchar **labels_list = NULL;
+  gint num_labels = 0;
+  gpointer prediction_data = NULL;
+  gsize prediction_size = 0;
+  gboolean ret;
+
+  g_return_val_if_fail (self, FALSE);
+  g_return_val_if_fail (klass, FALSE);
+  g_return_val_if_fail (priv, FALSE);
+  g_return_val_if_fail (prediction, FALSE);
+  g_return_val_if_fail (meta_model, FALSE);
+
+  /* Subclasses write straight into the tree, so it must not be shared
+   * with other buffers nor wait for a scale anymore */
+  gst_inference_meta_get_prediction ((GstInferenceMeta *) meta_model);
+
+  /* Hold the table so the labels property can change meanwhile */
+  labels = gst_video_inference_get_labels (self);
+  if (labels) {
+    labels_list = labels->labels;
+    num_labels = labels->num_labels;
+  }
+
+  if (klass->postprocess_tensors) {
+    ret = klass->postprocess_tensors (self, prediction->tensors,
+        prediction->num_tensors, meta_model, info_model, pred_valid,
+        labels_list, num_labels);
+    goto out;
+  }
+
+  /* Subclasses that haven't moved to the tensor list expect all the
+   * outputs one after the other */
+  if (1 == prediction->num_tensors) {
+    ret = klass->postprocess (self,
+        (const gpointer) prediction->tensors[0].data,
+        prediction->tensors[0].size, meta_model, info_model, pred_valid,
+        labels_list, num_labels);
+    goto out;
+  }
+
+  prediction_data =
+      gst_inference_tensor_list_concat (prediction, &prediction_size);
+  ret = klass->postprocess (self, prediction_data, prediction_size,
+      meta_model, info_model, pred_valid, labels_list, num_labels);
+  g_free (prediction_data);
+
+out:
+  if (labels) {
+    gst_inference_labels_unref (labels);
+  }
+
+  return ret;
+}
+
 static GstMeta *
 video_inference_transform_meta (GstBuffer * buffer_model,
     GstVideoInfo * info_model, GstMeta * meta_model, GstBuffer * buffer_bypass,
@@ -857,25 +2120,962 @@ video_inference_transform_meta (GstBuffer * buffer_model,
   const GstMetaInfo *info;
   GstVideoMetaTransform trans = { info_model, info_bypass };
 
-  g_return_val_if_fail (buffer_model, NULL);
-  g_return_val_if_fail (info_model, NULL);
-  g_return_val_if_fail (meta_model, NULL);
+  g_return_val_if_fail (buffer_model, NULL);
+  g_return_val_if_fail (info_model, NULL);
+  g_return_val_if_fail (meta_model, NULL);
+
+  if (NULL == info_bypass || NULL == buffer_bypass) {
+    return meta_bypass;
+  }
+
+  info = meta_model->info;
+
+  /* TODO: elements such as videoscale will drop metas that have tags
+     such as video-size. Until this is fixed, tread all
+     transformations as scaling transformations
+   */
+  info->transform_func (buffer_bypass, meta_model, buffer_model,
+      _scale_quark, &trans);
+  meta_bypass = gst_buffer_get_meta (buffer_bypass, info->api);
+
+  return meta_bypass;
+}
+
+static GstFlowReturn
+video_inference_finish_model (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad,
+    GstInferenceTensorList * prediction)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstMeta *meta_model = NULL;
+  GstVideoInfo *info_model = NULL;
+  gboolean pred_valid = FALSE;
+  gboolean new_meta;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (klass != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  /* Assign already created inferencemeta, no need to create a new one */
+  meta_model =
+      gst_buffer_get_meta (buffer_model, gst_inference_meta_api_get_type ());
+  new_meta = NULL == meta_model;
+
+  /* Prepare postprocess */
+  info_model = &(pad->info);
+  if (!video_inference_prepare_postprocess (buffer_model, info_model,
+          &meta_model)) {
+    ret = GST_FLOW_ERROR;
+    goto buffer_free;
+  }
+
+  /* Subclass Processing */
+  if (priv->fused) {
+    if (!video_inference_fused_postprocess (self, klass, priv, prediction,
+            meta_model, info_model, &pred_valid)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          ("Subclass failed at preprocess"), (NULL));
+      ret = GST_FLOW_ERROR;
+      goto buffer_free;
+    }
+  } else if (!video_inference_postprocess (self, klass, priv, prediction,
+          meta_model, info_model, &pred_valid)) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED, ("Subclass failed at preprocess"),
+        (NULL));
+    ret = GST_FLOW_ERROR;
+    goto buffer_free;
+  }
+
+  /* Only trees this element started can be replayed on skipped frames,
+   * predictions attached to upstream ones change with every frame */
+  if (new_meta) {
+    video_inference_store_prediction (self, priv,
+        gst_inference_meta_get_prediction ((GstInferenceMeta *) meta_model));
+  }
+
+  return video_inference_output_model (self, priv, buffer_model, meta_model,
+      pad);
+
+buffer_free:
+  gst_buffer_unref (buffer_model);
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_output_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstMeta * meta_model, GstVideoInferencePad * pad)
+{
+  GstInferenceMeta *imeta = (GstInferenceMeta *) meta_model;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  /* Check if bypass pad was requested, if not, forward buffer */
+  if (NULL == priv->sink_bypass) {
+    GST_LOG_OBJECT (self,
+        "There is no sinkpad for bypass, forwarding model buffer...");
+    return gst_video_inference_forward_buffer (self, buffer_model,
+        priv->src_model);
+  }
+
+  /* Keep current Stream ID, the buffer may be consumed as soon as it is
+   * queued */
+  if (imeta) {
+    g_free (imeta->stream_id);
+    imeta->stream_id = gst_pad_get_stream_id (pad->data.pad);
+  }
+
+  /* Queue buffer */
+  GST_LOG_OBJECT (self, "Queue model buffer");
+  return video_inference_queue_push (self, priv, priv->model_queue,
+      buffer_model, priv->src_model);
+}
+
+static void
+video_inference_store_prediction (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferencePrediction * prediction)
+{
+  GstInferencePrediction *last = NULL;
+  gboolean keep;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (priv != NULL);
+  g_return_if_fail (prediction != NULL);
+
+  GST_OBJECT_LOCK (self);
+  keep = priv->inference_interval > 1 || priv->qos;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Avoid copying the tree when no frame will ever be skipped */
+  if (keep) {
+    last = gst_inference_prediction_copy (prediction);
+  }
+
+  GST_OBJECT_LOCK (self);
+  if (priv->last_prediction) {
+    gst_inference_prediction_unref (priv->last_prediction);
+  }
+  priv->last_prediction = last;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static gboolean
+video_inference_should_skip (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad)
+{
+  GstClockTime running_time;
+  GstClockTime earliest_time;
+  guint interval;
+  gboolean qos;
+  gboolean skip = FALSE;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (priv != NULL, FALSE);
+  g_return_val_if_fail (buffer_model != NULL, FALSE);
+  g_return_val_if_fail (pad != NULL, FALSE);
+
+  GST_OBJECT_LOCK (self);
+  interval = priv->inference_interval;
+  qos = priv->qos;
+  earliest_time = priv->earliest_time;
+  GST_OBJECT_UNLOCK (self);
+
+  if (priv->frames_skipped + 1 < interval) {
+    skip = TRUE;
+  } else if (qos) {
+    running_time = gst_segment_to_running_time (&pad->data.segment,
+        GST_FORMAT_TIME, GST_BUFFER_PTS (buffer_model));
+
+    if (GST_CLOCK_TIME_IS_VALID (running_time)
+        && GST_CLOCK_TIME_IS_VALID (earliest_time)
+        && running_time <= earliest_time) {
+      GST_DEBUG_OBJECT (self, "Skipping late frame at %" GST_TIME_FORMAT
+          ", earliest %" GST_TIME_FORMAT, GST_TIME_ARGS (running_time),
+          GST_TIME_ARGS (earliest_time));
+      skip = TRUE;
+    }
+
+    /* Keep latency bounded instead of blocking on a busy worker */
+    g_mutex_lock (&priv->mtx_inflight);
+    if (priv->worker_running
+        && priv->inflight_tensors >= priv->max_inflight) {
+      GST_DEBUG_OBJECT (self, "Inference queue full, skipping frame");
+      skip = TRUE;
+    }
+    g_mutex_unlock (&priv->mtx_inflight);
+  }
+
+  if (skip) {
+    priv->frames_skipped++;
+  } else {
+    priv->frames_skipped = 0;
+  }
+
+  return skip;
+}
+
+static GstFlowReturn
+video_inference_skip_model (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad)
+{
+  GstInferencePrediction *last = NULL;
+  GstInferencePrediction *root;
+  GstInferencePrediction *copy;
+  GstMeta *meta_model;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  meta_model =
+      gst_buffer_get_meta (buffer_model, gst_inference_meta_api_get_type ());
+
+  /* Frames that already have a tree go through untouched */
+  if (NULL == meta_model) {
+    if (!video_inference_prepare_postprocess (buffer_model, &(pad->info),
+            &meta_model)) {
+      gst_buffer_unref (buffer_model);
+      return GST_FLOW_ERROR;
+    }
+
+    GST_OBJECT_LOCK (self);
+    if (priv->last_prediction) {
+      last = gst_inference_prediction_ref (priv->last_prediction);
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    /* Replay the last tree under this frame's own root */
+    if (last) {
+      root =
+          gst_inference_meta_get_prediction ((GstInferenceMeta *) meta_model);
+      copy = gst_inference_prediction_copy (last);
+      copy->prediction_id = root->prediction_id;
+      gst_inference_prediction_merge (copy, root);
+      gst_inference_prediction_unref (copy);
+      gst_inference_prediction_unref (last);
+    }
+  }
+
+  GST_LOG_OBJECT (self, "Skipped inference on model buffer");
+
+  return video_inference_output_model (self, priv, buffer_model, meta_model,
+      pad);
+}
+
+static void
+video_inference_reset_qos (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  GST_OBJECT_LOCK (self);
+  priv->earliest_time = GST_CLOCK_TIME_NONE;
+  if (priv->last_prediction) {
+    gst_inference_prediction_unref (priv->last_prediction);
+    priv->last_prediction = NULL;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  /* Never skip the first frame */
+  priv->frames_skipped = MAX_INFERENCE_INTERVAL;
+}
+
+static gboolean
+video_inference_prepare_entry (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstBuffer * buffer_model,
+    GstVideoInferencePad * pad, VideoInferenceBatchEntry * entry)
+{
+  GstVideoFrame inframe;
+  GstBuffer *outbuf;
+  gboolean preprocessed;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (klass != NULL, FALSE);
+  g_return_val_if_fail (buffer_model != NULL, FALSE);
+  g_return_val_if_fail (pad != NULL, FALSE);
+  g_return_val_if_fail (entry != NULL, FALSE);
+
+  /* Pre-process right away so pending entries only hold ready tensors */
+  video_inference_map_buffers (self, pad, buffer_model, &inframe,
+      &entry->tensor);
+  outbuf = entry->tensor.buffer;
+
+  preprocessed =
+      gst_video_inference_preprocess (self, klass, &inframe, &entry->tensor);
+  gst_video_frame_unmap (&inframe);
+
+  if (!preprocessed) {
+    gst_video_frame_unmap (&entry->tensor);
+    gst_buffer_unref (outbuf);
+    return FALSE;
+  }
+
+  entry->buffer = buffer_model;
+  entry->skip = FALSE;
+
+  return TRUE;
+}
+
+static void
+video_inference_clear_entry (VideoInferenceBatchEntry * entry)
+{
+  GstBuffer *outbuf;
+
+  g_return_if_fail (entry != NULL);
+
+  if (!entry->skip) {
+    outbuf = entry->tensor.buffer;
+    gst_video_frame_unmap (&entry->tensor);
+    gst_buffer_unref (outbuf);
+    entry->skip = TRUE;
+  }
+
+  if (entry->buffer) {
+    gst_buffer_unref (entry->buffer);
+    entry->buffer = NULL;
+  }
+}
+
+static GstFlowReturn
+video_inference_batch_push (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad, gboolean skip)
+{
+  VideoInferenceBatchEntry entry = { NULL, };
+  guint batch_size;
+  guint64 batch_timeout;
+  guint64 elapsed;
+  guint num_tensors = 0;
+  guint i;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (klass != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  /* A batch the timer ran may have failed downstream */
+  if (GST_FLOW_OK != priv->batch_timer_ret) {
+    gst_buffer_unref (buffer_model);
+    return priv->batch_timer_ret;
+  }
+
+  /* Skipped frames wait in the batch to keep their order */
+  if (skip) {
+    entry.buffer = buffer_model;
+    entry.skip = TRUE;
+  } else if (!video_inference_prepare_entry (self, klass, buffer_model, pad,
+          &entry)) {
+    gst_buffer_unref (buffer_model);
+    return GST_FLOW_ERROR;
+  }
+
+  GST_OBJECT_LOCK (self);
+  batch_size = priv->batch_size;
+  batch_timeout = priv->batch_timeout;
+  GST_OBJECT_UNLOCK (self);
+
+  /* The oldest buffer must not wait for the next one past the timeout,
+   * a stalled source may never send it */
+  if (0 == priv->batch->len) {
+    priv->batch_start = g_get_monotonic_time ();
+    if (batch_size > 1 && batch_timeout > 0) {
+      video_inference_batch_set_deadline (self, priv->batch_start +
+          batch_timeout / GST_USECOND);
+    }
+  }
+
+  g_array_append_val (priv->batch, entry);
+
+  for (i = 0; i < priv->batch->len; i++) {
+    if (!g_array_index (priv->batch, VideoInferenceBatchEntry, i).skip) {
+      num_tensors++;
+    }
+  }
+
+  elapsed = (g_get_monotonic_time () - priv->batch_start) * GST_USECOND;
+
+  GST_LOG_OBJECT (self, "Batched model buffer %u of %u", num_tensors,
+      batch_size);
+
+  if (num_tensors >= batch_size || (batch_timeout > 0
+          && elapsed >= batch_timeout)) {
+    return video_inference_batch_flush (self);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+video_inference_predict_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries,
+    GstInferenceTensorList ** predictions)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoFrame **frames;
+  GError *error = NULL;
+  gboolean predicted = TRUE;
+  guint num_tensors = 0;
+  guint i;
+
+  g_return_val_if_fail (entries != NULL, FALSE);
+  g_return_val_if_fail (predictions != NULL, FALSE);
+
+  frames = g_new (GstVideoFrame *, num_entries);
+
+  for (i = 0; i < num_entries; i++) {
+    if (!entries[i].skip) {
+      frames[num_tensors++] = &entries[i].tensor;
+    }
+  }
+
+  GST_LOG_OBJECT (self, "Running prediction on a batch of %u frames",
+      num_tensors);
+
+  if (num_tensors > 0) {
+    predicted = gst_base_backend_process_batch (priv->backend, frames,
+        num_tensors, predictions, &error);
+  }
+  if (!predicted) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        ("Could not process using the selected backend: (%s)", error->message),
+        (NULL));
+    g_error_free (error);
+  }
+
+  g_free (frames);
+
+  return predicted;
+}
+
+static GstFlowReturn
+video_inference_finish_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries,
+    GstInferenceTensorList ** predictions, gboolean predicted)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
+  GstFlowReturn ret = predicted ? GST_FLOW_OK : GST_FLOW_ERROR;
+  GstBuffer *buffer_model;
+  guint i, j;
+
+  g_return_val_if_fail (entries != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (predictions != NULL, GST_FLOW_ERROR);
+
+  /* Scatter the results in arrival order so timestamps stay monotonic */
+  for (i = 0, j = 0; i < num_entries; i++) {
+    buffer_model = entries[i].buffer;
+    entries[i].buffer = NULL;
+
+    if (entries[i].skip) {
+      if (predicted && GST_FLOW_OK == ret) {
+        ret = video_inference_skip_model (self, priv, buffer_model,
+            priv->sink_model_data);
+      } else {
+        gst_buffer_unref (buffer_model);
+      }
+      continue;
+    }
+
+    video_inference_clear_entry (&entries[i]);
+
+    if (predicted && GST_FLOW_OK == ret) {
+      ret = video_inference_finish_model (self, klass, priv, buffer_model,
+          priv->sink_model_data, predictions[j]);
+    } else {
+      gst_buffer_unref (buffer_model);
+    }
+
+    if (predictions[j]) {
+      gst_inference_tensor_list_free (predictions[j]);
+      predictions[j] = NULL;
+    }
+    j++;
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_run_batch (GstVideoInference * self,
+    VideoInferenceBatchEntry * entries, guint num_entries)
+{
+  GstInferenceTensorList **predictions;
+  GstFlowReturn ret;
+  gboolean predicted;
+
+  g_return_val_if_fail (entries != NULL, GST_FLOW_ERROR);
+
+  if (0 == num_entries) {
+    return GST_FLOW_OK;
+  }
+
+  predictions = g_new0 (GstInferenceTensorList *, num_entries);
+
+  predicted = video_inference_predict_batch (self, entries, num_entries,
+      predictions);
+  ret = video_inference_finish_batch (self, entries, num_entries,
+      predictions, predicted);
+
+  g_free (predictions);
+
+  return ret;
+}
+
+static GstFlowReturn
+video_inference_batch_flush (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstFlowReturn ret;
+
+  video_inference_batch_set_deadline (self, 0);
+
+  ret = video_inference_run_batch (self,
+      (VideoInferenceBatchEntry *) priv->batch->data, priv->batch->len);
+  g_array_set_size (priv->batch, 0);
+
+  return ret;
+}
+
+static void
+video_inference_batch_clear (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  guint i;
+
+  for (i = 0; i < priv->batch->len; i++) {
+    video_inference_clear_entry (&g_array_index (priv->batch,
+            VideoInferenceBatchEntry, i));
+  }
+
+  g_array_set_size (priv->batch, 0);
+  video_inference_batch_set_deadline (self, 0);
+  priv->batch_timer_ret = GST_FLOW_OK;
+}
+
+static void
+video_inference_batch_set_deadline (GstVideoInference * self, gint64 deadline)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  g_mutex_lock (&priv->mtx_batch);
+  priv->batch_deadline = deadline;
+  g_cond_broadcast (&priv->cond_batch);
+  g_mutex_unlock (&priv->mtx_batch);
+}
+
+static gpointer
+video_inference_batch_timer (gpointer data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstFlowReturn ret;
+  gboolean expired;
+
+  g_mutex_lock (&priv->mtx_batch);
+  while (priv->batch_timer_running) {
+    if (0 == priv->batch_deadline) {
+      g_cond_wait (&priv->cond_batch, &priv->mtx_batch);
+      continue;
+    }
+
+    if (g_get_monotonic_time () < priv->batch_deadline) {
+      g_cond_wait_until (&priv->cond_batch, &priv->mtx_batch,
+          priv->batch_deadline);
+      continue;
+    }
+    g_mutex_unlock (&priv->mtx_batch);
+
+    /* The streaming thread may have run the batch meanwhile, the
+     * deadline is only still there if it didn't */
+    GST_COLLECT_PADS_STREAM_LOCK (priv->cpads);
+    g_mutex_lock (&priv->mtx_batch);
+    expired = priv->batch_timer_running && 0 != priv->batch_deadline
+        && g_get_monotonic_time () >= priv->batch_deadline;
+    g_mutex_unlock (&priv->mtx_batch);
+
+    if (expired) {
+      GST_LOG_OBJECT (self, "Batch timeout expired, running %u buffers",
+          priv->batch->len);
+      ret = video_inference_batch_flush (self);
+      if (GST_FLOW_OK == priv->batch_timer_ret) {
+        priv->batch_timer_ret = ret;
+      }
+    }
+    GST_COLLECT_PADS_STREAM_UNLOCK (priv->cpads);
+
+    g_mutex_lock (&priv->mtx_batch);
+  }
+  g_mutex_unlock (&priv->mtx_batch);
+
+  return NULL;
+}
+
+static void
+video_inference_batch_timer_start (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  g_mutex_lock (&priv->mtx_batch);
+  priv->batch_timer_running = TRUE;
+  priv->batch_deadline = 0;
+  g_mutex_unlock (&priv->mtx_batch);
+
+  priv->batch_timer_ret = GST_FLOW_OK;
+  priv->batch_timer = g_thread_new ("inference-batch",
+      video_inference_batch_timer, self);
+}
+
+static void
+video_inference_batch_timer_stop (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  if (NULL == priv->batch_timer) {
+    return;
+  }
+
+  g_mutex_lock (&priv->mtx_batch);
+  priv->batch_timer_running = FALSE;
+  g_cond_broadcast (&priv->cond_batch);
+  g_mutex_unlock (&priv->mtx_batch);
+
+  g_thread_join (priv->batch_timer);
+  priv->batch_timer = NULL;
+}
+
+static GstFlowReturn
+video_inference_async_push (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad, gboolean skip)
+{
+  VideoInferenceBatchEntry *entry;
+  GstFlowReturn ret;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (klass != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
+
+  entry = g_new0 (VideoInferenceBatchEntry, 1);
+
+  /* Skipped frames go through the queue too to keep their order, but
+   * they hold no tensor and never wait for room */
+  if (skip) {
+    entry->buffer = buffer_model;
+    entry->skip = TRUE;
+  } else if (!video_inference_prepare_entry (self, klass, buffer_model, pad,
+          entry)) {
+    gst_buffer_unref (buffer_model);
+    g_free (entry);
+    return GST_FLOW_ERROR;
+  }
+
+  g_mutex_lock (&priv->mtx_inflight);
+
+  /* Block the streaming thread while the worker is behind */
+  while (!skip && !priv->flushing && GST_FLOW_OK == priv->worker_ret
+      && priv->inflight_tensors >= priv->max_inflight) {
+    g_cond_wait (&priv->cond_inflight, &priv->mtx_inflight);
+  }
+
+  ret = priv->flushing ? GST_FLOW_FLUSHING : priv->worker_ret;
+  if (GST_FLOW_OK == ret) {
+    if (!skip) {
+      priv->inflight_tensors++;
+    }
+    g_queue_push_head (priv->inflight, entry);
+    g_cond_broadcast (&priv->cond_inflight);
+    entry = NULL;
+  }
+
+  g_mutex_unlock (&priv->mtx_inflight);
+
+  if (entry) {
+    video_inference_clear_entry (entry);
+    g_free (entry);
+  }
+
+  return ret;
+}
+
+static gpointer
+video_inference_async_worker (gpointer data)
+{
+  GstVideoInference *self = GST_VIDEO_INFERENCE (data);
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  VideoInferenceBatchEntry *entries;
+  VideoInferenceBatchEntry *entry;
+  GstInferenceTensorList **predictions;
+  GstFlowReturn ret;
+  gboolean predicted;
+  guint64 seq;
+  guint batch_size;
+  guint num_entries;
+  guint num_tensors;
+
+  GST_DEBUG_OBJECT (self, "Inference worker started");
+
+  entries = g_new (VideoInferenceBatchEntry, MAX_INFLIGHT_ENTRIES);
+  predictions = g_new0 (GstInferenceTensorList *, MAX_INFLIGHT_ENTRIES);
+
+  g_mutex_lock (&priv->mtx_inflight);
+  while (priv->worker_running) {
+    if (g_queue_is_empty (priv->inflight)) {
+      g_cond_wait (&priv->cond_inflight, &priv->mtx_inflight);
+      continue;
+    }
+
+    GST_OBJECT_LOCK (self);
+    batch_size = priv->batch_size;
+    GST_OBJECT_UNLOCK (self);
+
+    /* Take whatever is ready up to a full batch, waiting for more would
+     * only add latency */
+    num_entries = 0;
+    num_tensors = 0;
+    while (num_tensors < batch_size && num_entries < MAX_INFLIGHT_ENTRIES
+        && (entry = (VideoInferenceBatchEntry *)
+            g_queue_pop_tail (priv->inflight))) {
+      if (!entry->skip) {
+        num_tensors++;
+        priv->inflight_tensors--;
+      }
+      entries[num_entries++] = *entry;
+      g_free (entry);
+    }
+
+    seq = priv->dispatch_seq++;
+    priv->workers_busy++;
+    g_cond_broadcast (&priv->cond_inflight);
+    g_mutex_unlock (&priv->mtx_inflight);
+
+    predicted = video_inference_predict_batch (self, entries, num_entries,
+        predictions);
+
+    /* Other engines may be done with later frames already, wait for the
+     * turn of this batch before post-processing and forwarding it */
+    g_mutex_lock (&priv->mtx_inflight);
+    while (priv->finish_seq != seq) {
+      g_cond_wait (&priv->cond_inflight, &priv->mtx_inflight);
+    }
+    g_mutex_unlock (&priv->mtx_inflight);
+
+    ret = video_inference_finish_batch (self, entries, num_entries,
+        predictions, predicted);
+    if (GST_FLOW_OK == ret) {
+      ret = video_inference_match_pts (self, priv, FALSE);
+    }
+
+    g_mutex_lock (&priv->mtx_inflight);
+    priv->finish_seq++;
+    priv->workers_busy--;
+    if (GST_FLOW_OK == priv->worker_ret && GST_FLOW_OK != ret) {
+      GST_DEBUG_OBJECT (self, "Inference worker got %s",
+          gst_flow_get_name (ret));
+      priv->worker_ret = ret;
+    }
+    g_cond_broadcast (&priv->cond_inflight);
+  }
+  g_mutex_unlock (&priv->mtx_inflight);
+
+  g_free (predictions);
+  g_free (entries);
+
+  GST_DEBUG_OBJECT (self, "Inference worker stopped");
+
+  return NULL;
+}
+
+static void
+video_inference_async_start (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  gboolean async;
+  guint num_engines;
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  num_engines = priv->num_engines;
+  async = priv->async || num_engines > 1;
+  GST_OBJECT_UNLOCK (self);
+
+  g_mutex_lock (&priv->mtx_inflight);
+  priv->flushing = FALSE;
+  priv->worker_ret = GST_FLOW_OK;
+  priv->worker_running = async;
+  priv->dispatch_seq = 0;
+  priv->finish_seq = 0;
+  g_mutex_unlock (&priv->mtx_inflight);
+
+  /* One worker per engine keeps all of them busy */
+  for (i = 0; async && i < num_engines; i++) {
+    g_ptr_array_add (priv->workers, g_thread_new ("inference-worker",
+            video_inference_async_worker, self));
+  }
+}
+
+static void
+video_inference_async_stop (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  VideoInferenceBatchEntry *entry;
+  guint i;
+
+  g_mutex_lock (&priv->mtx_inflight);
+  priv->worker_running = FALSE;
+  priv->flushing = TRUE;
+  g_cond_broadcast (&priv->cond_inflight);
+  g_mutex_unlock (&priv->mtx_inflight);
+
+  for (i = 0; i < priv->workers->len; i++) {
+    g_thread_join ((GThread *) g_ptr_array_index (priv->workers, i));
+  }
+  g_ptr_array_set_size (priv->workers, 0);
+
+  while ((entry = (VideoInferenceBatchEntry *)
+          g_queue_pop_tail (priv->inflight))) {
+    video_inference_clear_entry (entry);
+    g_free (entry);
+  }
+  priv->inflight_tensors = 0;
+}
+
+static void
+video_inference_async_drain (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  g_mutex_lock (&priv->mtx_inflight);
+  while (priv->worker_running && !priv->flushing
+      && GST_FLOW_OK == priv->worker_ret
+      && (priv->workers_busy > 0 || !g_queue_is_empty (priv->inflight))) {
+    g_cond_wait (&priv->cond_inflight, &priv->mtx_inflight);
+  }
+  g_mutex_unlock (&priv->mtx_inflight);
+}
+
+static void
+video_inference_async_set_flushing (GstVideoInference * self,
+    gboolean flushing)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  VideoInferenceBatchEntry *entry;
+
+  g_mutex_lock (&priv->mtx_inflight);
+  priv->flushing = flushing;
+  g_cond_broadcast (&priv->cond_inflight);
+
+  if (!flushing) {
+    /* Wait for the batches being predicted and drop the rest */
+    while (priv->workers_busy > 0) {
+      g_cond_wait (&priv->cond_inflight, &priv->mtx_inflight);
+    }
+    while ((entry = (VideoInferenceBatchEntry *)
+            g_queue_pop_tail (priv->inflight))) {
+      video_inference_clear_entry (entry);
+      g_free (entry);
+    }
+    priv->inflight_tensors = 0;
+    priv->worker_ret = GST_FLOW_OK;
+  }
+  g_mutex_unlock (&priv->mtx_inflight);
+}
+
+static GstFlowReturn
+video_inference_match_pts (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gboolean drain)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn bypass_ret;
+  GstBuffer *model_buffer;
+  GstBuffer *bypass_buffer;
+  GstClockTime model_pts;
+  GstClockTime bypass_pts;
+  GstMeta *meta_model;
+  GstMeta *meta_bypass;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+
+  g_mutex_lock (&priv->mtx_output);
+
+  /* Both queues are ordered by PTS and predictions complete in order, so
+   * only the oldest buffers need comparing */
+  while (GST_FLOW_OK == ret) {
+    model_buffer =
+        GST_BUFFER_CAST (gst_inference_ring_peek (priv->model_queue));
+    bypass_buffer =
+        GST_BUFFER_CAST (gst_inference_ring_peek (priv->bypass_queue));
+
+    if (!drain && (NULL == model_buffer || NULL == bypass_buffer)) {
+      break;
+    }
+
+    if (NULL == model_buffer && NULL == bypass_buffer) {
+      break;
+    }
+
+    model_pts = model_buffer ? GST_BUFFER_PTS (model_buffer) :
+        GST_CLOCK_TIME_NONE;
+    bypass_pts = bypass_buffer ? GST_BUFFER_PTS (bypass_buffer) :
+        GST_CLOCK_TIME_NONE;
+
+    if (model_buffer && bypass_buffer && GST_CLOCK_TIME_IS_VALID (model_pts)
+        && GST_CLOCK_TIME_IS_VALID (bypass_pts) && model_pts != bypass_pts) {
+      /* The older one will never find a partner, let it go alone */
+      if (bypass_pts < model_pts) {
+        model_buffer = NULL;
+      } else {
+        bypass_buffer = NULL;
+      }
+    }
+
+    if (model_buffer) {
+      gst_inference_ring_pop (priv->model_queue);
+    }
+
+    if (bypass_buffer) {
+      gst_inference_ring_pop (priv->bypass_queue);
+    }
+
+    if (model_buffer && bypass_buffer) {
+      GST_LOG_OBJECT (self, "Matched model and bypass buffers at %"
+          GST_TIME_FORMAT, GST_TIME_ARGS (model_pts));
+
+      meta_model = gst_buffer_get_meta (model_buffer,
+          gst_inference_meta_api_get_type ());
+      meta_bypass =
+          video_inference_transform_meta (model_buffer,
+          &(priv->sink_model_data->info), meta_model, bypass_buffer,
+          &(priv->sink_bypass_data->info));
+
+      video_inference_notify (self, model_buffer, meta_model, bypass_buffer,
+          meta_bypass);
+    }
 
-  if (NULL == info_bypass || NULL == buffer_bypass) {
-    return meta_bypass;
+    ret = gst_video_inference_forward_buffer (self, model_buffer,
+        priv->src_model);
+    bypass_ret = gst_video_inference_forward_buffer (self, bypass_buffer,
+        priv->src_bypass);
+    if (GST_FLOW_OK == ret) {
+      ret = bypass_ret;
+    }
   }
 
-  info = meta_model->info;
-
-  /* TODO: elements such as videoscale will drop metas that have tags
-     such as video-size. Until this is fixed, tread all
-     transformations as scaling transformations
-   */
-  info->transform_func (buffer_bypass, meta_model, buffer_model,
-      _scale_quark, &trans);
-  meta_bypass = gst_buffer_get_meta (buffer_bypass, info->api);
+  g_mutex_unlock (&priv->mtx_output);
 
-  return meta_bypass;
+  return ret;
 }
 
 static GstFlowReturn
@@ -886,12 +3086,12 @@ gst_video_inference_process_model (GstVideoInference * self, GstBuffer * buffer,
   GstVideoInferenceClass *klass = GST_VIDEO_INFERENCE_GET_CLASS (self);
   GstFlowReturn ret = GST_FLOW_OK;
   GstMeta *current_meta = NULL;
-  GstMeta *meta_model = NULL;
-  GstVideoInfo *info_model = NULL;
   GstBuffer *buffer_model = NULL;
-  gpointer prediction_data = NULL;
-  gsize prediction_size;
-  gboolean pred_valid = FALSE;
+  GstInferenceTensorList *prediction = NULL;
+  guint batch_size;
+  gboolean async;
+  gboolean cascade;
+  gboolean skip;
 
   g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
@@ -899,7 +3099,7 @@ gst_video_inference_process_model (GstVideoInference * self, GstBuffer * buffer,
 
   GST_LOG_OBJECT (self, "Processing model buffer");
 
-  if (NULL == klass->postprocess) {
+  if (NULL == klass->postprocess && NULL == klass->postprocess_tensors) {
     GST_ELEMENT_ERROR (self, STREAM, FAILED,
         ("Subclass didn't implement post-process"), (NULL));
     ret = GST_FLOW_ERROR;
@@ -912,61 +3112,80 @@ gst_video_inference_process_model (GstVideoInference * self, GstBuffer * buffer,
   if (current_meta) {
     /* Check if root is enabled to be processed, if not, just forward buffer */
     GstInferenceMeta *inference_meta = (GstInferenceMeta *) current_meta;
-    GstInferencePrediction *root = inference_meta->prediction;
-    if (!root->enabled) {
+    GstInferencePrediction *root =
+        gst_inference_meta_ref_prediction (inference_meta);
+    gboolean enabled = root->enabled;
+
+    gst_inference_prediction_unref (root);
+    if (!enabled) {
       GST_INFO_OBJECT (self,
           "Current Prediction is not enabled, bypassing processing...");
+      /* Keep the buffer behind the ones still waiting for a prediction */
+      video_inference_async_drain (self);
+      ret = video_inference_batch_flush (self);
+      if (GST_FLOW_OK != ret) {
+        goto buffer_free;
+      }
       goto forward_buffer;
     }
   }
 
-  /* Run preprocess and inference on the model and generate prediction */
-  if (!gst_video_inference_model_run_prediction (self, klass, priv,
-          buffer_model, &prediction_data, &prediction_size)) {
-    ret = GST_FLOW_ERROR;
-    goto buffer_free;
+  GST_OBJECT_LOCK (self);
+  batch_size = priv->batch_size;
+  cascade = priv->cascade;
+  GST_OBJECT_UNLOCK (self);
+
+  g_mutex_lock (&priv->mtx_inflight);
+  async = priv->worker_running;
+  g_mutex_unlock (&priv->mtx_inflight);
+
+  skip = video_inference_should_skip (self, priv, buffer_model, pad);
+
+  /* The regions of a frame already make up the batch, so cascaded
+   * frames run right away once the buffers before them are out */
+  if (cascade && current_meta) {
+    video_inference_async_drain (self);
+    ret = video_inference_batch_flush (self);
+    if (GST_FLOW_OK != ret) {
+      goto buffer_free;
+    }
+
+    if (skip) {
+      ret = video_inference_skip_model (self, priv, buffer_model, pad);
+    } else {
+      ret = video_inference_cascade_model (self, klass, priv, buffer_model,
+          pad);
+    }
+    goto out;
   }
 
-  /* Assign already created inferencemeta, no need to create a new one */
-  meta_model = current_meta;
+  if (async) {
+    ret = video_inference_async_push (self, klass, priv, buffer_model, pad,
+        skip);
+    goto out;
+  }
 
-  /* Prepare postprocess */
-  info_model = &(pad->info);
-  if (!video_inference_prepare_postprocess (buffer_model, info_model,
-      &meta_model)) {
-    ret = GST_FLOW_ERROR;
-    goto buffer_free;
+  if (batch_size > 1 || priv->batch->len > 0) {
+    ret = video_inference_batch_push (self, klass, priv, buffer_model, pad,
+        skip);
+    goto out;
   }
 
-  /* Subclass Processing */
-  if (!klass->postprocess (self, prediction_data, prediction_size,
-          meta_model, info_model, &pred_valid, priv->labels_list,
-          priv->num_labels)) {
-    GST_ELEMENT_ERROR (self, STREAM, FAILED, ("Subclass failed at preprocess"),
-        (NULL));
+  if (skip) {
+    ret = video_inference_skip_model (self, priv, buffer_model, pad);
+    goto out;
+  }
+
+  /* Run preprocess and inference on the model and generate prediction */
+  if (!gst_video_inference_model_run_prediction (self, klass, priv,
+          buffer_model, &prediction)) {
     ret = GST_FLOW_ERROR;
     goto buffer_free;
   }
 
-  /* Check if bypass pad was requested, if not, forward buffer */
-  if (NULL == priv->sink_bypass) {
-    GST_LOG_OBJECT (self,
-        "There is no sinkpad for bypass, forwarding model buffer...");
-    goto forward_buffer;
-  } else {
-    GstInferenceMeta *imeta = (GstInferenceMeta *) meta_model;
-    /* Queue buffer */
-    GST_LOG_OBJECT (self, "Queue model buffer");
-    g_mutex_lock (&priv->mtx_model_queue);
-    g_queue_push_head (priv->model_queue, (gpointer) buffer_model);
-    g_mutex_unlock (&priv->mtx_model_queue);
-    /* Keep current Stream ID */
-    if (imeta) {
-      g_free (imeta->stream_id);
-      imeta->stream_id = gst_pad_get_stream_id (pad->data.pad);
-    }
-    goto out;
-  }
+  ret = video_inference_finish_model (self, klass, priv, buffer_model, pad,
+      prediction);
+  goto out;
 
 forward_buffer:
   ret = gst_video_inference_forward_buffer (self, gst_buffer_ref (buffer_model),
@@ -976,11 +3195,255 @@ buffer_free:
   gst_buffer_unref (buffer_model);
 
 out:
-  g_free (prediction_data);
+  if (prediction) {
+    gst_inference_tensor_list_free (prediction);
+  }
 
   return ret;
 }
 
+/* Makes roi a view of the bbox area of frame, without copying. The area
+ * is clamped to the frame and aligned to the chroma subsampling */
+static void
+video_inference_crop_frame (GstVideoFrame * frame, BoundingBox * bbox,
+    GstVideoFrame * roi)
+{
+  const GstVideoFormatInfo *finfo;
+  gint x, y, width, height, xalign, yalign, c;
+  guint p;
+
+  g_return_if_fail (frame);
+  g_return_if_fail (bbox);
+  g_return_if_fail (roi);
+
+  finfo = frame->info.finfo;
+
+  xalign = yalign = 1;
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    xalign = MAX (xalign, 1 << GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c));
+    yalign = MAX (yalign, 1 << GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c));
+  }
+
+  x = CLAMP (bbox->x, 0, GST_VIDEO_FRAME_WIDTH (frame) - 1);
+  y = CLAMP (bbox->y, 0, GST_VIDEO_FRAME_HEIGHT (frame) - 1);
+  width = MIN (bbox->x + (gint) bbox->width, GST_VIDEO_FRAME_WIDTH (frame));
+  height = MIN (bbox->y + (gint) bbox->height,
+      GST_VIDEO_FRAME_HEIGHT (frame));
+  x -= x % xalign;
+  y -= y % yalign;
+
+  *roi = *frame;
+  GST_VIDEO_INFO_WIDTH (&roi->info) = MAX (width - x, 1);
+  GST_VIDEO_INFO_HEIGHT (&roi->info) = MAX (height - y, 1);
+
+  /* Move every plane to the top left corner of the area, using the first
+   * component found in it */
+  for (p = 0; p < GST_VIDEO_FRAME_N_PLANES (frame); p++) {
+    for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+      if (GST_VIDEO_FORMAT_INFO_PLANE (finfo, c) == p) {
+        break;
+      }
+    }
+
+    roi->data[p] = (guint8 *) frame->data[p] +
+        GST_VIDEO_SUB_SCALE (GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c), y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, p) +
+        GST_VIDEO_SUB_SCALE (GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c), x) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
+  }
+}
+
+/* The tensor only lives for the prediction of a frame, so a single one
+ * is reused and only grows when a frame brings more regions. It stays
+ * owned by the element, which keeps it writable */
+static GstBuffer *
+video_inference_acquire_cascade_tensor (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, gsize size)
+{
+  if (priv->cascade_tensor
+      && gst_buffer_get_size (priv->cascade_tensor) < size) {
+    gst_buffer_unref (priv->cascade_tensor);
+    priv->cascade_tensor = NULL;
+  }
+
+  if (NULL == priv->cascade_tensor) {
+    GST_DEBUG_OBJECT (self, "Allocating a region tensor of %" G_GSIZE_FORMAT
+        " bytes", size);
+    priv->cascade_tensor = gst_buffer_new_allocate (NULL, size, NULL);
+  }
+
+  return priv->cascade_tensor;
+}
+
+static void
+video_inference_clear_cascade_tensor (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  if (priv->cascade_tensor) {
+    gst_buffer_unref (priv->cascade_tensor);
+    priv->cascade_tensor = NULL;
+  }
+}
+
+static GstFlowReturn
+video_inference_cascade_model (GstVideoInference * self,
+    GstVideoInferenceClass * klass, GstVideoInferencePrivate * priv,
+    GstBuffer * buffer_model, GstVideoInferencePad * pad)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstInferenceMeta *imeta;
+  GstInferencePrediction *root;
+  GstInferencePrediction *pred;
+  GstInferencePrediction *scratch;
+  GPtrArray *rois;
+  GList *enabled, *iter;
+  GstVideoFrame inframe;
+  GstVideoFrame roi;
+  GstVideoFrame *tensors = NULL;
+  GstVideoFrame **frames = NULL;
+  GstInferenceTensorList **predictions = NULL;
+  GstVideoInfo slice_info;
+  GstBuffer *outbuf = NULL;
+  GstMapFlags flags;
+  GError *error = NULL;
+  gsize slice_size;
+  gboolean pred_valid;
+  guint mapped = 0;
+  guint i;
+
+  g_return_val_if_fail (self, GST_FLOW_ERROR);
+  g_return_val_if_fail (klass, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer_model, GST_FLOW_ERROR);
+  g_return_val_if_fail (pad, GST_FLOW_ERROR);
+
+  imeta = (GstInferenceMeta *) gst_buffer_get_meta (buffer_model,
+      gst_inference_meta_api_get_type ());
+  root = gst_inference_meta_get_prediction (imeta);
+
+  /* The nodes stay owned by the tree, nothing is removed from it here */
+  rois = g_ptr_array_new ();
+  enabled = gst_inference_prediction_get_enabled (root);
+  for (iter = enabled; iter != NULL; iter = g_list_next (iter)) {
+    pred = (GstInferencePrediction *) iter->data;
+    if (pred != root && pred->bbox.width > 0 && pred->bbox.height > 0) {
+      g_ptr_array_add (rois, pred);
+    }
+  }
+  g_list_free (enabled);
+
+  if (0 == rois->len) {
+    GST_LOG_OBJECT (self, "No regions to process");
+    goto output;
+  }
+
+  GST_LOG_OBJECT (self, "Running prediction on %u regions", rois->len);
+
+  /* All the regions are laid out one after the other in a single
+   * tensor, each slice mapped as a frame of the model size */
+  slice_size = GST_VIDEO_INFO_SIZE (&priv->roi_info) * sizeof (float);
+  outbuf = video_inference_acquire_cascade_tensor (self, priv,
+      slice_size * rois->len);
+  tensors = g_new (GstVideoFrame, rois->len);
+  frames = g_new (GstVideoFrame *, rois->len);
+  predictions = g_new0 (GstInferenceTensorList *, rois->len);
+
+  flags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+  if (!gst_video_frame_map (&inframe, &pad->info, buffer_model, flags)) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        ("Unable to map the model buffer"), (NULL));
+    ret = GST_FLOW_ERROR;
+    goto free_tensors;
+  }
+
+  flags = (GstMapFlags) (GST_MAP_WRITE | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+  for (mapped = 0; mapped < rois->len; mapped++) {
+    pred = (GstInferencePrediction *) g_ptr_array_index (rois, mapped);
+
+    slice_info = priv->roi_info;
+    GST_VIDEO_INFO_PLANE_OFFSET (&slice_info, 0) = mapped * slice_size;
+    if (!gst_video_frame_map (&tensors[mapped], &slice_info, outbuf, flags)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          ("Unable to map the region tensor"), (NULL));
+      ret = GST_FLOW_ERROR;
+      break;
+    }
+    frames[mapped] = &tensors[mapped];
+
+    video_inference_crop_frame (&inframe, &pred->bbox, &roi);
+    if (!gst_video_inference_preprocess (self, klass, &roi,
+            &tensors[mapped])) {
+      ret = GST_FLOW_ERROR;
+      mapped++;
+      break;
+    }
+  }
+  gst_video_frame_unmap (&inframe);
+
+  if (GST_FLOW_OK != ret) {
+    goto free_tensors;
+  }
+
+  if (!gst_base_backend_process_batch (priv->backend, frames, rois->len,
+          predictions, &error)) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED,
+        ("Could not process using the selected backend: (%s)", error->message),
+        (NULL));
+    g_error_free (error);
+    ret = GST_FLOW_ERROR;
+    goto free_tensors;
+  }
+
+  /* Let the subclass fill a scratch root standing for each region, and
+   * merge its results into the right box */
+  for (i = 0; i < rois->len && GST_FLOW_OK == ret; i++) {
+    pred = (GstInferencePrediction *) g_ptr_array_index (rois, i);
+    scratch = gst_inference_prediction_new ();
+    scratch->prediction_id = pred->prediction_id;
+    scratch->bbox.width = GST_VIDEO_INFO_WIDTH (&priv->roi_info);
+    scratch->bbox.height = GST_VIDEO_INFO_HEIGHT (&priv->roi_info);
+
+    root = video_inference_swap_prediction (imeta, scratch);
+    if (video_inference_postprocess (self, klass, priv, predictions[i],
+            (GstMeta *) imeta, &priv->roi_info, &pred_valid)) {
+      gst_inference_prediction_merge (scratch, pred);
+    } else {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          ("Subclass failed at postprocess"), (NULL));
+      ret = GST_FLOW_ERROR;
+    }
+    scratch = video_inference_swap_prediction (imeta, root);
+
+    gst_inference_prediction_unref (scratch);
+  }
+
+free_tensors:
+  for (i = 0; i < mapped; i++) {
+    gst_video_frame_unmap (&tensors[i]);
+  }
+  for (i = 0; predictions && i < rois->len; i++) {
+    if (predictions[i]) {
+      gst_inference_tensor_list_free (predictions[i]);
+    }
+  }
+  g_free (predictions);
+  g_free (frames);
+  g_free (tensors);
+
+  if (GST_FLOW_OK != ret) {
+    g_ptr_array_free (rois, TRUE);
+    gst_buffer_unref (buffer_model);
+    return ret;
+  }
+
+output:
+  g_ptr_array_free (rois, TRUE);
+
+  return video_inference_output_model (self, priv, buffer_model,
+      (GstMeta *) imeta, pad);
+}
+
 static void
 video_inference_notify (GstVideoInference * self, GstBuffer * model_buffer,
     GstMeta * meta_model, GstBuffer * bypass_buffer,
@@ -994,34 +3457,45 @@ video_inference_notify (GstVideoInference * self, GstBuffer * model_buffer,
   GstMapFlags flags;
   GstInferenceMeta *imeta = NULL;
   GstInferencePrediction *pred = NULL;
-  gchar *prediction_string;
 
   g_return_if_fail (model_buffer);
   g_return_if_fail (meta_model);
 
-  info_model = &(priv->sink_model_data->info);
-  info_bypass = &(priv->sink_bypass_data->info);
-
-  flags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
-  gst_video_frame_map (&frame_model, info_model, model_buffer, flags);
-  gst_video_frame_map (&frame_bypass, info_bypass, bypass_buffer, flags);
+  /* Only map the frames for an application that listens */
+  if (g_signal_has_handler_pending (self,
+          gst_video_inference_signals[NEW_INFERENCE_SIGNAL], 0, FALSE)) {
+    info_model = &(priv->sink_model_data->info);
+    info_bypass = &(priv->sink_bypass_data->info);
 
-  /* Emit inference signal */
-  g_signal_emit (self, gst_video_inference_signals[NEW_INFERENCE_SIGNAL], 0,
-      meta_model, &frame_model, meta_bypass, &frame_bypass);
+    flags = (GstMapFlags) (GST_MAP_READ | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+    gst_video_frame_map (&frame_model, info_model, model_buffer, flags);
+    gst_video_frame_map (&frame_bypass, info_bypass, bypass_buffer, flags);
 
-  /* Parse InferenceMeta from new Inference Model */
-  imeta = (GstInferenceMeta *) meta_model;
-  pred = imeta->prediction;
-  prediction_string = gst_inference_prediction_to_string (pred);
+    /* Emit inference signal */
+    g_signal_emit (self, gst_video_inference_signals[NEW_INFERENCE_SIGNAL], 0,
+        meta_model, &frame_model, meta_bypass, &frame_bypass);
 
-  /* Emit JSON string inference signal */
-  g_signal_emit (self, gst_video_inference_signals[NEW_INFERENCE_STRING_SIGNAL],
-      0, prediction_string);
+    gst_video_frame_unmap (&frame_model);
+    gst_video_frame_unmap (&frame_bypass);
+  }
 
-  gst_video_frame_unmap (&frame_model);
-  gst_video_frame_unmap (&frame_bypass);
-  g_free (prediction_string);
+  /* The JSON is only built for an application that listens */
+  if (g_signal_has_handler_pending (self,
+          gst_video_inference_signals[NEW_INFERENCE_STRING_SIGNAL], 0,
+          FALSE)) {
+    /* Parse InferenceMeta from new Inference Model */
+    imeta = (GstInferenceMeta *) meta_model;
+    pred = gst_inference_meta_ref_prediction (imeta);
+
+    g_string_truncate (priv->serial, 0);
+    gst_inference_prediction_serialize (pred, priv->serial);
+    gst_inference_prediction_unref (pred);
+
+    /* Emit JSON string inference signal */
+    g_signal_emit (self,
+        gst_video_inference_signals[NEW_INFERENCE_STRING_SIGNAL], 0,
+        priv->serial->str);
+  }
 }
 
 static GstFlowReturn
@@ -1050,11 +3524,27 @@ gst_video_inference_process_bypass (GstVideoInference * self,
   }
 
   bypass_buffer = gst_buffer_make_writable (buffer);
+
+  /* Asynchronous predictions complete later, match them by PTS */
+  if (priv->workers->len > 0) {
+    GST_LOG_OBJECT (self, "Queue bypass buffer until its prediction is done");
+    ret = video_inference_queue_push (self, priv, priv->bypass_queue,
+        bypass_buffer, priv->src_bypass);
+    if (GST_FLOW_OK != ret) {
+      return ret;
+    }
+
+    return video_inference_match_pts (self, priv, FALSE);
+  }
+
   current_meta = gst_buffer_get_meta (bypass_buffer,
       gst_inference_meta_api_get_type ());
   if (current_meta) {
     GstInferenceMeta *imeta = (GstInferenceMeta *) current_meta;
-    GList *found = gst_inference_prediction_get_enabled (imeta->prediction);
+    GstInferencePrediction *root = gst_inference_meta_ref_prediction (imeta);
+    GList *found = gst_inference_prediction_get_enabled (root);
+
+    gst_inference_prediction_unref (root);
 
     if (!found) {
       GST_INFO_OBJECT (self,
@@ -1065,19 +3555,26 @@ gst_video_inference_process_bypass (GstVideoInference * self,
     g_list_free (found);
   }
 
-  /* Queue this new buffer at the head and dequeue the older one */
+  /* Queue this new buffer and look at the oldest one, it stays queued
+   * until a model buffer that doesn't belong to it shows up */
   GST_LOG_OBJECT (self, "Queue bypass buffer and get older one");
-  g_mutex_lock (&priv->mtx_bypass_queue);
-  g_queue_push_head (priv->bypass_queue, (gpointer) bypass_buffer);
-  bypass_buffer = GST_BUFFER_CAST (g_queue_pop_tail (priv->bypass_queue));
-  g_mutex_unlock (&priv->mtx_bypass_queue);
+  ret = video_inference_queue_push (self, priv, priv->bypass_queue,
+      bypass_buffer, priv->src_bypass);
+  if (GST_FLOW_OK != ret) {
+    return ret;
+  }
+  bypass_buffer =
+      GST_BUFFER_CAST (gst_inference_ring_peek (priv->bypass_queue));
+  if (NULL == bypass_buffer) {
+    /* Dropped by the overflow policy */
+    return ret;
+  }
 
   while (!model_empty) {
-    /* Dequeue oldest model buffer from tail */
-    g_mutex_lock (&priv->mtx_model_queue);
+    /* Look at the oldest model buffer */
     GST_LOG_OBJECT (self, "Dequeue model buffer");
-    model_buffer = GST_BUFFER_CAST (g_queue_pop_tail (priv->model_queue));
-    g_mutex_unlock (&priv->mtx_model_queue);
+    model_buffer =
+        GST_BUFFER_CAST (gst_inference_ring_peek (priv->model_queue));
 
     if (NULL == model_buffer) {
       /* Model queue is empty */
@@ -1085,6 +3582,7 @@ gst_video_inference_process_bypass (GstVideoInference * self,
     } else {
       GstInferencePrediction *root_model = NULL;
       GstInferencePrediction *root_bypass = NULL;
+      guint64 model_id = 0;
       GstMeta *meta_model = NULL;
       GstMeta *meta_bypass = NULL;
       GstVideoInfo *info_model = &(priv->sink_model_data->info);
@@ -1094,29 +3592,37 @@ gst_video_inference_process_bypass (GstVideoInference * self,
       meta_model = gst_buffer_get_meta (model_buffer,
           gst_inference_meta_api_get_type ());
 
-      root_model = ((GstInferenceMeta *) meta_model)->prediction;
+      root_model =
+          gst_inference_meta_ref_prediction ((GstInferenceMeta *) meta_model);
+      model_id = root_model->prediction_id;
+      gst_inference_prediction_unref (root_model);
 
       /* If bypass doesn't have meta, just transfer the model meta */
       current_meta = gst_buffer_get_meta (bypass_buffer,
           gst_inference_meta_api_get_type ());
 
       if (current_meta) {
+        GstInferencePrediction *root_current =
+            gst_inference_meta_ref_prediction ((GstInferenceMeta *)
+            current_meta);
+
         /* Check if model and bypass IDs match */
         GST_LOG_OBJECT (self, "Checking if model and bypass IDs match");
-        root_bypass = gst_inference_prediction_find (((GstInferenceMeta *)
-                current_meta)->prediction, root_model->prediction_id);
+        root_bypass =
+            gst_inference_prediction_find (root_current, model_id);
+        gst_inference_prediction_unref (root_current);
         if (NULL == root_bypass) {
-          /* Queue model buffer to tail again */
-          g_mutex_lock (&priv->mtx_model_queue);
-          GST_LOG_OBJECT (self, "Queue model buffer");
-          g_queue_push_tail (priv->model_queue, (gpointer) model_buffer);
-          g_mutex_unlock (&priv->mtx_model_queue);
+          /* Leave the model buffer queued for the next bypass buffer */
+          GST_LOG_OBJECT (self, "Bypass buffer is done, dequeue it");
+          gst_inference_ring_pop (priv->bypass_queue);
           goto forward_buffer;
         } else {
           gst_inference_prediction_unref (root_bypass);
         }
       }
 
+      gst_inference_ring_pop (priv->model_queue);
+
       /* Transfer meta from model to bypass */
       GST_LOG_OBJECT (self, "Transfering meta from model to bypass");
 
@@ -1136,12 +3642,7 @@ gst_video_inference_process_bypass (GstVideoInference * self,
     }
   }
 
-  /* Queue old bypass buffer at the tail */
-  GST_LOG_OBJECT (self, "Queue bypass buffer");
-  g_mutex_lock (&priv->mtx_bypass_queue);
-  g_queue_push_tail (priv->bypass_queue, (gpointer) bypass_buffer);
-  g_mutex_unlock (&priv->mtx_bypass_queue);
-
+  /* The old bypass buffer stays queued */
   return ret;
 
 forward_buffer:
@@ -1163,17 +3664,33 @@ gst_video_inference_buffer_function (GstCollectPads * pads,
   GstVideoInferencePad *pad = (GstVideoInferencePad *) data;
   GstFlowReturn ret = GST_FLOW_OK;
 
-  if (!buffer) {
-    /* EOS reached the pad */
-    ret = GST_FLOW_EOS;
-    goto out;
-  }
-
   g_return_val_if_fail (pads != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
 
   priv = GST_VIDEO_INFERENCE_PRIVATE (self);
 
+  /* Nothing can run before the model is there */
+  ret = video_inference_wait_loaded (self);
+  if (GST_FLOW_OK != ret) {
+    if (buffer) {
+      gst_buffer_unref (buffer);
+    }
+    return ret;
+  }
+
+  /* Collect pads hands no data at all once every pad is EOS */
+  if (!buffer) {
+    /* Run whatever is left in the batch and release the buffers
+     * waiting for a partner */
+    video_inference_batch_flush (self);
+    video_inference_async_drain (self);
+    if (priv->workers->len > 0) {
+      video_inference_match_pts (self, priv, TRUE);
+    }
+    ret = GST_FLOW_EOS;
+    goto out;
+  }
+
   if (data->pad == priv->sink_model) {
     GST_LOG_OBJECT (self, "Model buffer arrived, processing it...");
     ret = gst_video_inference_process_model (self, buffer, pad);
@@ -1246,6 +3763,12 @@ gst_video_inference_set_caps (GstVideoInference * self,
         caps);
     gst_video_info_init (info);
     gst_video_info_from_caps (info, caps);
+
+    /* Tensor size depends on the model caps, resize the pool */
+    if (data->pad == priv->sink_model) {
+      video_inference_configure_tensor (self, priv, info);
+      video_inference_clear_pool (self);
+    }
   }
 }
 
@@ -1301,8 +3824,39 @@ gst_video_inference_sink_event (GstCollectPads * pads, GstCollectData * pad,
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_CAPS:
+      /* Pending tensors were computed with the previous caps */
+      if (pad->pad == priv->sink_model) {
+        GST_COLLECT_PADS_STREAM_LOCK (priv->cpads);
+        video_inference_batch_flush (self);
+        video_inference_async_drain (self);
+        video_inference_reset_qos (self);
+        GST_COLLECT_PADS_STREAM_UNLOCK (priv->cpads);
+      }
       gst_video_inference_set_caps (self, priv, pad, event);
       break;
+    case GST_EVENT_EOS:
+      /* Pending and in-flight frames have to go out before the EOS */
+      if (pad->pad == priv->sink_model) {
+        GST_COLLECT_PADS_STREAM_LOCK (priv->cpads);
+        video_inference_batch_flush (self);
+        video_inference_async_drain (self);
+        GST_COLLECT_PADS_STREAM_UNLOCK (priv->cpads);
+      }
+      break;
+    case GST_EVENT_FLUSH_START:
+      if (pad->pad == priv->sink_model) {
+        video_inference_async_set_flushing (self, TRUE);
+      }
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      if (pad->pad == priv->sink_model) {
+        GST_COLLECT_PADS_STREAM_LOCK (priv->cpads);
+        video_inference_batch_clear (self);
+        video_inference_async_set_flushing (self, FALSE);
+        video_inference_reset_qos (self);
+        GST_COLLECT_PADS_STREAM_UNLOCK (priv->cpads);
+      }
+      break;
     default:
       break;
   }
@@ -1334,23 +3888,106 @@ gst_video_inference_src_event (GstPad * pad, GstObject * parent,
 {
   GstVideoInference *self = GST_VIDEO_INFERENCE (parent);
   GstVideoInferencePrivate *priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+  GstQOSType type;
+  gdouble proportion;
+  GstClockTimeDiff diff;
+  GstClockTime timestamp;
+
+  if (GST_EVENT_QOS == GST_EVENT_TYPE (event)) {
+    gst_event_parse_qos (event, &type, &proportion, &diff, &timestamp);
+
+    /* Frames before this running time would reach the sink late */
+    GST_OBJECT_LOCK (self);
+    if (diff >= 0 || timestamp > (GstClockTime) (-diff)) {
+      priv->earliest_time = timestamp + diff;
+    } else {
+      priv->earliest_time = 0;
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    GST_LOG_OBJECT (self, "QoS from %" GST_PTR_FORMAT ": proportion %f, "
+        "diff %" G_GINT64_FORMAT, pad, proportion, diff);
+  }
 
   return gst_collect_pads_src_event_default (priv->cpads, pad, event);
 }
 
 static void
-video_inference_flush_queue (GQueue * queue, GMutex * mutex)
+video_inference_flush_queue (GstInferenceRing * queue)
 {
   GstBuffer *buf = NULL;
 
   g_return_if_fail (queue);
-  g_return_if_fail (mutex);
 
-  g_mutex_lock (mutex);
-  while ((buf = GST_BUFFER_CAST (g_queue_pop_tail (queue)))) {
+  while ((buf = GST_BUFFER_CAST (gst_inference_ring_pop (queue)))) {
     gst_buffer_unref (buf);
   }
-  g_mutex_unlock (mutex);
+}
+
+static GstFlowReturn
+video_inference_queue_push (GstVideoInference * self,
+    GstVideoInferencePrivate * priv, GstInferenceRing * queue,
+    GstBuffer * buffer, GstPad * pad)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstVideoInferenceOverflow overflow;
+  GstBuffer *oldest = NULL;
+
+  g_return_val_if_fail (self != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (priv != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (queue != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
+
+  if (gst_inference_ring_push (queue, (gpointer) buffer)) {
+    return GST_FLOW_OK;
+  }
+
+  GST_OBJECT_LOCK (self);
+  overflow = priv->queue_overflow;
+  priv->queue_overflows++;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Evicting makes the producer act as a consumer, keep the real
+   * consumer out meanwhile */
+  g_mutex_lock (&priv->mtx_output);
+
+  if (GST_VIDEO_INFERENCE_OVERFLOW_DROP_NEWEST == overflow) {
+    GST_DEBUG_OBJECT (self, "Queue full, dropping newest buffer");
+    gst_buffer_unref (buffer);
+    goto out;
+  }
+
+  oldest = GST_BUFFER_CAST (gst_inference_ring_pop (queue));
+  gst_inference_ring_push (queue, (gpointer) buffer);
+
+  if (GST_VIDEO_INFERENCE_OVERFLOW_DROP_OLDEST == overflow) {
+    GST_DEBUG_OBJECT (self, "Queue full, dropping oldest buffer");
+    gst_buffer_unref (oldest);
+  } else {
+    GST_DEBUG_OBJECT (self, "Queue full, forwarding oldest buffer unpaired");
+    ret = gst_video_inference_forward_buffer (self, oldest, pad);
+  }
+
+out:
+  g_mutex_unlock (&priv->mtx_output);
+
+  return ret;
+}
+
+static guint
+video_inference_get_queue_level (GstVideoInference * self,
+    GstInferenceRing ** queue)
+{
+  guint level = 0;
+
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (queue != NULL, 0);
+
+  GST_OBJECT_LOCK (self);
+  level = gst_inference_ring_get_occupancy (*queue);
+  GST_OBJECT_UNLOCK (self);
+
+  return level;
 }
 
 static void
@@ -1371,17 +4008,42 @@ gst_video_inference_finalize (GObject * object)
   priv->model_location = NULL;
   g_free (priv->labels);
   priv->labels = NULL;
-  g_free (priv->labels_list);
-  priv->labels_list = NULL;
-
-  g_mutex_clear (&priv->mtx_model_queue);
-  g_mutex_clear (&priv->mtx_bypass_queue);
+  if (priv->label_table) {
+    gst_inference_labels_unref (priv->label_table);
+    priv->label_table = NULL;
+  }
 
-  g_queue_free (priv->model_queue);
-  g_queue_free (priv->bypass_queue);
+  gst_inference_ring_free (priv->model_queue,
+      (GDestroyNotify) gst_buffer_unref);
+  gst_inference_ring_free (priv->bypass_queue,
+      (GDestroyNotify) gst_buffer_unref);
+
+  video_inference_batch_clear (self);
+  g_array_unref (priv->batch);
+  video_inference_clear_cascade_tensor (self);
+
+  g_queue_free (priv->inflight);
+  g_ptr_array_unref (priv->workers);
+  g_mutex_clear (&priv->mtx_batch);
+  g_cond_clear (&priv->cond_batch);
+  g_mutex_clear (&priv->mtx_inflight);
+  g_cond_clear (&priv->cond_inflight);
+  g_mutex_clear (&priv->mtx_output);
+  g_mutex_clear (&priv->mtx_load);
+  g_cond_clear (&priv->cond_load);
+
+  if (priv->last_prediction) {
+    gst_inference_prediction_unref (priv->last_prediction);
+    priv->last_prediction = NULL;
+  }
 
   g_clear_object (&priv->backend);
 
+  video_inference_clear_pool (self);
+
+  g_string_free (priv->serial, TRUE);
+  priv->serial = NULL;
+
   G_OBJECT_CLASS (gst_video_inference_parent_class)->finalize (object);
 }
 
@@ -1418,3 +4080,62 @@ gst_video_inference_get_backend_type (GstVideoInference * self)
 
   return gst_base_backend_get_framework_code (priv->backend);
 }
+
+GstInferenceLabels *
+gst_video_inference_get_labels (GstVideoInference * self)
+{
+  GstVideoInferencePrivate *priv = NULL;
+  GstInferenceLabels *labels = NULL;
+
+  g_return_val_if_fail (GST_IS_VIDEO_INFERENCE (self), NULL);
+
+  priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  GST_OBJECT_LOCK (self);
+  if (priv->label_table) {
+    labels = gst_inference_labels_ref (priv->label_table);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return labels;
+}
+
+void
+gst_video_inference_install_top_k_properties (GstVideoInferenceClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+
+  g_return_if_fail (klass != NULL);
+
+  /* The ids are the ones set_property and get_property handle here */
+  g_object_class_install_property (oclass, PROP_TOP_K,
+      g_param_spec_uint ("top-k", "Top K",
+          "Number of most probable classes kept in every classification",
+          MIN_TOP_K, G_MAXINT, DEFAULT_TOP_K, G_PARAM_READWRITE));
+  g_object_class_install_property (oclass, PROP_FULL_PROBABILITIES,
+      g_param_spec_boolean ("full-probabilities", "Full Probabilities",
+          "Keep the probabilities of every class in classifications, "
+          "besides the top-k classes",
+          DEFAULT_FULL_PROBABILITIES, G_PARAM_READWRITE));
+}
+
+guint
+gst_video_inference_get_top_k (GstVideoInference * self,
+    gboolean * full_probabilities)
+{
+  GstVideoInferencePrivate *priv = NULL;
+  guint top_k = 0;
+
+  g_return_val_if_fail (GST_IS_VIDEO_INFERENCE (self), 0);
+
+  priv = GST_VIDEO_INFERENCE_PRIVATE (self);
+
+  GST_OBJECT_LOCK (self);
+  top_k = priv->top_k;
+  if (full_probabilities) {
+    *full_probabilities = priv->full_probabilities;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return top_k;
+}
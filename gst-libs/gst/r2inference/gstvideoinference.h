@@ -24,8 +24,45 @@
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <gst/r2inference/gstinferencelabels.h>
+#include <gst/r2inference/gstinferencetensor.h>
 
 G_BEGIN_DECLS
+
+/**
+ * GST_VIDEO_INFERENCE_FUSED_CAPS:
+ *
+ * Caps a subclass can append to its model pad templates to accept YUV
+ * frames of any size. Those frames are converted and scaled to the
+ * first fixed size in the template by the fused preprocess, and the
+ * predictions are scaled back to the input frame. RGB frames are never
+ * scaled, they reach the model at their negotiated size.
+ */
+#define GST_VIDEO_INFERENCE_FUSED_CAPS					\
+  "video/x-raw, "							\
+  "width=" GST_VIDEO_SIZE_RANGE ", "					\
+  "height=" GST_VIDEO_SIZE_RANGE ", "					\
+  "format={NV12, I420, YUY2}"
+
+#define GST_TYPE_VIDEO_INFERENCE_OVERFLOW (gst_video_inference_overflow_get_type ())
+/**
+ * GstVideoInferenceOverflow:
+ * @GST_VIDEO_INFERENCE_OVERFLOW_FORWARD_OLDEST : Push the oldest queued
+ *   buffer downstream without its pair to make room
+ * @GST_VIDEO_INFERENCE_OVERFLOW_DROP_OLDEST : Drop the oldest queued buffer
+ * @GST_VIDEO_INFERENCE_OVERFLOW_DROP_NEWEST : Drop the incoming buffer
+ *
+ * What to do with a buffer that finds its model or bypass queue full.
+ **/
+typedef enum
+{
+  GST_VIDEO_INFERENCE_OVERFLOW_FORWARD_OLDEST,
+  GST_VIDEO_INFERENCE_OVERFLOW_DROP_OLDEST,
+  GST_VIDEO_INFERENCE_OVERFLOW_DROP_NEWEST,
+} GstVideoInferenceOverflow;
+
+GType gst_video_inference_overflow_get_type (void) G_GNUC_CONST;
+
 #define GST_TYPE_VIDEO_INFERENCE gst_video_inference_get_type ()
 G_DECLARE_DERIVABLE_TYPE (GstVideoInference, gst_video_inference, GST,
     VIDEO_INFERENCE, GstElement);
@@ -41,7 +78,53 @@ struct _GstVideoInferenceClass
     gboolean (*postprocess) (GstVideoInference * self,
       const gpointer prediction, gsize size, GstMeta * meta_model,
       GstVideoInfo * info_model, gboolean * valid_prediction, gchar **labels_list, gint num_labels);
+  /* Same as postprocess, but gets every output tensor separately and
+   * without copies. Used instead of postprocess when set. */
+    gboolean (*postprocess_tensors) (GstVideoInference * self,
+      const GstInferenceTensor * tensors, guint num_tensors,
+      GstMeta * meta_model, GstVideoInfo * info_model,
+      gboolean * valid_prediction, gchar **labels_list, gint num_labels);
 };
 
+/**
+ * gst_video_inference_get_labels:
+ * @self: the video inference element
+ *
+ * Gets the label table built from the labels property. Classifications
+ * can share it instead of copying every label.
+ *
+ * Returns: a new reference to the label table, or NULL if no labels were
+ * set. Release it with gst_inference_labels_unref().
+ */
+GstInferenceLabels *gst_video_inference_get_labels (GstVideoInference * self);
+
+/**
+ * gst_video_inference_get_top_k:
+ * @self: the video inference element
+ * @full_probabilities: (out) (optional): whether classifications keep
+ * the probabilities of every class as well
+ *
+ * Gets how much of the model output the classifications keep, from the
+ * top-k and full-probabilities properties.
+ *
+ * Returns: the number of most probable classes to keep.
+ */
+guint gst_video_inference_get_top_k (GstVideoInference * self,
+    gboolean * full_probabilities);
+
+/**
+ * gst_video_inference_install_top_k_properties:
+ * @klass: the class of a classification element
+ *
+ * Installs the top-k and full-probabilities properties on a
+ * classification element, call it from class_init. They are installed
+ * on @klass with the property ids of the video inference class, which
+ * handles them. So an element that overrides set_property or
+ * get_property must chain up to the parent class in its default case,
+ * and the ids of its own properties must not collide with these two.
+ */
+void gst_video_inference_install_top_k_properties (GstVideoInferenceClass *
+    klass);
+
 G_END_DECLS
 #endif //__GST_VIDEO_INFERENCE_H__
@@ -416,6 +416,7 @@ gst_inference_crop_new_buffer (GstPad *pad, GstPadProbeInfo *info,
   GstPadProbeReturn ret = GST_PAD_PROBE_DROP;
   GList *list = NULL;
   GList *iter = NULL;
+  GstInferencePrediction *root = NULL;
   gboolean gap = TRUE;
   gboolean enable = FALSE;
 
@@ -443,9 +444,11 @@ gst_inference_crop_new_buffer (GstPad *pad, GstPadProbeInfo *info,
     goto out;
   }
 
+  /* The listed predictions belong to this reference */
+  root = gst_inference_meta_ref_prediction (inference_meta);
   num_inferences = 0;
   gst_inference_crop_find_predictions (self, &num_inferences,
-                                       inference_meta, &list, inference_meta->prediction);
+                                       inference_meta, &list, root);
 
   for (iter = list; iter != NULL; iter = g_list_next (iter)) {
     GstInferencePrediction *pred = (GstInferencePrediction *) iter->data;
@@ -467,9 +470,8 @@ gst_inference_crop_new_buffer (GstPad *pad, GstPadProbeInfo *info,
     dmeta = (GstInferenceMeta *) gst_buffer_get_meta (croped_buffer,
         GST_INFERENCE_META_API_TYPE);
 
-    gst_inference_prediction_unref (dmeta->prediction);
-
-    dmeta->prediction = gst_inference_prediction_copy (pred);
+    gst_inference_meta_set_prediction (dmeta,
+        gst_inference_prediction_copy (pred));
 
     dmeta->prediction->bbox.x = 0;
     dmeta->prediction->bbox.y = 0;
@@ -492,5 +494,9 @@ out:
             GST_BUFFER_DURATION (buffer)));
   }
 
+  if (root) {
+    gst_inference_prediction_unref (root);
+  }
+
   return ret;
 }
@@ -127,6 +127,7 @@ gst_inference_debug_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
   GstInferenceDebug *inferencedebug = GST_INFERENCE_DEBUG (trans);
   GstInferenceMeta *meta;
+  GstInferencePrediction *root;
 
   GST_DEBUG_OBJECT (inferencedebug, "transform_ip");
 
@@ -141,7 +142,9 @@ gst_inference_debug_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 
   g_return_val_if_fail (meta->prediction, GST_FLOW_ERROR);
 
-  gst_inference_debug_print_predictions (inferencedebug, meta->prediction);
+  root = gst_inference_meta_ref_prediction (meta);
+  gst_inference_debug_print_predictions (inferencedebug, root);
+  gst_inference_prediction_unref (root);
 
   return GST_FLOW_OK;
 }
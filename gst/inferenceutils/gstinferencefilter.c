@@ -268,7 +268,7 @@ gst_inference_filter_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
     return GST_FLOW_OK;
   }
 
-  gst_inference_filter_filter_enable (inferencefilter, meta->prediction,
-      filter, reset);
+  gst_inference_filter_filter_enable (inferencefilter,
+      gst_inference_meta_get_prediction (meta), filter, reset);
   return GST_FLOW_OK;
 }
@@ -0,0 +1,310 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/**
+ * SECTION:element-gstinferenceserializer
+ *
+ * The inferenceserializer element passes video through and pushes the
+ * inferencemeta of every buffer, in the compact binary encoding of
+ * gst_inference_meta_serialize, on its meta_src pad. Each meta buffer
+ * carries the timestamps of its video buffer.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 v4l2src device=$CAMERA ! "video/x-raw, width=1280, height=720" ! videoconvert ! tee name=t \
+   t. ! videoscale ! queue ! net.sink_model t. ! queue ! net.sink_bypass \
+   tinyyolov2 name=net model-location=$MODEL_LOCATION backend=tensorflow backend::input-layer=$INPUT_LAYER \
+   backend::output-layer=$OUTPUT_LAYER  net.src_model ! inferenceserializer name=ser ! fakesink \
+   ser.meta_src ! queue ! filesink location=predictions.bin
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstinferenceserializer.h"
+
+#include <gst/base/gstflowcombiner.h>
+#include <gst/r2inference/gstinferencemeta.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_inference_serializer_debug_category);
+#define GST_CAT_DEFAULT gst_inference_serializer_debug_category
+
+/* Room for a few hundred predictions until the first buffer tells */
+#define DEFAULT_SERIAL_SIZE 4096
+
+/* prototypes */
+
+static void gst_inference_serializer_finalize (GObject * object);
+static GstStateChangeReturn
+gst_inference_serializer_change_state (GstElement * element,
+    GstStateChange transition);
+static GstFlowReturn gst_inference_serializer_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
+static gboolean gst_inference_serializer_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
+static gboolean gst_inference_serializer_sink_query (GstPad * pad,
+    GstObject * parent, GstQuery * query);
+static GstBuffer *gst_inference_serializer_serialize (GstInferenceSerializer *
+    self, GstBuffer * buffer);
+
+struct _GstInferenceSerializer
+{
+  GstElement parent;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+  GstPad *metapad;
+  GstFlowCombiner *combiner;
+
+  /* Sizes the next meta buffer */
+  gsize last_size;
+};
+
+/* pad templates */
+
+static GstStaticPadTemplate gst_inference_serializer_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate gst_inference_serializer_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate gst_inference_serializer_meta_template =
+GST_STATIC_PAD_TEMPLATE ("meta_src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_INFERENCE_META_SERIAL_CAPS ", version = (int) "
+        G_STRINGIFY (GST_INFERENCE_META_SERIAL_VERSION)));
+
+/* class initialization */
+
+G_DEFINE_TYPE_WITH_CODE (GstInferenceSerializer, gst_inference_serializer,
+    GST_TYPE_ELEMENT,
+    GST_DEBUG_CATEGORY_INIT (gst_inference_serializer_debug_category,
+        "inferenceserializer", 0,
+        "debug category for inferenceserializer element"));
+
+static void
+gst_inference_serializer_class_init (GstInferenceSerializerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class,
+      &gst_inference_serializer_sink_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &gst_inference_serializer_src_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &gst_inference_serializer_meta_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "Inference Serializer", "Generic",
+      "Pushes the InferenceMeta of every buffer in a compact binary form",
+      "<support@ridgerun.com>");
+
+  gobject_class->finalize = gst_inference_serializer_finalize;
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_inference_serializer_change_state);
+}
+
+static void
+gst_inference_serializer_init (GstInferenceSerializer * self)
+{
+  self->sinkpad =
+      gst_pad_new_from_static_template (&gst_inference_serializer_sink_template,
+      "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_inference_serializer_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_inference_serializer_sink_event));
+  gst_pad_set_query_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_inference_serializer_sink_query));
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad =
+      gst_pad_new_from_static_template (&gst_inference_serializer_src_template,
+      "src");
+  gst_pad_use_fixed_caps (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->metapad =
+      gst_pad_new_from_static_template (&gst_inference_serializer_meta_template,
+      "meta_src");
+  gst_pad_use_fixed_caps (self->metapad);
+  gst_element_add_pad (GST_ELEMENT (self), self->metapad);
+
+  self->combiner = gst_flow_combiner_new ();
+  gst_flow_combiner_add_pad (self->combiner, self->srcpad);
+  gst_flow_combiner_add_pad (self->combiner, self->metapad);
+
+  self->last_size = DEFAULT_SERIAL_SIZE;
+}
+
+static void
+gst_inference_serializer_finalize (GObject * object)
+{
+  GstInferenceSerializer *self = GST_INFERENCE_SERIALIZER (object);
+
+  gst_flow_combiner_free (self->combiner);
+
+  G_OBJECT_CLASS (gst_inference_serializer_parent_class)->finalize (object);
+}
+
+static GstStateChangeReturn
+gst_inference_serializer_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstInferenceSerializer *self = GST_INFERENCE_SERIALIZER (element);
+
+  if (GST_STATE_CHANGE_READY_TO_PAUSED == transition) {
+    gst_flow_combiner_reset (self->combiner);
+    self->last_size = DEFAULT_SERIAL_SIZE;
+  }
+
+  return
+      GST_ELEMENT_CLASS (gst_inference_serializer_parent_class)->change_state
+      (element, transition);
+}
+
+static gboolean
+gst_inference_serializer_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstInferenceSerializer *self = GST_INFERENCE_SERIALIZER (parent);
+  GstCaps *caps = NULL;
+  gchar *stream_id = NULL;
+  gboolean ret = FALSE;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+      /* Each source pad is a stream of its own */
+      stream_id = gst_pad_create_stream_id (self->metapad,
+          GST_ELEMENT (self), "meta");
+      gst_pad_push_event (self->metapad,
+          gst_event_new_stream_start (stream_id));
+      g_free (stream_id);
+
+      ret = gst_pad_push_event (self->srcpad, event);
+      break;
+    case GST_EVENT_CAPS:
+      caps = gst_pad_get_pad_template_caps (self->metapad);
+      gst_pad_push_event (self->metapad, gst_event_new_caps (caps));
+      gst_caps_unref (caps);
+
+      ret = gst_pad_push_event (self->srcpad, event);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_flow_combiner_reset (self->combiner);
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
+
+  return ret;
+}
+
+static gboolean
+gst_inference_serializer_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstInferenceSerializer *self = GST_INFERENCE_SERIALIZER (parent);
+  gboolean ret = FALSE;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    case GST_QUERY_ACCEPT_CAPS:
+      /* The video caps only concern the video branch */
+      ret = gst_pad_peer_query (self->srcpad, query);
+      break;
+    default:
+      ret = gst_pad_query_default (pad, parent, query);
+      break;
+  }
+
+  return ret;
+}
+
+static GstBuffer *
+gst_inference_serializer_serialize (GstInferenceSerializer * self,
+    GstBuffer * buffer)
+{
+  GstInferenceMeta *meta = NULL;
+  GstBuffer *outbuf = NULL;
+  GByteArray *array = NULL;
+  gsize size = 0;
+
+  meta = (GstInferenceMeta *) gst_buffer_get_meta (buffer,
+      GST_INFERENCE_META_API_TYPE);
+  if (NULL == meta) {
+    GST_LOG_OBJECT (self, "No inference meta found, pushing an empty buffer");
+    outbuf = gst_buffer_new ();
+    goto out;
+  }
+
+  array = g_byte_array_sized_new (self->last_size);
+  gst_inference_meta_serialize (meta, array);
+  size = array->len;
+  self->last_size = size;
+
+  outbuf = gst_buffer_new_wrapped (g_byte_array_free (array, FALSE), size);
+
+out:
+  GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (buffer);
+  GST_BUFFER_DTS (outbuf) = GST_BUFFER_DTS (buffer);
+  GST_BUFFER_DURATION (outbuf) = GST_BUFFER_DURATION (buffer);
+
+  return outbuf;
+}
+
+static GstFlowReturn
+gst_inference_serializer_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstInferenceSerializer *self = GST_INFERENCE_SERIALIZER (parent);
+  GstBuffer *metabuf = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  metabuf = gst_inference_serializer_serialize (self, buffer);
+
+  ret = gst_pad_push (self->metapad, metabuf);
+  ret = gst_flow_combiner_update_pad_flow (self->combiner, self->metapad, ret);
+  if (GST_FLOW_OK != ret) {
+    gst_buffer_unref (buffer);
+    goto out;
+  }
+
+  ret = gst_pad_push (self->srcpad, buffer);
+  ret = gst_flow_combiner_update_pad_flow (self->combiner, self->srcpad, ret);
+
+out:
+  return ret;
+}
@@ -27,6 +27,7 @@
 #include "gstinferencecrop.h"
 #include "gstinferencedebug.h"
 #include "gstinferencefilter.h"
+#include "gstinferenceserializer.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -61,6 +62,13 @@ plugin_init (GstPlugin * plugin)
     goto out;
   }
 
+  ret =
+      gst_element_register (plugin, "inferenceserializer", GST_RANK_NONE,
+      GST_TYPE_INFERENCE_SERIALIZER);
+  if (!ret) {
+    goto out;
+  }
+
 out:
   return ret;
 }
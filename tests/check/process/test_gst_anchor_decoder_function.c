@@ -0,0 +1,276 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencepostprocess.h"
+#include "gst/r2inference/gstinferencepostprocesskernels.h"
+
+#define NUM_CLASSES 2
+#define BOX_DIM (5 + NUM_CLASSES)
+#define NUM_ANCHORS 5
+#define STRIDE 32
+
+/* Fills a TinyYOLOv2 style output with a single box at the given cell */
+static gfloat *
+new_grid_prediction (gint width, gint height, gint row, gint col,
+    gint anchor, const gfloat * box, gsize * predsize)
+{
+  gint grid_w = width / STRIDE;
+  gint grid_h = height / STRIDE;
+  gint index = (row * grid_w + col) * NUM_ANCHORS + anchor;
+  gfloat *prediction;
+
+  *predsize = grid_w * grid_h * NUM_ANCHORS * BOX_DIM * sizeof (gfloat);
+  prediction = g_malloc0 (*predsize);
+  memcpy (prediction + index * BOX_DIM, box, BOX_DIM * sizeof (gfloat));
+
+  return prediction;
+}
+
+GST_START_TEST (test_gst_anchor_decoder_grid_size)
+{
+  /* tx, ty, tw, th, objectness and class probabilities */
+  const gfloat box[BOX_DIM] = { 0.5, -0.25, 0.3, -0.2, 0.9, 0.1, 0.85 };
+  const gint sizes[][2] = { {416, 416}, {320, 320}, {640, 384} };
+  GstInferenceDecodeArena *arena = gst_inference_decode_arena_new ();
+  GstInferenceDecoderParams params;
+  gdouble width, height, x, y;
+  gfloat *prediction;
+  gsize predsize;
+  guint s;
+
+  /* The box in pixels, whatever the input size */
+  width = 6.63 * STRIDE * exp (0.3);
+  height = 11.38 * STRIDE * exp (-0.2);
+  x = 4 * STRIDE + STRIDE / (1 + exp (-0.5)) - width / 2;
+  y = 3 * STRIDE + STRIDE / (1 + exp (0.25)) - height / 2;
+
+  for (s = 0; s < G_N_ELEMENTS (sizes); ++s) {
+    prediction = new_grid_prediction (sizes[s][0], sizes[s][1], 3, 4, 2, box,
+        &predsize);
+
+    gst_inference_decoder_params_init_tinyyolov2 (&params, sizes[s][0],
+        sizes[s][1], NUM_CLASSES);
+    fail_unless (gst_inference_decode_arena_decode (arena, &params,
+            prediction, predsize, 0.5, 0.5, 0.3));
+
+    fail_unless_equals_int (arena->num_boxes, 1);
+    fail_unless_equals_int (arena->boxes[0].label, 1);
+    fail_unless (ABS (arena->boxes[0].prob - 0.85) < 1e-6);
+    fail_unless (ABS (arena->boxes[0].x - x) < 1e-3);
+    fail_unless (ABS (arena->boxes[0].y - y) < 1e-3);
+    fail_unless (ABS (arena->boxes[0].width - width) < 1e-3);
+    fail_unless (ABS (arena->boxes[0].height - height) < 1e-3);
+
+    /* An output laid out for another size is rejected */
+    params.input_width += STRIDE;
+    fail_if (gst_inference_decode_arena_decode (arena, &params, prediction,
+            predsize, 0.5, 0.5, 0.3));
+
+    g_free (prediction);
+  }
+
+  gst_inference_decode_arena_free (arena);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_anchor_decoder_legacy_match)
+{
+  const gfloat box[BOX_DIM] = { -1.5, 2.0, 0.7, 0.1, 0.6, 0.7, 0.2 };
+  GstInferenceDecodeArena *arena = gst_inference_decode_arena_new ();
+  GstInferenceDecoderParams params;
+  BBox expected;
+  gfloat *prediction;
+  gsize predsize;
+
+  prediction = new_grid_prediction (416, 416, 12, 0, 4, box, &predsize);
+
+  fail_unless (gst_inference_decode_arena_create_boxes (arena, prediction,
+          predsize, 0.5, 0.5, 0.3, NUM_CLASSES));
+  fail_unless_equals_int (arena->num_boxes, 1);
+  expected = arena->boxes[0];
+
+  /* The 416x416 entry point is the TinyYOLOv2 preset at that size */
+  gst_inference_decoder_params_init_tinyyolov2 (&params, 416, 416,
+      NUM_CLASSES);
+  fail_unless (gst_inference_decode_arena_decode (arena, &params, prediction,
+          predsize, 0.5, 0.5, 0.3));
+  fail_unless_equals_int (arena->num_boxes, 1);
+  fail_unless_equals_int (arena->boxes[0].label, expected.label);
+  fail_unless_equals_float (arena->boxes[0].x, expected.x);
+  fail_unless_equals_float (arena->boxes[0].y, expected.y);
+  fail_unless_equals_float (arena->boxes[0].width, expected.width);
+  fail_unless_equals_float (arena->boxes[0].height, expected.height);
+
+  g_free (prediction);
+  gst_inference_decode_arena_free (arena);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_anchor_decoder_params)
+{
+  const gdouble anchors[2 * (GST_INFERENCE_MAX_ANCHORS + 1)] = { 0 };
+  GstInferenceDecoderParams params;
+  gint i;
+
+  gst_inference_decoder_params_init_tinyyolov2 (&params, 416, 416, 20);
+  fail_unless_equals_int (gst_inference_decoder_params_get_num_boxes
+      (&params), 845);
+  gst_inference_decoder_params_init_tinyyolov3 (&params, 416, 416, 80);
+  fail_unless_equals_int (gst_inference_decoder_params_get_num_boxes
+      (&params), 2535);
+  gst_inference_decoder_params_init_tinyyolov3 (&params, 320, 320, 80);
+  fail_unless_equals_int (gst_inference_decoder_params_get_num_boxes
+      (&params), 1500);
+
+  gst_inference_decoder_params_init (&params, GST_INFERENCE_BOX_LAYOUT_GRID,
+      64, 64, NUM_CLASSES);
+  fail_if (gst_inference_decoder_params_add_level (&params, 8, anchors,
+          GST_INFERENCE_MAX_ANCHORS + 1));
+  for (i = 0; i < GST_INFERENCE_MAX_ANCHOR_LEVELS; ++i) {
+    fail_unless (gst_inference_decoder_params_add_level (&params, 8 << i,
+            anchors, 1));
+  }
+  fail_if (gst_inference_decoder_params_add_level (&params, 8, anchors, 1));
+  fail_unless_equals_int (gst_inference_decoder_params_get_num_boxes
+      (&params), 64 + 16 + 4 + 1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_anchor_decoder_exp_kernels)
+{
+  const gint count = 203;
+  GstInferenceExpFunc kernel;
+  gfloat in[203], out[203];
+  gdouble expected;
+  gint impl, i;
+
+  for (i = 0; i < count; ++i) {
+    in[i] = (i - count / 2) * 0.83f;
+  }
+
+  fail_unless (gst_inference_exp_get_impl (GST_INFERENCE_KERNEL_C) != NULL);
+  fail_unless (gst_inference_exp_get_func () != NULL);
+
+  for (impl = 0; impl < GST_INFERENCE_KERNEL_COUNT; ++impl) {
+    kernel = gst_inference_exp_get_impl ((GstInferenceKernelImpl) impl);
+    if (NULL == kernel) {
+      GST_INFO ("Kernel %d not supported on this CPU", impl);
+      continue;
+    }
+
+    kernel (in, out, count);
+    for (i = 0; i < count; ++i) {
+      expected = exp (in[i]);
+      fail_unless (ABS (out[i] - expected) <= 1e-6 * expected,
+          "Kernel %d gave %g for exp (%g)", impl, out[i], in[i]);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_anchor_decoder_filter_kernels)
+{
+  const gint count = 61;
+  const gint stride = 85;
+  const gfloat thresholds[] = { -1, 0.3, 0.5, 2 };
+  GstInferenceCompactAboveFunc compact_ref, compact;
+  GstInferenceArgmaxFunc argmax_ref, argmax;
+  gfloat *values;
+  guint expected[61], indices[61];
+  gfloat expected_max, max;
+  gint impl, i, n, len;
+  guint t;
+
+  /* Ties, NaN and an all NaN prefix in the same rows */
+  values = g_new (gfloat, count * stride);
+  for (i = 0; i < count * stride; ++i) {
+    values[i] = ((i * 7919) % 101) / 100.0;
+    if (0 == i % 13 || i < 5) {
+      values[i] = NAN;
+    }
+  }
+  values[40] = 2.0;
+  values[47] = 2.0;
+
+  compact_ref = gst_inference_compact_above_get_impl (GST_INFERENCE_KERNEL_C);
+  argmax_ref = gst_inference_argmax_get_impl (GST_INFERENCE_KERNEL_C);
+  fail_unless (compact_ref != NULL && argmax_ref != NULL);
+  fail_unless (gst_inference_compact_above_get_func () != NULL);
+  fail_unless (gst_inference_argmax_get_func () != NULL);
+
+  fail_unless_equals_int (argmax_ref (values, 5, &max), -1);
+  fail_unless_equals_int (argmax_ref (values, stride, &max), 40);
+
+  for (impl = 0; impl < GST_INFERENCE_KERNEL_COUNT; ++impl) {
+    compact = gst_inference_compact_above_get_impl ((GstInferenceKernelImpl)
+        impl);
+    argmax = gst_inference_argmax_get_impl ((GstInferenceKernelImpl) impl);
+    if (NULL == compact || NULL == argmax) {
+      GST_INFO ("Kernel %d not supported on this CPU", impl);
+      continue;
+    }
+
+    for (t = 0; t < G_N_ELEMENTS (thresholds); ++t) {
+      n = compact_ref (values + 4, stride, count, thresholds[t], expected);
+      fail_unless_equals_int (compact (values + 4, stride, count,
+              thresholds[t], indices), n);
+      for (i = 0; i < n; ++i) {
+        fail_unless_equals_int (indices[i], expected[i]);
+      }
+    }
+
+    for (len = 0; len <= stride; ++len) {
+      fail_unless_equals_int (argmax (values, len, &max), argmax_ref (values,
+              len, &expected_max));
+      fail_unless_equals_float (max, expected_max);
+    }
+  }
+
+  g_free (values);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_anchor_decoder_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_anchor_decoder");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_anchor_decoder_grid_size);
+  tcase_add_test (tc, test_gst_anchor_decoder_legacy_match);
+  tcase_add_test (tc, test_gst_anchor_decoder_params);
+  tcase_add_test (tc, test_gst_anchor_decoder_exp_kernels);
+  tcase_add_test (tc, test_gst_anchor_decoder_filter_kernels);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_anchor_decoder);
@@ -0,0 +1,127 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencepostprocess.h"
+
+#define NUM_CLASSES 2
+#define BOX_DIM (5 + NUM_CLASSES)
+#define NUM_BOXES 4
+
+/* YOLOv3 style corner boxes: x1, y1, x2, y2, objectness, class probs.
+ * Box 1 is covered by box 0, box 2 is under the objectness threshold */
+static const gfloat prediction[NUM_BOXES * BOX_DIM] = {
+  10, 10, 50, 50, 0.9, 0.2, 0.8,
+  12, 12, 52, 52, 0.9, 0.3, 0.7,
+  100, 100, 150, 150, 0.1, 0.9, 0.1,
+  200, 200, 260, 240, 0.8, 0.9, 0.1,
+};
+
+GST_START_TEST (test_gst_decode_arena_float)
+{
+  GstInferenceDecodeArena *arena = gst_inference_decode_arena_new ();
+  gboolean ret;
+
+  ret = gst_inference_decode_arena_create_boxes_float (arena,
+      (gpointer) prediction, sizeof (prediction), 0.5, 0.5, 0.4,
+      NUM_CLASSES);
+
+  fail_unless (ret);
+  fail_unless_equals_int (arena->num_boxes, 2);
+  fail_unless_equals_int (arena->num_classes, NUM_CLASSES);
+
+  /* Sorted by probability, each box next to its own row */
+  fail_unless_equals_int (arena->boxes[0].label, 0);
+  fail_unless_equals_float (arena->boxes[0].x, 200);
+  fail_unless_equals_float (arena->boxes[0].width, 60);
+  fail_unless_equals_float (arena->boxes[0].height, 40);
+  fail_unless_equals_float (arena->probabilities[0], 0.9f);
+  fail_unless_equals_float (arena->probabilities[1], 0.1f);
+
+  fail_unless_equals_int (arena->boxes[1].label, 1);
+  fail_unless_equals_float (arena->boxes[1].x, 10);
+  fail_unless_equals_float (arena->probabilities[2], 0.2f);
+  fail_unless_equals_float (arena->probabilities[3], 0.8f);
+
+  gst_inference_decode_arena_free (arena);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_decode_arena_reuse)
+{
+  GstInferenceDecodeArena *arena = gst_inference_decode_arena_new ();
+  gint i;
+
+  /* The previous content is replaced on every frame */
+  for (i = 0; i < 3; i++) {
+    gst_inference_decode_arena_create_boxes_float (arena,
+        (gpointer) prediction, sizeof (prediction), 0.5, 0.5, 0.4,
+        NUM_CLASSES);
+    fail_unless_equals_int (arena->num_boxes, 2);
+  }
+
+  /* Only the boxes that fit in the given size are read */
+  gst_inference_decode_arena_create_boxes_float (arena,
+      (gpointer) prediction, 2 * BOX_DIM * sizeof (gfloat), 0.5, 0.5, 0.4,
+      NUM_CLASSES);
+  fail_unless_equals_int (arena->num_boxes, 1);
+  fail_unless_equals_float (arena->boxes[0].x, 10);
+
+  gst_inference_decode_arena_free (arena);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_decode_arena_short_grid)
+{
+  GstInferenceDecodeArena *arena = gst_inference_decode_arena_new ();
+  gboolean ret;
+
+  /* A YOLOv2 grid needs the whole 13x13x5 output */
+  ret = gst_inference_decode_arena_create_boxes (arena, (gpointer) prediction,
+      sizeof (prediction), 0.5, 0.5, 0.4, NUM_CLASSES);
+
+  fail_if (ret);
+  fail_unless_equals_int (arena->num_boxes, 0);
+
+  gst_inference_decode_arena_free (arena);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_decode_arena_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_decode_arena");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_decode_arena_float);
+  tcase_add_test (tc, test_gst_decode_arena_reuse);
+  tcase_add_test (tc, test_gst_decode_arena_short_grid);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_decode_arena);
@@ -0,0 +1,207 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+#include "gst/r2inference/gstinferencemeta.h"
+
+static BoundingBox child_bbox = { 40, 80, 160, 320 };
+
+static GstInferenceMeta *
+add_meta (GstBuffer * buffer, guint64 * child_id)
+{
+  GstInferenceMeta *meta;
+  GstInferencePrediction *child;
+
+  meta = (GstInferenceMeta *) gst_buffer_add_meta (buffer,
+      gst_inference_meta_get_info (), NULL);
+
+  child = gst_inference_prediction_new_full (&child_bbox);
+  *child_id = child->prediction_id;
+  gst_inference_prediction_append (gst_inference_meta_get_prediction (meta),
+      child);
+
+  return meta;
+}
+
+static GstInferenceMeta *
+scale_meta (GstBuffer * src, GstInferenceMeta * smeta, GstBuffer * dst,
+    gint in_width, gint out_width)
+{
+  const GstMetaInfo *info = gst_inference_meta_get_info ();
+  GstVideoInfo in_info, out_info;
+  GstVideoMetaTransform trans = { &in_info, &out_info };
+
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_RGB, in_width,
+      in_width * 3 / 4);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_RGB, out_width,
+      out_width * 3 / 4);
+
+  fail_unless (info->transform_func (dst, (GstMeta *) smeta, src,
+          gst_video_meta_transform_scale_get_quark (), &trans));
+
+  return (GstInferenceMeta *) gst_buffer_get_meta (dst,
+      GST_INFERENCE_META_API_TYPE);
+}
+
+GST_START_TEST (test_gst_inference_meta_copy_shares_tree)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GstBuffer *copy;
+  GstInferenceMeta *meta, *cmeta;
+  GstInferencePrediction *root, *croot, *child;
+  guint64 child_id;
+
+  meta = add_meta (buffer, &child_id);
+  root = gst_inference_meta_get_prediction (meta);
+
+  copy = gst_buffer_copy (buffer);
+  cmeta = (GstInferenceMeta *) gst_buffer_get_meta (copy,
+      GST_INFERENCE_META_API_TYPE);
+
+  /* The copy only takes a reference */
+  fail_unless (cmeta->prediction == root);
+
+  /* Until one of them is accessed */
+  croot = gst_inference_meta_get_prediction (cmeta);
+  fail_if (croot == root);
+  fail_unless_equals_uint64 (croot->prediction_id, root->prediction_id);
+
+  child = gst_inference_prediction_find (croot, child_id);
+  fail_unless (child != NULL);
+  child->bbox.x = 0;
+  gst_inference_prediction_unref (child);
+
+  /* The original tree is untouched and not shared anymore */
+  fail_unless (gst_inference_meta_get_prediction (meta) == root);
+  child = gst_inference_prediction_find (root, child_id);
+  fail_unless_equals_int (child->bbox.x, child_bbox.x);
+  gst_inference_prediction_unref (child);
+
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_meta_lazy_scale)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GstBuffer *half = gst_buffer_new ();
+  GstBuffer *quarter = gst_buffer_new ();
+  GstInferenceMeta *meta, *hmeta, *qmeta;
+  GstInferencePrediction *root, *child;
+  guint64 child_id;
+
+  meta = add_meta (buffer, &child_id);
+  root = gst_inference_meta_get_prediction (meta);
+
+  hmeta = scale_meta (buffer, meta, half, 640, 320);
+  fail_unless (hmeta->prediction == root);
+  fail_unless (hmeta->scale_pending);
+
+  /* Scaling a pending scale keeps a single from -> to pair */
+  qmeta = scale_meta (half, hmeta, quarter, 320, 160);
+  fail_unless (qmeta->prediction == root);
+  fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&qmeta->scale_from), 640);
+  fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&qmeta->scale_to), 160);
+
+  child = gst_inference_prediction_find (gst_inference_meta_get_prediction
+      (qmeta), child_id);
+  fail_unless (child != NULL);
+  fail_if (qmeta->scale_pending);
+  fail_unless_equals_int (child->bbox.x, child_bbox.x / 4);
+  fail_unless_equals_int (child->bbox.y, child_bbox.y / 4);
+  fail_unless_equals_int (child->bbox.width, child_bbox.width / 4);
+  fail_unless_equals_int (child->bbox.height, child_bbox.height / 4);
+  gst_inference_prediction_unref (child);
+
+  child = gst_inference_prediction_find (gst_inference_meta_get_prediction
+      (hmeta), child_id);
+  fail_unless_equals_int (child->bbox.x, child_bbox.x / 2);
+  fail_unless_equals_int (child->bbox.width, child_bbox.width / 2);
+  gst_inference_prediction_unref (child);
+
+  /* The source still holds the original coordinates */
+  child = gst_inference_prediction_find (gst_inference_meta_get_prediction
+      (meta), child_id);
+  fail_unless_equals_int (child->bbox.x, child_bbox.x);
+  gst_inference_prediction_unref (child);
+
+  gst_buffer_unref (quarter);
+  gst_buffer_unref (half);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_meta_ref_keeps_tree)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GstBuffer *half = gst_buffer_new ();
+  GstInferenceMeta *meta, *hmeta;
+  GstInferencePrediction *root, *hroot, *child;
+  guint64 child_id;
+
+  meta = add_meta (buffer, &child_id);
+  root = gst_inference_meta_get_prediction (meta);
+
+  /* Reading a shared tree only takes a reference */
+  hroot = gst_inference_meta_ref_prediction (meta);
+  fail_unless (hroot == root);
+  gst_inference_prediction_unref (hroot);
+
+  /* Reading a pending scale gives a scaled copy, the meta keeps the
+   * shared tree and the pending scale */
+  hmeta = scale_meta (buffer, meta, half, 640, 320);
+  hroot = gst_inference_meta_ref_prediction (hmeta);
+  fail_if (hroot == root);
+  fail_unless (hmeta->prediction == root);
+  fail_unless (hmeta->scale_pending);
+
+  child = gst_inference_prediction_find (hroot, child_id);
+  fail_unless (child != NULL);
+  fail_unless_equals_int (child->bbox.x, child_bbox.x / 2);
+  gst_inference_prediction_unref (child);
+  gst_inference_prediction_unref (hroot);
+
+  gst_buffer_unref (half);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_meta_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_meta");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_meta_copy_shares_tree);
+  tcase_add_test (tc, test_gst_inference_meta_lazy_scale);
+  tcase_add_test (tc, test_gst_inference_meta_ref_keeps_tree);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_meta);
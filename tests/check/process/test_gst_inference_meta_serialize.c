@@ -0,0 +1,220 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencemeta.h"
+
+static BoundingBox root_bbox = { 0, 0, 640, 480 };
+static BoundingBox child_bbox = { -10, 20, 100, 200 };
+
+/* A root with a classified, disabled child that has a child itself */
+static GstInferenceMeta *
+add_meta (GstBuffer * buffer)
+{
+  const GstInferenceClassScore top[] = { {3, 0.75}, {1, 0.125} };
+  GstInferenceMeta *meta;
+  GstInferencePrediction *root, *child;
+  GstInferenceClassification *c;
+
+  meta = (GstInferenceMeta *) gst_buffer_add_meta (buffer,
+      gst_inference_meta_get_info (), NULL);
+  meta->stream_id = g_strdup ("stream");
+  root = gst_inference_meta_get_prediction (meta);
+  root->bbox = root_bbox;
+
+  child = gst_inference_prediction_new_full (&child_bbox);
+  c = gst_inference_classification_new_full (3, 0.75, "dog", 10, NULL, NULL);
+  gst_inference_classification_set_top (c, top, G_N_ELEMENTS (top));
+  gst_inference_prediction_append_classification (child, c);
+  gst_inference_prediction_append_classification (child,
+      gst_inference_classification_new_full (1, 0.5, NULL, 2, NULL, NULL));
+  gst_inference_prediction_append (child,
+      gst_inference_prediction_new_full (&root_bbox));
+  child->enabled = FALSE;
+  gst_inference_prediction_append (root, child);
+
+  return meta;
+}
+
+GST_START_TEST (test_gst_inference_meta_serialize_round_trip)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GstBuffer *copy = gst_buffer_new ();
+  GstInferenceMeta *meta, *cmeta;
+  GByteArray *array = g_byte_array_new ();
+  gchar *expected, *serial;
+
+  meta = add_meta (buffer);
+  cmeta = (GstInferenceMeta *) gst_buffer_add_meta (copy,
+      gst_inference_meta_get_info (), NULL);
+
+  gst_inference_meta_serialize (meta, array);
+  fail_unless_equals_uint64 (gst_inference_meta_reader_peek_size
+      (array->data, array->len), array->len);
+  fail_unless (gst_inference_meta_deserialize (cmeta, array->data,
+          array->len));
+
+  /* Same ids, boxes, classes and flags */
+  expected =
+      gst_inference_prediction_to_string (gst_inference_meta_get_prediction
+      (meta));
+  serial =
+      gst_inference_prediction_to_string (gst_inference_meta_get_prediction
+      (cmeta));
+  fail_unless_equals_string (serial, expected);
+  fail_unless_equals_string (cmeta->stream_id, "stream");
+
+  g_free (serial);
+  g_free (expected);
+  g_byte_array_free (array, TRUE);
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_meta_serialize_reader)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GByteArray *array = g_byte_array_new ();
+  GstInferenceMetaReader reader;
+  GstInferenceMetaNode node;
+  GstInferenceMetaClass c;
+  GstInferenceClassScore score;
+  GstInferencePrediction *root;
+
+  add_meta (buffer);
+  root = gst_inference_meta_get_prediction ((GstInferenceMeta *)
+      gst_buffer_get_meta (buffer, GST_INFERENCE_META_API_TYPE));
+
+  /* Appended after what is already there, read in place */
+  g_byte_array_append (array, (const guint8 *) "abc", 3);
+  gst_inference_meta_serialize ((GstInferenceMeta *)
+      gst_buffer_get_meta (buffer, GST_INFERENCE_META_API_TYPE), array);
+  fail_unless (gst_inference_meta_reader_init (&reader, array->data + 3,
+          array->len - 3));
+
+  fail_unless_equals_int (reader.num_nodes, 3);
+  fail_unless_equals_int (reader.num_classes, 2);
+  fail_unless_equals_int (reader.num_scores, 2);
+  fail_unless_equals_string (reader.stream_id, "stream");
+
+  /* Parents come before their children */
+  fail_unless (gst_inference_meta_reader_get_node (&reader, 0, &node));
+  fail_unless_equals_uint64 (node.prediction_id, root->prediction_id);
+  fail_unless_equals_int (node.parent, -1);
+  fail_unless_equals_int (node.num_classes, 0);
+  fail_unless (node.enabled);
+
+  fail_unless (gst_inference_meta_reader_get_node (&reader, 1, &node));
+  fail_unless_equals_int (node.parent, 0);
+  fail_unless_equals_int (node.bbox.x, child_bbox.x);
+  fail_unless_equals_int (node.bbox.height, child_bbox.height);
+  fail_unless_equals_int (node.first_class, 0);
+  fail_unless_equals_int (node.num_classes, 2);
+  fail_if (node.enabled);
+
+  fail_unless (gst_inference_meta_reader_get_node (&reader, 2, &node));
+  fail_unless_equals_int (node.parent, 1);
+  fail_if (gst_inference_meta_reader_get_node (&reader, 3, &node));
+
+  fail_unless (gst_inference_meta_reader_get_class (&reader, 0, &c));
+  fail_unless_equals_int (c.class_id, 3);
+  fail_unless_equals_float (c.class_prob, 0.75);
+  fail_unless_equals_string (c.class_label, "dog");
+  fail_unless_equals_int (c.num_classes, 10);
+  fail_unless_equals_int (c.num_scores, 2);
+
+  fail_unless (gst_inference_meta_reader_get_class (&reader, 1, &c));
+  fail_unless (NULL == c.class_label);
+  fail_unless_equals_int (c.num_scores, 0);
+
+  fail_unless (gst_inference_meta_reader_get_score (&reader, 1, &score));
+  fail_unless_equals_int (score.class_id, 1);
+  fail_unless_equals_float (score.prob, 0.125);
+
+  g_byte_array_free (array, TRUE);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_meta_serialize_invalid)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  GstBuffer *copy = gst_buffer_new ();
+  GstInferenceMeta *meta, *cmeta;
+  GstInferencePrediction *root;
+  GByteArray *array = g_byte_array_new ();
+  guint8 *data;
+  guint i;
+
+  meta = add_meta (buffer);
+  cmeta = (GstInferenceMeta *) gst_buffer_add_meta (copy,
+      gst_inference_meta_get_info (), NULL);
+  root = gst_inference_meta_get_prediction (cmeta);
+
+  gst_inference_meta_serialize (meta, array);
+  data = g_malloc (array->len);
+  memcpy (data, array->data, array->len);
+
+  /* Truncated data is never read, nor applied */
+  for (i = 0; i < array->len; ++i) {
+    fail_if (gst_inference_meta_deserialize (cmeta, data, i));
+  }
+
+  /* Nor a node pointing forward to its parent, the parent field of the
+   * second node after the 40 byte header and the 40 byte root node */
+  GST_WRITE_UINT32_LE (data + 40 + 40 + 24, 2);
+  fail_if (gst_inference_meta_deserialize (cmeta, data, array->len));
+
+  data[0] = 'X';
+  fail_if (gst_inference_meta_deserialize (cmeta, data, array->len));
+  fail_unless_equals_uint64 (gst_inference_meta_reader_peek_size (data,
+          array->len), 0);
+
+  fail_unless (gst_inference_meta_get_prediction (cmeta) == root);
+
+  g_free (data);
+  g_byte_array_free (array, TRUE);
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_meta_serialize_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_meta_serialize");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_meta_serialize_round_trip);
+  tcase_add_test (tc, test_gst_inference_meta_serialize_reader);
+  tcase_add_test (tc, test_gst_inference_meta_serialize_invalid);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_meta_serialize);
@@ -0,0 +1,160 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* Built in, so the counters can be moved next to the wrap-around */
+#include "gst/r2inference/gstinferencering.c"
+
+#define DEPTH 3
+
+static gint items[2 * DEPTH];
+
+GST_START_TEST (test_gst_inference_ring_empty)
+{
+  GstInferenceRing *ring = gst_inference_ring_new (DEPTH);
+
+  fail_unless_equals_int (gst_inference_ring_get_depth (ring), DEPTH);
+  fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), 0);
+  fail_unless (gst_inference_ring_peek (ring) == NULL);
+  fail_unless (gst_inference_ring_pop (ring) == NULL);
+
+  gst_inference_ring_free (ring, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_ring_full)
+{
+  GstInferenceRing *ring = gst_inference_ring_new (DEPTH);
+  guint i;
+
+  /* The depth is the limit, not the power-of-two capacity behind it */
+  for (i = 0; i < DEPTH; i++) {
+    fail_unless (gst_inference_ring_push (ring, &items[i]));
+    fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), i + 1);
+  }
+  fail_if (gst_inference_ring_push (ring, &items[DEPTH]));
+  fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), DEPTH);
+
+  /* Popping makes room for one more */
+  fail_unless (gst_inference_ring_pop (ring) == &items[0]);
+  fail_unless (gst_inference_ring_push (ring, &items[DEPTH]));
+  fail_if (gst_inference_ring_push (ring, &items[DEPTH + 1]));
+
+  gst_inference_ring_free (ring, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_ring_peek_pop)
+{
+  GstInferenceRing *ring = gst_inference_ring_new (DEPTH);
+
+  fail_unless (gst_inference_ring_push (ring, &items[0]));
+  fail_unless (gst_inference_ring_push (ring, &items[1]));
+
+  /* Peek leaves the oldest item in place */
+  fail_unless (gst_inference_ring_peek (ring) == &items[0]);
+  fail_unless (gst_inference_ring_peek (ring) == &items[0]);
+  fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), 2);
+
+  fail_unless (gst_inference_ring_pop (ring) == &items[0]);
+  fail_unless (gst_inference_ring_peek (ring) == &items[1]);
+  fail_unless (gst_inference_ring_pop (ring) == &items[1]);
+  fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), 0);
+  fail_unless (gst_inference_ring_peek (ring) == NULL);
+
+  gst_inference_ring_free (ring, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_inference_ring_wrap_around)
+{
+  GstInferenceRing *ring = gst_inference_ring_new (DEPTH);
+  guint i;
+
+  /* Start right before the counters overflow */
+  ring->head = (gint) (G_MAXUINT - 1);
+  ring->tail = (gint) (G_MAXUINT - 1);
+
+  for (i = 0; i < DEPTH; i++) {
+    fail_unless (gst_inference_ring_push (ring, &items[i]));
+  }
+  fail_if (gst_inference_ring_push (ring, &items[DEPTH]));
+  fail_unless_equals_int (gst_inference_ring_get_occupancy (ring), DEPTH);
+
+  /* The head wrapped already, the tail wraps while popping */
+  fail_unless ((guint) ring->head < (guint) ring->tail);
+  for (i = 0; i < DEPTH; i++) {
+    fail_unless (gst_inference_ring_pop (ring) == &items[i]);
+    fail_unless_equals_int (gst_inference_ring_get_occupancy (ring),
+        DEPTH - i - 1);
+  }
+  fail_unless (gst_inference_ring_pop (ring) == NULL);
+
+  gst_inference_ring_free (ring, NULL);
+}
+
+GST_END_TEST;
+
+static void
+count_item (gpointer item)
+{
+  *((gint *) item) += 1;
+}
+
+GST_START_TEST (test_gst_inference_ring_free_items)
+{
+  GstInferenceRing *ring = gst_inference_ring_new (DEPTH);
+
+  items[0] = 0;
+  items[1] = 0;
+  fail_unless (gst_inference_ring_push (ring, &items[0]));
+  fail_unless (gst_inference_ring_push (ring, &items[1]));
+
+  gst_inference_ring_free (ring, count_item);
+
+  fail_unless_equals_int (items[0], 1);
+  fail_unless_equals_int (items[1], 1);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_inference_ring_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_inference_ring");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_inference_ring_empty);
+  tcase_add_test (tc, test_gst_inference_ring_full);
+  tcase_add_test (tc, test_gst_inference_ring_peek_pop);
+  tcase_add_test (tc, test_gst_inference_ring_wrap_around);
+  tcase_add_test (tc, test_gst_inference_ring_free_items);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_inference_ring);
@@ -0,0 +1,218 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+#include <string.h>
+#include "gst/r2inference/gstinferencenms.h"
+#include "gst/r2inference/gstinferencepostprocess.h"
+
+#define NUM_BOXES 5
+
+/* Two overlapping pairs of class 0, one of them overlapped by a class 1
+ * box, and an isolated class 0 box */
+static void
+gst_nms_fill_boxes (BBox * boxes)
+{
+  BBox fill[NUM_BOXES] = {
+    {0, 0.6, 0, 0, 10, 10},
+    {0, 0.9, 1, 1, 10, 10},
+    {1, 0.8, 1, 0, 10, 10},
+    {0, 0.7, 100, 100, 10, 10},
+    {0, 0.5, 50, 50, 10, 10},
+  };
+
+  memcpy (boxes, fill, sizeof (fill));
+}
+
+GST_START_TEST (test_gst_nms_per_class)
+{
+  GstInferenceNmsParams params;
+  BBox boxes[NUM_BOXES];
+  guint keep[NUM_BOXES];
+  guint num_kept;
+
+  gst_nms_fill_boxes (boxes);
+  gst_inference_nms_params_init (&params, 0.5);
+
+  num_kept = gst_inference_nms_run (NULL, &params, boxes, NUM_BOXES, keep);
+
+  /* Box 0 is covered by box 1, box 2 survives as it is another class */
+  fail_unless_equals_int (num_kept, 4);
+  fail_unless_equals_int (keep[0], 1);
+  fail_unless_equals_int (keep[1], 2);
+  fail_unless_equals_int (keep[2], 3);
+  fail_unless_equals_int (keep[3], 4);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_nms_class_agnostic)
+{
+  GstInferenceNmsParams params;
+  BBox boxes[NUM_BOXES];
+  guint keep[NUM_BOXES];
+  guint num_kept;
+
+  gst_nms_fill_boxes (boxes);
+  gst_inference_nms_params_init (&params, 0.5);
+  params.per_class = FALSE;
+
+  num_kept = gst_inference_nms_run (NULL, &params, boxes, NUM_BOXES, keep);
+
+  fail_unless_equals_int (num_kept, 3);
+  fail_unless_equals_int (keep[0], 1);
+  fail_unless_equals_int (keep[1], 3);
+  fail_unless_equals_int (keep[2], 4);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_nms_top_k)
+{
+  GstInferenceNmsParams params;
+  BBox boxes[NUM_BOXES];
+  guint keep[NUM_BOXES];
+  guint num_kept;
+
+  gst_nms_fill_boxes (boxes);
+  gst_inference_nms_params_init (&params, 0.5);
+  params.top_k = 2;
+
+  num_kept = gst_inference_nms_run (NULL, &params, boxes, NUM_BOXES, keep);
+
+  fail_unless_equals_int (num_kept, 2);
+  fail_unless_equals_int (keep[0], 1);
+  fail_unless_equals_int (keep[1], 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_nms_soft_linear)
+{
+  GstInferenceNmsParams params;
+  BBox boxes[NUM_BOXES];
+  guint keep[NUM_BOXES];
+  guint num_kept;
+  gdouble iou;
+
+  gst_nms_fill_boxes (boxes);
+  gst_inference_nms_params_init (&params, 0.5);
+  params.method = GST_INFERENCE_NMS_SOFT_LINEAR;
+
+  num_kept = gst_inference_nms_run (NULL, &params, boxes, NUM_BOXES, keep);
+
+  /* Box 0 is decayed instead of dropped and ends up last */
+  iou = 81.0 / 119.0;
+  fail_unless_equals_int (num_kept, 5);
+  fail_unless_equals_int (keep[4], 0);
+  fail_unless (fabs (boxes[0].prob - 0.6 * (1 - iou)) < 1e-5);
+  fail_unless_equals_float (boxes[1].prob, 0.9);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_nms_many_boxes)
+{
+  GstInferenceNmsParams params;
+  BBox *boxes;
+  guint *keep;
+  guint num_kept;
+  gint num_boxes = 1000;
+  gint i;
+
+  boxes = g_new0 (BBox, num_boxes);
+  keep = g_new (guint, num_boxes);
+
+  /* A grid of disjoint pairs, the second box of each pair is a slightly
+   * shifted copy with a lower score */
+  for (i = 0; i < num_boxes; i++) {
+    boxes[i].label = 0;
+    boxes[i].prob = i % 2 ? 0.4 : 0.8;
+    boxes[i].x = (i / 2) % 25 * 20 + i % 2;
+    boxes[i].y = (i / 2) / 25 * 20;
+    boxes[i].width = 10;
+    boxes[i].height = 10;
+  }
+
+  gst_inference_nms_params_init (&params, 0.5);
+  num_kept = gst_inference_nms_run (NULL, &params, boxes, num_boxes, keep);
+
+  fail_unless_equals_int (num_kept, num_boxes / 2);
+  for (i = 0; i < (gint) num_kept; i++) {
+    fail_unless_equals_int (keep[i] % 2, 0);
+  }
+
+  g_free (boxes);
+  g_free (keep);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_remove_duplicated_boxes_probabilities)
+{
+  GstInferenceNmsParams params;
+  BBox boxes[NUM_BOXES];
+  gdouble values[NUM_BOXES];
+  gdouble *probabilities[NUM_BOXES];
+  gint num_boxes = NUM_BOXES;
+  gint i;
+
+  gst_nms_fill_boxes (boxes);
+  for (i = 0; i < NUM_BOXES; i++) {
+    values[i] = boxes[i].prob;
+    probabilities[i] = &values[i];
+  }
+
+  gst_inference_nms_params_init (&params, 0.5);
+  gst_remove_duplicated_boxes_full (&params, boxes, probabilities,
+      &num_boxes);
+
+  /* Every remaining box keeps its own probabilities, the removed ones
+   * are moved behind */
+  fail_unless_equals_int (num_boxes, 4);
+  for (i = 0; i < num_boxes; i++) {
+    fail_unless_equals_float (*probabilities[i], boxes[i].prob);
+  }
+  fail_unless (probabilities[4] == &values[0]);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_nms_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_nms");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_nms_per_class);
+  tcase_add_test (tc, test_gst_nms_class_agnostic);
+  tcase_add_test (tc, test_gst_nms_top_k);
+  tcase_add_test (tc, test_gst_nms_soft_linear);
+  tcase_add_test (tc, test_gst_nms_many_boxes);
+  tcase_add_test (tc, test_gst_remove_duplicated_boxes_probabilities);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_nms);
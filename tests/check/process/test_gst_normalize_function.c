@@ -22,6 +22,10 @@
 #include <gst/check/gstcheck.h>
 #include "preprocess_functions_utils.c"
 #include "gst/r2inference/gstinferencepreprocess.h"
+#include "gst/r2inference/gstinferencepreprocesskernels.h"
+
+#define PATTERN_WIDTH 37
+#define PATTERN_HEIGHT 3
 
 GST_START_TEST (test_gst_normalize_RGBA)
 {
@@ -1222,6 +1226,191 @@ GST_START_TEST (test_gst_normalize_zero_mean_null_outframe)
 
 GST_END_TEST;
 
+GST_START_TEST (test_gst_normalize_varying_pixels)
+{
+  /* Format, bytes per pixel, offset and first index of every layout */
+  const struct
+  {
+    GstVideoFormat format;
+    gint channels;
+    gint offset;
+    gint first_index;
+  } layouts[] = {
+    {GST_VIDEO_FORMAT_RGB, 3, 0, 0},
+    {GST_VIDEO_FORMAT_BGR, 3, 0, 2},
+    {GST_VIDEO_FORMAT_RGBA, 4, 0, 0},
+    {GST_VIDEO_FORMAT_BGRx, 4, 0, 2},
+    {GST_VIDEO_FORMAT_ARGB, 4, 1, 0},
+    {GST_VIDEO_FORMAT_xBGR, 4, 1, 2},
+  };
+  GstVideoInfo info;
+  GstBuffer *inbuf, *outbuf;
+  GstVideoFrame inframe, outframe;
+  GstMapFlags flags;
+  const gdouble mean = 128.0;
+  const gdouble std = 1 / 128.0;
+  guchar *in, *pixel;
+  gfloat *out, expected;
+  gint stride, i, j, c, index;
+  guint l;
+
+  for (l = 0; l < G_N_ELEMENTS (layouts); ++l) {
+    gst_video_info_init (&info);
+    gst_video_info_set_format (&info, layouts[l].format, PATTERN_WIDTH,
+        PATTERN_HEIGHT);
+
+    inbuf = gst_buffer_new_allocate (NULL, info.size, NULL);
+    outbuf = gst_buffer_new_allocate (NULL,
+        PATTERN_WIDTH * PATTERN_HEIGHT * 3 * sizeof (gfloat), NULL);
+
+    flags = (GstMapFlags) (GST_MAP_READWRITE | GST_VIDEO_FRAME_MAP_FLAG_NO_REF);
+    fail_unless (gst_video_frame_map (&inframe, &info, inbuf, flags));
+    fail_unless (gst_video_frame_map (&outframe, &info, outbuf, flags));
+
+    /* Every component of every pixel gets a different value */
+    in = (guchar *) inframe.data[0];
+    stride = GST_VIDEO_FRAME_COMP_STRIDE (&inframe, 0);
+    for (i = 0; i < PATTERN_HEIGHT; ++i) {
+      for (j = 0; j < stride; ++j) {
+        in[i * stride + j] = (guchar) (i * 61 + j * 7);
+      }
+    }
+
+    fail_unless (gst_normalize (&inframe, &outframe, mean, std, 3));
+
+    out = (gfloat *) outframe.data[0];
+    for (i = 0; i < PATTERN_HEIGHT; ++i) {
+      for (j = 0; j < PATTERN_WIDTH; ++j) {
+        pixel = in + i * stride + j * layouts[l].channels + layouts[l].offset;
+        for (c = 0; c < 3; ++c) {
+          index = 0 == c ? layouts[l].first_index :
+              2 == c ? 2 - layouts[l].first_index : 1;
+          expected = (pixel[c] - mean) * std;
+          fail_unless (out[(i * PATTERN_WIDTH + j) * 3 + index] == expected);
+        }
+      }
+    }
+
+    gst_video_frame_unmap (&inframe);
+    gst_video_frame_unmap (&outframe);
+    gst_buffer_unref (inbuf);
+    gst_buffer_unref (outbuf);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_normalize_kernels_match_scalar)
+{
+  const gint width = 97;
+  const gdouble mean[3] = { 123.68, 116.78, 103.94 };
+  const gdouble std[3] = { 1 / 58.0, 1 / 57.0, 1 / 57.5 };
+  GstInferenceNormalizeParams params;
+  GstInferenceNormalizeRowFunc reference, kernel;
+  guchar in[97 * 4];
+  gfloat expected[97 * 3], out[97 * 3];
+  gint impl, channels, offset, first_index, j;
+
+  for (j = 0; j < (gint) sizeof (in); ++j) {
+    in[j] = (guchar) (j * 37 + 11);
+  }
+
+  reference = gst_inference_normalize_get_impl (GST_INFERENCE_KERNEL_C);
+  fail_unless (reference != NULL);
+  fail_unless (gst_inference_normalize_get_row_func () != NULL);
+
+  for (impl = 0; impl < GST_INFERENCE_KERNEL_COUNT; ++impl) {
+    kernel = gst_inference_normalize_get_impl ((GstInferenceKernelImpl) impl);
+    if (NULL == kernel) {
+      GST_INFO ("Kernel %d not supported on this CPU", impl);
+      continue;
+    }
+
+    for (channels = 1; channels <= 4; ++channels) {
+      for (offset = 0; offset <= (4 == channels ? 1 : 0); ++offset) {
+        for (first_index = 0; first_index <= 2; first_index += 2) {
+          if (2 == channels) {
+            continue;
+          }
+          gst_inference_normalize_params_init (&params, channels, offset,
+              first_index, 2 - first_index, mean, std);
+          reference (&params, in, expected, width);
+          kernel (&params, in, out, width);
+          fail_unless (0 == memcmp (expected, out, sizeof (out)));
+        }
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_normalize_fused)
+{
+  const GstVideoFormat formats[] = { GST_VIDEO_FORMAT_NV12,
+    GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_YUY2
+  };
+  /* Input and output sizes exercising area and bilinear sampling */
+  const gint sizes[][4] = { {8, 4, 4, 2}, {4, 4, 6, 6} };
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe;
+  GstBuffer *inbuf, *outbuf;
+  GstAllocationParams params;
+  guint8 *comp;
+  gfloat expected;
+  gboolean ret;
+  guint f, s;
+  gint c, i, j;
+
+  expected = 200.0 / 255.0;
+  gst_allocation_params_init (&params);
+
+  for (f = 0; f < G_N_ELEMENTS (formats); ++f) {
+    for (s = 0; s < G_N_ELEMENTS (sizes); ++s) {
+      gst_video_info_set_format (&ininfo, formats[f], sizes[s][0],
+          sizes[s][1]);
+      ininfo.colorimetry.range = GST_VIDEO_COLOR_RANGE_0_255;
+      gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_RGB, sizes[s][2],
+          sizes[s][3]);
+
+      inbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&ininfo),
+          &params);
+      outbuf = gst_buffer_new_allocate (NULL,
+          GST_VIDEO_INFO_SIZE (&outinfo) * sizeof (float), &params);
+
+      fail_unless (gst_video_frame_map (&inframe, &ininfo, inbuf,
+              GST_MAP_WRITE));
+      fail_unless (gst_video_frame_map (&outframe, &outinfo, outbuf,
+              GST_MAP_WRITE));
+
+      /* A neutral chroma makes every RGB channel equal to the luma */
+      for (c = 0; c < 3; ++c) {
+        for (i = 0; i < GST_VIDEO_FRAME_COMP_HEIGHT (&inframe, c); ++i) {
+          comp = GST_VIDEO_FRAME_COMP_DATA (&inframe, c);
+          comp += i * GST_VIDEO_FRAME_COMP_STRIDE (&inframe, c);
+          for (j = 0; j < GST_VIDEO_FRAME_COMP_WIDTH (&inframe, c); ++j) {
+            comp[j * GST_VIDEO_FRAME_COMP_PSTRIDE (&inframe, c)] =
+                0 == c ? 200 : 128;
+          }
+        }
+      }
+
+      ret = gst_normalize (&inframe, &outframe, 0, 1 / 255.0, 3);
+      fail_unless (ret);
+
+      gst_check_output_pixels (&outframe, expected, expected, expected, 0, 2,
+          3);
+
+      gst_video_frame_unmap (&inframe);
+      gst_video_frame_unmap (&outframe);
+      gst_buffer_unref (inbuf);
+      gst_buffer_unref (outbuf);
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_normalize_suite (void)
 {
@@ -1260,6 +1449,9 @@ gst_normalize_suite (void)
   tcase_add_test (tc, test_gst_normalize_zero_mean_odd_height);
   tcase_add_test (tc, test_gst_normalize_zero_mean_null_inframe);
   tcase_add_test (tc, test_gst_normalize_zero_mean_null_outframe);
+  tcase_add_test (tc, test_gst_normalize_varying_pixels);
+  tcase_add_test (tc, test_gst_normalize_kernels_match_scalar);
+  tcase_add_test (tc, test_gst_normalize_fused);
 
   return suite;
 }
@@ -0,0 +1,242 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+#include "gst/r2inference/gstinferencepreprocess.h"
+#include "gst/r2inference/gstinferencepreprocesskernels.h"
+
+#define FRAME_WIDTH 64
+#define FRAME_HEIGHT 48
+#define TENSOR_WIDTH 24
+#define TENSOR_HEIGHT 20
+
+/* Maps a new frame, with room for a float tensor if requested */
+static void
+map_frame (GstVideoFrame * frame, GstVideoFormat format, gint width,
+    gint height, gsize element_size)
+{
+  GstVideoInfo info;
+  GstBuffer *buffer;
+
+  gst_video_info_set_format (&info, format, width, height);
+  info.colorimetry.range = GST_VIDEO_COLOR_RANGE_0_255;
+  buffer = gst_buffer_new_allocate (NULL,
+      GST_VIDEO_INFO_SIZE (&info) * element_size, NULL);
+  fail_unless (gst_video_frame_map (frame, &info, buffer, GST_MAP_READWRITE));
+  gst_buffer_unref (buffer);
+}
+
+/* Copies a region of every component into a frame of the region size */
+static void
+crop_frame (GstVideoFrame * src, GstVideoFrame * dst, const BoundingBox * roi)
+{
+  const GstVideoFormatInfo *finfo = src->info.finfo;
+  guint8 *in, *out;
+  gint c, i, j, x, y, pstride;
+
+  map_frame (dst, GST_VIDEO_FRAME_FORMAT (src), roi->width, roi->height, 1);
+
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (src); ++c) {
+    x = GST_VIDEO_SUB_SCALE (GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c), roi->x);
+    y = GST_VIDEO_SUB_SCALE (GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c), roi->y);
+    pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (src, c);
+    for (i = 0; i < GST_VIDEO_FRAME_COMP_HEIGHT (dst, c); ++i) {
+      in = GST_VIDEO_FRAME_COMP_DATA (src, c);
+      in += (y + i) * GST_VIDEO_FRAME_COMP_STRIDE (src, c) + x * pstride;
+      out = GST_VIDEO_FRAME_COMP_DATA (dst, c);
+      out += i * GST_VIDEO_FRAME_COMP_STRIDE (dst, c);
+      for (j = 0; j < GST_VIDEO_FRAME_COMP_WIDTH (dst, c); ++j) {
+        out[j * pstride] = in[j * pstride];
+      }
+    }
+  }
+}
+
+GST_START_TEST (test_gst_normalize_rois_match_crop)
+{
+  const GstVideoFormat formats[] = { GST_VIDEO_FORMAT_RGB,
+    GST_VIDEO_FORMAT_BGRx, GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_I420,
+    GST_VIDEO_FORMAT_YUY2
+  };
+  /* Regions larger and smaller than the tensor, and the whole frame */
+  const BoundingBox rois[] = { {0, 0, FRAME_WIDTH, FRAME_HEIGHT},
+  {6, 4, 30, 22}, {10, 8, 8, 6}, {40, 30, 24, 18}
+  };
+  const gdouble mean[3] = { 128.0, 128.0, 128.0 };
+  const gdouble std[3] = { 1 / 128.0, 1 / 128.0, 1 / 128.0 };
+  const gsize tensor_size = TENSOR_WIDTH * TENSOR_HEIGHT * 3;
+  GstVideoFrame inframe, cropped, outframe;
+  gfloat *tensors, *expected;
+  guint8 *data;
+  guint f, r;
+  gsize i;
+
+  tensors = g_new (gfloat, G_N_ELEMENTS (rois) * tensor_size);
+
+  for (f = 0; f < G_N_ELEMENTS (formats); ++f) {
+    map_frame (&inframe, formats[f], FRAME_WIDTH, FRAME_HEIGHT, 1);
+    data = (guint8 *) inframe.data[0];
+    for (i = 0; i < GST_VIDEO_FRAME_SIZE (&inframe); ++i) {
+      data[i] = (guint8) (i * 37 + i / 97);
+    }
+
+    fail_unless (gst_normalize_rois (&inframe, rois, G_N_ELEMENTS (rois),
+            tensors, TENSOR_WIDTH, TENSOR_HEIGHT, mean, std));
+
+    /* Every region matches the fused path on a physical crop */
+    for (r = 0; r < G_N_ELEMENTS (rois); ++r) {
+      crop_frame (&inframe, &cropped, &rois[r]);
+      map_frame (&outframe, GST_VIDEO_FORMAT_RGB, TENSOR_WIDTH,
+          TENSOR_HEIGHT, sizeof (gfloat));
+
+      fail_unless (gst_normalize (&cropped, &outframe, mean[0], std[0], 3));
+
+      expected = (gfloat *) outframe.data[0];
+      for (i = 0; i < tensor_size; ++i) {
+        fail_unless (ABS (expected[i] - tensors[r * tensor_size + i]) < 1e-4,
+            "Region %u of format %u differs at %" G_GSIZE_FORMAT, r, f, i);
+      }
+
+      gst_video_frame_unmap (&outframe);
+      gst_video_frame_unmap (&cropped);
+    }
+
+    gst_video_frame_unmap (&inframe);
+  }
+
+  g_free (tensors);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_normalize_rois_neutral_chroma)
+{
+  const BoundingBox rois[] = { {-8, -8, 20, 16}, {50, 40, 30, 30},
+  {13, 7, 9, 5}
+  };
+  const gdouble mean[3] = { 0, 0, 0 };
+  const gdouble std[3] = { 1 / 255.0, 1 / 255.0, 1 / 255.0 };
+  const gsize tensor_size = TENSOR_WIDTH * TENSOR_HEIGHT * 3;
+  GstVideoFrame inframe;
+  gfloat *tensors;
+  guint8 *data;
+  gsize i;
+
+  map_frame (&inframe, GST_VIDEO_FORMAT_NV12, FRAME_WIDTH, FRAME_HEIGHT, 1);
+  data = GST_VIDEO_FRAME_PLANE_DATA (&inframe, 0);
+  memset (data, 200, GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, 0) *
+      FRAME_HEIGHT);
+  data = GST_VIDEO_FRAME_PLANE_DATA (&inframe, 1);
+  memset (data, 128, GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, 1) *
+      GST_VIDEO_FRAME_COMP_HEIGHT (&inframe, 1));
+
+  tensors = g_new (gfloat, G_N_ELEMENTS (rois) * tensor_size);
+
+  /* Regions going out of the frame are clamped to it */
+  fail_unless (gst_normalize_rois (&inframe, rois, G_N_ELEMENTS (rois),
+          tensors, TENSOR_WIDTH, TENSOR_HEIGHT, mean, std));
+
+  for (i = 0; i < G_N_ELEMENTS (rois) * tensor_size; ++i) {
+    fail_unless (ABS (tensors[i] - 200.0 / 255.0) < 1e-4);
+  }
+
+  g_free (tensors);
+  gst_video_frame_unmap (&inframe);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_normalize_rois_null_rois)
+{
+  const gdouble mean[3] = { 0, 0, 0 };
+  const gdouble std[3] = { 1, 1, 1 };
+  GstVideoFrame inframe;
+  gfloat tensor[3];
+
+  map_frame (&inframe, GST_VIDEO_FORMAT_RGB, 4, 2, 1);
+
+  ASSERT_CRITICAL (gst_normalize_rois (&inframe, NULL, 1, tensor, 1, 1, mean,
+          std));
+  /* No regions is a valid, empty batch */
+  fail_unless (gst_normalize_rois (&inframe, NULL, 0, NULL, 1, 1, mean, std));
+
+  gst_video_frame_unmap (&inframe);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_normalize_rois_blend_kernels)
+{
+  const gint width = 75;
+  const gfloat weights[] = { 0.0, 0.25, 0.6, 1.0 };
+  GstInferenceBlendRowFunc reference, kernel;
+  guint8 top[75], bottom[75];
+  gfloat expected[75], out[75];
+  gint impl, j;
+  guint w;
+
+  for (j = 0; j < width; ++j) {
+    top[j] = (guint8) (j * 37 + 11);
+    bottom[j] = (guint8) (j * 91 + 3);
+  }
+
+  reference = gst_inference_blend_get_impl (GST_INFERENCE_KERNEL_C);
+  fail_unless (reference != NULL);
+  fail_unless (gst_inference_blend_get_row_func () != NULL);
+
+  for (impl = 0; impl < GST_INFERENCE_KERNEL_COUNT; ++impl) {
+    kernel = gst_inference_blend_get_impl ((GstInferenceKernelImpl) impl);
+    if (NULL == kernel) {
+      GST_INFO ("Kernel %d not supported on this CPU", impl);
+      continue;
+    }
+
+    for (w = 0; w < G_N_ELEMENTS (weights); ++w) {
+      reference (top, bottom, weights[w], expected, width);
+      kernel (top, bottom, weights[w], out, width);
+      for (j = 0; j < width; ++j) {
+        /* Fused multiply-add may round the last bit differently */
+        fail_unless (ABS (expected[j] - out[j]) < 1e-4);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_normalize_rois_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_normalize_rois");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_normalize_rois_match_crop);
+  tcase_add_test (tc, test_gst_normalize_rois_neutral_chroma);
+  tcase_add_test (tc, test_gst_normalize_rois_null_rois);
+  tcase_add_test (tc, test_gst_normalize_rois_blend_kernels);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_normalize_rois);
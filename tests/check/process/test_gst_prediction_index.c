@@ -0,0 +1,125 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferenceprediction.h"
+
+static BoundingBox bbox = { 10, 20, 100, 200 };
+
+GST_START_TEST (test_gst_prediction_index_find)
+{
+  GstInferencePrediction *root = gst_inference_prediction_new ();
+  GstInferencePrediction *a = gst_inference_prediction_new_full (&bbox);
+  GstInferencePrediction *b = gst_inference_prediction_new_full (&bbox);
+  GstInferencePrediction *c = gst_inference_prediction_new_full (&bbox);
+  GstInferencePrediction *found;
+
+  gst_inference_prediction_append (root, a);
+  gst_inference_prediction_append (root, b);
+
+  found = gst_inference_prediction_find (root, b->prediction_id);
+  fail_unless (found == b);
+  gst_inference_prediction_unref (found);
+
+  /* Appended after the tree was indexed */
+  gst_inference_prediction_append (a, c);
+  found = gst_inference_prediction_find (root, c->prediction_id);
+  fail_unless (found == c);
+  gst_inference_prediction_unref (found);
+
+  /* Only the tree under the given prediction is searched */
+  found = gst_inference_prediction_find (a, a->prediction_id);
+  fail_unless (found == a);
+  gst_inference_prediction_unref (found);
+  found = gst_inference_prediction_find (a, c->prediction_id);
+  fail_unless (found == c);
+  gst_inference_prediction_unref (found);
+  fail_unless (NULL == gst_inference_prediction_find (a, b->prediction_id));
+  fail_unless (NULL == gst_inference_prediction_find (c, a->prediction_id));
+  fail_unless (NULL == gst_inference_prediction_find (root, G_MAXUINT64));
+
+  gst_inference_prediction_unref (root);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_prediction_index_merge)
+{
+  GstInferencePrediction *dst = gst_inference_prediction_new ();
+  GstInferencePrediction *src, *child, *grandchild, *found;
+  GSList *children;
+  guint64 child_id;
+
+  child = gst_inference_prediction_new_full (&bbox);
+  child_id = child->prediction_id;
+  gst_inference_prediction_append_classification (child,
+      gst_inference_classification_new_full (1, 0.5, NULL, 2, NULL, NULL));
+  gst_inference_prediction_append (dst, child);
+
+  /* Index dst before merging into it */
+  found = gst_inference_prediction_find (dst, child_id);
+  gst_inference_prediction_unref (found);
+
+  src = gst_inference_prediction_copy (dst);
+  found = gst_inference_prediction_find (src, child_id);
+  grandchild = gst_inference_prediction_new_full (&bbox);
+  gst_inference_prediction_append (found, grandchild);
+  gst_inference_prediction_append_classification (found,
+      gst_inference_classification_new_full (0, 0.5, NULL, 2, NULL, NULL));
+  gst_inference_prediction_unref (found);
+
+  fail_unless (gst_inference_prediction_merge (src, dst));
+  /* Merging again adds nothing */
+  fail_if (gst_inference_prediction_merge (src, dst));
+
+  children = gst_inference_prediction_get_children (dst);
+  fail_unless_equals_int (g_slist_length (children), 1);
+  fail_unless (children->data == child);
+  g_slist_free (children);
+  fail_unless_equals_int (g_list_length (child->classifications), 2);
+
+  /* The copied grandchild is found through the index of dst */
+  found = gst_inference_prediction_find (dst, grandchild->prediction_id);
+  fail_unless (found != NULL && found != grandchild);
+  fail_unless (found->predictions->parent == child->predictions);
+  gst_inference_prediction_unref (found);
+
+  gst_inference_prediction_unref (src);
+  gst_inference_prediction_unref (dst);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_prediction_index_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_prediction_index");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_prediction_index_find);
+  tcase_add_test (tc, test_gst_prediction_index_merge);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_prediction_index);
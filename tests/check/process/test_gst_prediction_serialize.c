@@ -0,0 +1,112 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gst/r2inference/gstinferenceprediction.h"
+
+static BoundingBox root_bbox = { 0, 0, 640, 480 };
+static BoundingBox child_bbox = { 10, 20, 100, 200 };
+
+GST_START_TEST (test_gst_prediction_serialize_leaf)
+{
+  GstInferencePrediction *root = gst_inference_prediction_new_full (&root_bbox);
+  GString *string = g_string_new (NULL);
+  gchar *expected;
+
+  expected = g_strdup_printf ("{\n"
+      "  \"id\" : %" G_GUINT64_FORMAT ",\n"
+      "  \"enabled\" : \"True\",\n"
+      "  \"bbox\" : {\n"
+      "    \"x\" : 0,\n"
+      "    \"y\" : 0,\n"
+      "    \"width\" : 640,\n"
+      "    \"height\" : 480\n"
+      "  },\n"
+      "  \"classes\" : [\n"
+      "    \n"
+      "  ],\n"
+      "  \"predictions\" : [\n"
+      "    \n"
+      "  ]\n" "}", root->prediction_id);
+
+  gst_inference_prediction_serialize (root, string);
+  fail_unless_equals_string (string->str, expected);
+
+  g_free (expected);
+  g_string_free (string, TRUE);
+  gst_inference_prediction_unref (root);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_prediction_serialize_reuse)
+{
+  GstInferencePrediction *root = gst_inference_prediction_new_full (&root_bbox);
+  GstInferencePrediction *child = NULL;
+  GString *string = g_string_new ("prefix");
+  gchar *serial, *sclass;
+  gint i;
+
+  for (i = 0; i < 3; i++) {
+    child = gst_inference_prediction_new_full (&child_bbox);
+    gst_inference_prediction_append_classification (child,
+        gst_inference_classification_new_full (i, 0.5, "label", 0, NULL,
+            NULL));
+    gst_inference_prediction_append (root, child);
+  }
+
+  serial = gst_inference_prediction_to_string (root);
+  sclass = gst_inference_classification_to_string ((GstInferenceClassification
+          *) child->classifications->data, 3);
+  fail_unless (strstr (serial, sclass) != NULL);
+
+  /* Appended after what is already there, and the same on every reuse */
+  gst_inference_prediction_serialize (root, string);
+  fail_unless (g_str_has_prefix (string->str, "prefix"));
+  fail_unless_equals_string (string->str + strlen ("prefix"), serial);
+
+  g_string_truncate (string, 0);
+  gst_inference_prediction_serialize (root, string);
+  fail_unless_equals_string (string->str, serial);
+
+  g_free (sclass);
+  g_free (serial);
+  g_string_free (string, TRUE);
+  gst_inference_prediction_unref (root);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_prediction_serialize_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_prediction_serialize");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_prediction_serialize_leaf);
+  tcase_add_test (tc, test_gst_prediction_serialize_reuse);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_prediction_serialize);
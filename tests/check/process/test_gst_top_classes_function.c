@@ -0,0 +1,153 @@
+/*
+ * GStreamer
+ * Copyright (C) 2018-2020 RidgeRun <support@ridgerun.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+#include "gst/r2inference/gstinferencepostprocess.h"
+#include "gst/r2inference/gstinferencepostprocesskernels.h"
+
+#define NUM_CLASSES 1001
+
+GST_START_TEST (test_gst_top_classes_sorted)
+{
+  gfloat values[NUM_CLASSES];
+  GstInferenceClassScore top[5];
+  gint i, num_top;
+
+  /* Increasing values make every class enter the top at some point */
+  for (i = 0; i < NUM_CLASSES; ++i) {
+    values[i] = i / (gfloat) NUM_CLASSES;
+  }
+
+  num_top = gst_get_top_classes (values, NUM_CLASSES, 5, top);
+
+  fail_unless_equals_int (num_top, 5);
+  for (i = 0; i < num_top; ++i) {
+    fail_unless_equals_int (top[i].class_id, NUM_CLASSES - 1 - i);
+    fail_unless_equals_float (top[i].prob, values[NUM_CLASSES - 1 - i]);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_top_classes_ties_and_nan)
+{
+  const gfloat values[] = { 0.1, NAN, 0.5, 0.3, 0.5, -INFINITY, 0.5 };
+  GstInferenceClassScore top[G_N_ELEMENTS (values)];
+  gint num_top;
+
+  num_top = gst_get_top_classes (values, G_N_ELEMENTS (values), 2, top);
+  fail_unless_equals_int (num_top, 2);
+  fail_unless_equals_int (top[0].class_id, 2);
+  fail_unless_equals_int (top[1].class_id, 4);
+
+  /* Asking for more than there is returns every valid class */
+  num_top = gst_get_top_classes (values, G_N_ELEMENTS (values),
+      G_N_ELEMENTS (values), top);
+  fail_unless_equals_int (num_top, 5);
+  fail_unless_equals_int (top[2].class_id, 6);
+  fail_unless_equals_int (top[3].class_id, 3);
+  fail_unless_equals_int (top[4].class_id, 0);
+
+  fail_unless_equals_int (gst_get_top_classes (values, G_N_ELEMENTS (values),
+          0, top), 0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_top_classes_kernels_match_scalar)
+{
+  GstInferenceFindAboveFunc reference, kernel;
+  gfloat values[NUM_CLASSES];
+  const gfloat thresholds[] = { -1, 0.5, 0.99, 2 };
+  gint impl, start, i;
+  guint t;
+
+  /* A few peaks over a flat background */
+  for (i = 0; i < NUM_CLASSES; ++i) {
+    values[i] = 0 == i % 97 ? 1 - i / (gfloat) NUM_CLASSES : 0.01;
+  }
+
+  reference = gst_inference_find_above_get_impl (GST_INFERENCE_KERNEL_C);
+  fail_unless (reference != NULL);
+  fail_unless (gst_inference_find_above_get_func () != NULL);
+
+  for (impl = 0; impl < GST_INFERENCE_KERNEL_COUNT; ++impl) {
+    kernel = gst_inference_find_above_get_impl ((GstInferenceKernelImpl) impl);
+    if (NULL == kernel) {
+      GST_INFO ("Kernel %d not supported on this CPU", impl);
+      continue;
+    }
+
+    for (t = 0; t < G_N_ELEMENTS (thresholds); ++t) {
+      for (start = 0; start <= NUM_CLASSES; start += 7) {
+        fail_unless_equals_int (kernel (values, start, NUM_CLASSES,
+                thresholds[t]), reference (values, start, NUM_CLASSES,
+                thresholds[t]));
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gst_top_classes_classification_copy)
+{
+  const GstInferenceClassScore top[] = { {7, 0.8}, {3, 0.15} };
+  GstInferenceClassification *c, *copy;
+
+  c = gst_inference_classification_new_full (7, 0.8, NULL, NUM_CLASSES, NULL,
+      NULL);
+  gst_inference_classification_set_top (c, top, G_N_ELEMENTS (top));
+
+  copy = gst_inference_classification_copy (c);
+  fail_unless (copy->probabilities == NULL);
+  fail_unless_equals_int (copy->num_top, G_N_ELEMENTS (top));
+  fail_if (copy->top == c->top);
+  fail_unless_equals_int (copy->top[1].class_id, 3);
+  fail_unless_equals_float (copy->top[1].prob, 0.15);
+
+  gst_inference_classification_set_top (c, NULL, 0);
+  fail_unless (c->top == NULL);
+
+  gst_inference_classification_unref (copy);
+  gst_inference_classification_unref (c);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_top_classes_suite (void)
+{
+  Suite *suite = suite_create ("GstInference");
+  TCase *tc = tcase_create ("gst_top_classes");
+
+  suite_add_tcase (suite, tc);
+
+  tcase_add_test (tc, test_gst_top_classes_sorted);
+  tcase_add_test (tc, test_gst_top_classes_ties_and_nan);
+  tcase_add_test (tc, test_gst_top_classes_kernels_match_scalar);
+  tcase_add_test (tc, test_gst_top_classes_classification_copy);
+
+  return suite;
+}
+
+GST_CHECK_MAIN (gst_top_classes);
@@ -194,7 +194,7 @@ gst_detection_process_inference (GstElement * element,
   g_return_if_fail (bypass_frame);
   g_return_if_fail (user_data);
 
-  prediction = bypass_meta->prediction;
+  prediction = gst_inference_meta_ref_prediction (bypass_meta);
 
   /* Iterate through the immediate child predictions */
   for (child_predictions = gst_inference_prediction_get_children (prediction);
@@ -224,6 +224,8 @@ gst_detection_process_inference (GstElement * element,
   if (boxes) {
     g_free (boxes);
   }
+
+  gst_inference_prediction_unref (prediction);
 }
 
 void
@@ -190,7 +190,7 @@ gst_classification_process_inference (GstElement * element,
   g_return_if_fail (bypass_frame);
   g_return_if_fail (user_data);
 
-  prediction = bypass_meta->prediction;
+  prediction = gst_inference_meta_ref_prediction (bypass_meta);
 
   GST_INFERENCE_PREDICTION_LOCK (prediction);
 
@@ -202,6 +202,8 @@ gst_classification_process_inference (GstElement * element,
       classification->probabilities, classification->num_classes);
 
   GST_INFERENCE_PREDICTION_UNLOCK (prediction);
+
+  gst_inference_prediction_unref (prediction);
 }
 
 void
@@ -216,7 +218,8 @@ gst_classification_create_pipeline (GstClassification * classification)
 
   pipe_desc = g_string_new ("");
 
-  g_string_append (pipe_desc, " inceptionv4 name=net backend=");
+  g_string_append (pipe_desc, " inceptionv4 name=net full-probabilities=true "
+      "backend=");
   g_string_append (pipe_desc, backend);
   g_string_append (pipe_desc, " model-location=");
   g_string_append (pipe_desc, model_path);